@@ -0,0 +1,135 @@
+/*
+  ==============================================================================
+
+    BandBank.h
+
+    The extra parametric bands after the cuts and the peak, up to
+    maxBankBands of them. Coefficients and filter state are kept as
+    structure-of-arrays with the enabled bands packed to the front, so the
+    per-sample loop only walks what's switched on and a bank with nothing
+    enabled costs a branch.
+
+    Always direct form II transposed, whichever Engine runs the cuts and the
+    peak. T is a sample type or a juce::dsp::SIMDRegister, like an Engine
+    Stage, so VectorChain runs the same bank across its lanes. Lanes can
+    also be given banks of their own, then every band any lane uses gets a
+    slot and the lanes that don't use it run it as unity.
+
+  ==============================================================================
+*/
+
+#pragma once
+
+#include <JuceHeader.h>
+#include "CoefficientDesign.h"
+#include "FilterEngines.h"
+
+template <typename T>
+class BandBank {
+public:
+    static constexpr size_t numLanes = Broadcast<T>::numLanes;
+
+    BandBank() { reset(); }
+
+    //Every lane gets the same bands
+    void setCoefficients(const BankCoefficients& bank) {
+        laneBanks.fill(bank);
+        repack();
+    }
+
+    //One lane's bands, for VectorChain channels that don't share settings
+    void setLaneCoefficients(size_t lane, const BankCoefficients& bank) {
+        jassert(lane < numLanes);
+        laneBanks[lane] = bank;
+        repack();
+    }
+
+    int getNumActive() const { return numActive; }
+
+    void reset() {
+        s1.fill(Broadcast<T>::from(0.0));
+        s2.fill(Broadcast<T>::from(0.0));
+    }
+
+    void process(const T* input, T* output, size_t numSamples) noexcept {
+        auto count = (size_t) numActive;
+
+        if (count == 0) {
+            if (input != output) {
+                std::copy(input, input + numSamples, output);
+            }
+            return;
+        }
+
+        for (size_t n = 0; n < numSamples; ++n) {
+            auto x = input[n];
+
+            for (size_t k = 0; k < count; ++k) {
+                auto y = b0[k] * x + s1[k];
+                s1[k] = b1[k] * x - a1[k] * y + s2[k];
+                s2[k] = b2[k] * x - a2[k] * y;
+                x = y;
+            }
+
+            output[n] = x;
+        }
+    }
+
+private:
+    std::array<T, (size_t) maxBankBands> b0, b1, b2, a1, a2;
+    std::array<T, (size_t) maxBankBands> s1, s2;
+    std::array<int, (size_t) maxBankBands> bandInSlot {};
+    int numActive {0};
+
+    std::array<BankCoefficients, numLanes> laneBanks;
+
+    //Packs the bands any lane has enabled. A band keeps its state while it stays enabled, one that's just been switched on starts from rest.
+    void repack() {
+        auto previousBands = bandInSlot;
+        auto previousS1 = s1, previousS2 = s2;
+        auto previousNumActive = numActive;
+
+        numActive = 0;
+
+        for (int band = 0; band < maxBankBands; ++band) {
+            auto inUse = std::any_of(laneBanks.begin(), laneBanks.end(), [band](const BankCoefficients& bank) { return bank.active[(size_t) band]; });
+            if (! inUse) {
+                continue;
+            }
+
+            auto slot = (size_t) numActive++;
+
+            for (size_t lane = 0; lane < numLanes; ++lane) {
+                auto& bank = laneBanks[lane];
+                auto c = bank.active[(size_t) band] ? bank.bands[(size_t) band] : BiquadCoefficients {};
+
+                Broadcast<T>::setLane(b0[slot], lane, c.b0);
+                Broadcast<T>::setLane(b1[slot], lane, c.b1);
+                Broadcast<T>::setLane(b2[slot], lane, c.b2);
+                Broadcast<T>::setLane(a1[slot], lane, c.a1);
+                Broadcast<T>::setLane(a2[slot], lane, c.a2);
+            }
+
+            s1[slot] = Broadcast<T>::from(0.0);
+            s2[slot] = Broadcast<T>::from(0.0);
+
+            for (int previous = 0; previous < previousNumActive; ++previous) {
+                if (previousBands[(size_t) previous] == band) {
+                    s1[slot] = previousS1[(size_t) previous];
+                    s2[slot] = previousS2[(size_t) previous];
+                }
+            }
+
+            bandInSlot[slot] = band;
+        }
+    }
+};
+
+//The bank in MonoChain, through the same ProcessorChain wrapper as a single stage
+template <typename SampleType>
+using BankFilter = StageFilter<BandBank<SampleType>>;
+
+template <typename SampleType>
+void applyCoefficients(BankFilter<SampleType>& filter, const BankCoefficients& bank) {
+    filter.stage.setCoefficients(bank);
+}
@@ -0,0 +1,121 @@
+/*
+  ==============================================================================
+
+    CallbackMonitor.cpp
+
+  ==============================================================================
+*/
+
+#include "CallbackMonitor.h"
+
+void CallbackMonitor::prepare(double newSampleRate) {
+    sampleRate = newSampleRate;
+    nanosPerTick = 1.0e9 / (double) juce::Time::getHighResolutionTicksPerSecond();
+    clear();
+}
+
+void CallbackMonitor::clear() {
+    numBlocks.store(0, std::memory_order_relaxed);
+    numSamples.store(0, std::memory_order_relaxed);
+    numRedesigns.store(0, std::memory_order_relaxed);
+    numOverruns.store(0, std::memory_order_relaxed);
+    lastLoad.store(0.0f, std::memory_order_relaxed);
+    peakLoad.store(0.0f, std::memory_order_relaxed);
+    for (auto& count : blocksByPath) {
+        count.store(0, std::memory_order_relaxed);
+    }
+    writeIndex.store(0, std::memory_order_relaxed);
+    resetRequested.store(false, std::memory_order_relaxed);
+}
+
+void CallbackMonitor::endBlock(juce::int64 startTicks, int blockSamples) {
+    if (startTicks == 0 || blockSamples <= 0) {
+        return;
+    }
+
+    auto nanos = (double) (juce::Time::getHighResolutionTicks() - startTicks) * nanosPerTick;
+
+    if (resetRequested.load(std::memory_order_relaxed)) {
+        clear();
+    }
+
+    auto periodNanos = (double) blockSamples * 1.0e9 / sampleRate;
+    auto load = (float) (nanos / periodNanos);
+
+    auto index = writeIndex.load(std::memory_order_relaxed);
+    history[index % historySize].store((juce::uint32) juce::jmin(nanos, 4.0e9), std::memory_order_relaxed);
+    writeIndex.store(index + 1, std::memory_order_relaxed);
+
+    increment(numBlocks, (juce::uint64) 1);
+    increment(numSamples, (juce::uint64) blockSamples);
+
+    if (load > 1.0f) {
+        increment(numOverruns, (juce::uint64) 1);
+    }
+
+    lastLoad.store(load, std::memory_order_relaxed);
+    if (load > peakLoad.load(std::memory_order_relaxed)) {
+        peakLoad.store(load, std::memory_order_relaxed);
+    }
+}
+
+CallbackMonitor::Stats CallbackMonitor::getStats() const {
+    Stats stats;
+    stats.numBlocks = numBlocks.load(std::memory_order_relaxed);
+    stats.numSamples = numSamples.load(std::memory_order_relaxed);
+    stats.numRedesigns = numRedesigns.load(std::memory_order_relaxed);
+    stats.numOverruns = numOverruns.load(std::memory_order_relaxed);
+    stats.lastLoad = lastLoad.load(std::memory_order_relaxed);
+    stats.peakLoad = peakLoad.load(std::memory_order_relaxed);
+    for (size_t i = 0; i < blocksByPath.size(); ++i) {
+        stats.blocksByPath[i] = blocksByPath[i].load(std::memory_order_relaxed);
+    }
+
+    auto end = writeIndex.load(std::memory_order_relaxed);
+    auto count = juce::jmin(end, historySize);
+
+    if (count == 0) {
+        return stats;
+    }
+
+    //The audio thread may overwrite a slot while we copy, which only blurs the window by a block
+    std::vector<juce::uint32> times(count);
+    for (size_t i = 0; i < count; ++i) {
+        times[i] = history[(end - count + i) % historySize].load(std::memory_order_relaxed);
+    }
+
+    stats.lastMicros = times.back() * 1.0e-3;
+    std::sort(times.begin(), times.end());
+
+    auto percentile = [&times](double p) {
+        return times[juce::jmin(times.size() - 1, (size_t) (p * (double) times.size()))] * 1.0e-3;
+    };
+
+    stats.p50Micros = percentile(0.5);
+    stats.p99Micros = percentile(0.99);
+    stats.maxMicros = times.back() * 1.0e-3;
+    return stats;
+}
+
+juce::String CallbackMonitor::Stats::toJSON() const {
+    auto* object = new juce::DynamicObject();
+    object->setProperty("blocks", (juce::int64) numBlocks);
+    object->setProperty("samples", (juce::int64) numSamples);
+    object->setProperty("redesigns", (juce::int64) numRedesigns);
+    object->setProperty("overruns", (juce::int64) numOverruns);
+    object->setProperty("last_us", lastMicros);
+    object->setProperty("p50_us", p50Micros);
+    object->setProperty("p99_us", p99Micros);
+    object->setProperty("max_us", maxMicros);
+    object->setProperty("last_load", lastLoad);
+    object->setProperty("peak_load", peakLoad);
+
+    auto* paths = new juce::DynamicObject();
+    paths->setProperty("processed", (juce::int64) blocksByPath[(size_t) BlockPath::processed]);
+    paths->setProperty("silent_tail", (juce::int64) blocksByPath[(size_t) BlockPath::silentTail]);
+    paths->setProperty("sleeping", (juce::int64) blocksByPath[(size_t) BlockPath::sleeping]);
+    paths->setProperty("passthrough", (juce::int64) blocksByPath[(size_t) BlockPath::passthrough]);
+    object->setProperty("block_paths", juce::var(paths));
+
+    return juce::JSON::toString(juce::var(object), true);
+}
@@ -0,0 +1,97 @@
+/*
+  ==============================================================================
+
+    CallbackMonitor.h
+
+    Timing and load counters for the audio callback. The audio thread is the
+    only writer and only ever does relaxed atomic loads and stores; any other
+    thread can call getStats() to take a snapshot, including the editor and
+    headless tools that poll the processor.
+
+  ==============================================================================
+*/
+
+#pragma once
+
+#include <JuceHeader.h>
+
+class CallbackMonitor {
+public:
+    //Blocks the percentiles are taken over
+    static constexpr size_t historySize = 1024;
+
+    //What processBlock did with a block
+    enum class BlockPath {
+        processed,      //Ran through the filters
+        silentTail,     //Silent input, ran through the filters to let them ring out
+        sleeping,       //Silent input after the tail had died away, left untouched
+        passthrough,    //Every band neutral, left untouched
+        numPaths
+    };
+
+    struct Stats {
+        juce::uint64 numBlocks {0}, numSamples {0};
+        juce::uint64 numRedesigns {0};  //Band coefficient designs, from the cache or not
+        juce::uint64 numOverruns {0};   //Blocks that took longer than the audio they produced
+
+        //Over the last historySize blocks
+        double lastMicros {0.0}, p50Micros {0.0}, p99Micros {0.0}, maxMicros {0.0};
+
+        //Share of the callback period spent in processBlock, 1.0 is the whole budget
+        double lastLoad {0.0}, peakLoad {0.0};
+
+        std::array<juce::uint64, (size_t) BlockPath::numPaths> blocksByPath {};
+
+        juce::String toJSON() const;
+    };
+
+    //Not realtime safe, call from prepareToPlay
+    void prepare(double sampleRate);
+
+    void setEnabled(bool shouldBeEnabled) { enabled.store(shouldBeEnabled, std::memory_order_relaxed); }
+    bool isEnabled() const { return enabled.load(std::memory_order_relaxed); }
+
+    //Audio thread only. Returns 0 when disabled, which endBlock() takes as "don't record".
+    juce::int64 beginBlock() const {
+        return isEnabled() ? juce::Time::getHighResolutionTicks() : 0;
+    }
+
+    void endBlock(juce::int64 startTicks, int numSamples);
+
+    void addRedesign() {
+        numRedesigns.store(numRedesigns.load(std::memory_order_relaxed) + 1, std::memory_order_relaxed);
+    }
+
+    //Audio thread only, counted whether or not timing is enabled
+    void countBlock(BlockPath path) {
+        increment(blocksByPath[(size_t) path], (juce::uint64) 1);
+    }
+
+    //Any thread. Allocates, so never from the audio thread.
+    Stats getStats() const;
+
+    //Any thread, the audio thread clears the counters at the start of its next block
+    void resetStats() { resetRequested.store(true, std::memory_order_relaxed); }
+
+private:
+    std::atomic<bool> enabled {true};
+    std::atomic<bool> resetRequested {false};
+
+    double sampleRate {44100.0};
+    double nanosPerTick {1.0};
+
+    std::atomic<juce::uint64> numBlocks {0}, numSamples {0}, numRedesigns {0}, numOverruns {0};
+    std::atomic<float> lastLoad {0.0f}, peakLoad {0.0f};
+    std::array<std::atomic<juce::uint64>, (size_t) BlockPath::numPaths> blocksByPath {};
+
+    //Block times in nanoseconds, written round robin
+    std::array<std::atomic<juce::uint32>, historySize> history {};
+    std::atomic<size_t> writeIndex {0};
+
+    template <typename T>
+    static void increment(std::atomic<T>& counter, T amount) {
+        counter.store(counter.load(std::memory_order_relaxed) + amount, std::memory_order_relaxed);
+    }
+
+    void clear();
+};
@@ -0,0 +1,183 @@
+/*
+  ==============================================================================
+
+    CoefficientCache.cpp
+
+  ==============================================================================
+*/
+
+#include "CoefficientCache.h"
+
+juce::uint64 CoefficientCache::Key::pack() const {
+    //kind:2 | stages:4 | freq:15 | gain:10 | q:12
+    return (juce::uint64) kind
+         | ((juce::uint64) numStages << 2)
+         | ((juce::uint64) freq << 6)
+         | ((juce::uint64) (gainTenths + 512) << 21)
+         | ((juce::uint64) qHundredths << 31);
+}
+
+CoefficientCache::Key CoefficientCache::Key::unpack(juce::uint64 packed) {
+    return { (Kind) (packed & 0x3),
+             (int) ((packed >> 2) & 0xf),
+             (int) ((packed >> 6) & 0x7fff),
+             (int) ((packed >> 21) & 0x3ff) - 512,
+             (int) ((packed >> 31) & 0xfff) };
+}
+
+CoefficientCache::~CoefficientCache() {
+    service->removeClient(*this);
+}
+
+void CoefficientCache::prepare(double newSampleRate, size_t budgetBytes, Prefill prefill) {
+    //Off the service thread's list while the table and the FIFO change underneath it
+    service->removeClient(*this);
+
+    sampleRate = newSampleRate;
+    table = service->getCoefficientTable(sampleRate, budgetBytes, &CoefficientCache::designPacked);
+    requests.reset();
+    lastRequestedKey = SharedCoefficientTable::emptyKey;
+    resetStats();
+
+    if (table == nullptr) {
+        return;
+    }
+
+    //Whichever instance gets here first at this rate fills it for all of them, misses are designed in the meantime
+    if (prefill == Prefill::cutBands && table->claimPrefill()) {
+        service->getPool().addJob([filling = table] { prefillCutBands(*filling); });
+    }
+
+    service->addClient(*this);
+}
+
+//Half the table is left for peak designs, which are looked up lazily. The other half is shared evenly by both cuts at
+//every slope, each on a log-spaced grid so a small budget still covers the whole range. Designs only go into empty
+//entries, so one never evicts another, and only the ones that land count against the budget.
+void CoefficientCache::prefillCutBands(SharedCoefficientTable& table) {
+    constexpr int minFreq = 20, maxFreq = 20000;
+
+    auto numToFill = table.getNumEntries() / 2;
+    auto perCut = (int) juce::jmin(numToFill / (size_t) (2 * maxCutStages), (size_t) (maxFreq - minFreq + 1));
+    if (perCut < 2) {
+        return;
+    }
+
+    size_t filled = 0;
+
+    for (int numStages = 1; numStages <= maxCutStages; ++numStages) {
+        for (auto kind : { Kind::lowCut, Kind::highCut }) {
+            auto lastFreq = 0;
+
+            for (int i = 0; i < perCut && filled < numToFill; ++i) {
+                auto freq = juce::roundToInt(minFreq * std::pow((double) maxFreq / minFreq, (double) i / (perCut - 1)));
+                if (freq == lastFreq) {
+                    continue;
+                }
+                lastFreq = freq;
+
+                Key key { kind, freq, numStages, 0, 0 };
+                if (table.publish(key.pack(), design(table.getSampleRate(), key), true)) {
+                    ++filled;
+                }
+            }
+        }
+    }
+}
+
+CutCoefficients CoefficientCache::designPacked(double sampleRate, juce::uint64 packed) {
+    return design(sampleRate, Key::unpack(packed));
+}
+
+CutCoefficients CoefficientCache::design(double sampleRate, const Key& key) {
+    auto nyquistLimited = [sampleRate](int freq) {
+        return juce::jmin((double) freq, sampleRate * 0.5);
+    };
+
+    switch (key.kind) {
+        case Kind::lowCut:
+            return makeLowCutCoefficients(sampleRate, nyquistLimited(key.freq), key.numStages);
+        case Kind::highCut:
+            return makeHighCutCoefficients(sampleRate, nyquistLimited(key.freq), key.numStages);
+        case Kind::peak:
+            break;
+    }
+
+    CutCoefficients peak;
+    peak.stages[0] = makePeakCoefficients(sampleRate, nyquistLimited(key.freq), key.qHundredths * 0.01, key.gainTenths * 0.1);
+    return peak;
+}
+
+const CutCoefficients& CoefficientCache::lookup(const Key& key) {
+    if (table == nullptr) {
+        scratch = design(sampleRate, key);
+        return scratch;
+    }
+
+    auto packed = key.pack();
+
+    //Only the audio thread writes the counters, so a relaxed load/store pair is enough
+    if (table->read(packed, scratch)) {
+        hits.store(hits.load(std::memory_order_relaxed) + 1, std::memory_order_relaxed);
+        return scratch;
+    }
+
+    misses.store(misses.load(std::memory_order_relaxed) + 1, std::memory_order_relaxed);
+    scratch = design(sampleRate, key);
+
+    //A full FIFO just means this miss is asked for again next time
+    if (packed != lastRequestedKey && requests.getFreeSpace() > 0) {
+        int start1, size1, start2, size2;
+        requests.prepareToWrite(1, start1, size1, start2, size2);
+        requestKeys[(size_t) (size1 > 0 ? start1 : start2)] = packed;
+        requests.finishedWrite(1);
+        lastRequestedKey = packed;
+    }
+
+    return scratch;
+}
+
+void CoefficientCache::serviceTick(double) {
+    int start1, size1, start2, size2;
+    requests.prepareToRead(requests.getNumReady(), start1, size1, start2, size2);
+
+    for (int i = 0; i < size1; ++i) {
+        service->fulfil(*table, requestKeys[(size_t) (start1 + i)]);
+    }
+    for (int i = 0; i < size2; ++i) {
+        service->fulfil(*table, requestKeys[(size_t) (start2 + i)]);
+    }
+
+    requests.finishedRead(size1 + size2);
+}
+
+CutCoefficients CoefficientCache::getLowCut(float freq, int numStages) {
+    return lookup({ Kind::lowCut, juce::roundToInt(freq), numStages, 0, 0 });
+}
+
+CutCoefficients CoefficientCache::getHighCut(float freq, int numStages) {
+    return lookup({ Kind::highCut, juce::roundToInt(freq), numStages, 0, 0 });
+}
+
+BiquadCoefficients CoefficientCache::getPeak(float freq, float q, float gainDB) {
+    return lookup({ Kind::peak, juce::roundToInt(freq), 1, juce::roundToInt(gainDB * 10.0f), juce::roundToInt(q * 100.0f) }).stages[0];
+}
+
+CoefficientCache::Stats CoefficientCache::getStats() const {
+    Stats stats;
+    stats.hits = hits.load(std::memory_order_relaxed);
+    stats.misses = misses.load(std::memory_order_relaxed);
+
+    //Read on the message thread, which is the only one that swaps the table in prepare()
+    if (table != nullptr) {
+        stats.numEntries = table->getNumEntries();
+        stats.bytesUsed = table->getBytesUsed();
+    }
+
+    return stats;
+}
+
+void CoefficientCache::resetStats() {
+    hits.store(0, std::memory_order_relaxed);
+    misses.store(0, std::memory_order_relaxed);
+}
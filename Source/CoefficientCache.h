@@ -0,0 +1,86 @@
+/*
+  ==============================================================================
+
+    CoefficientCache.h
+
+    Cache of band designs keyed by the quantised parameter values (1 Hz,
+    0.1 dB, 0.01 Q), so automation sweeps become table lookups. The table
+    itself belongs to the SharedDesignService and is shared by every
+    instance running at the same rate: the audio thread reads it without
+    waiting, designs a miss itself and queues the key in this instance's
+    own FIFO, and the service thread designs it into the table once for
+    every instance that asks.
+
+  ==============================================================================
+*/
+
+#pragma once
+
+#include <JuceHeader.h>
+#include "CoefficientDesign.h"
+#include "SharedDesignService.h"
+
+class CoefficientCache : private SharedDesignService::Client {
+public:
+    enum class Prefill {
+        none,       //Fill lazily as the audio threads ask for designs
+        cutBands    //Design a log-spaced grid of low/high cut frequencies for every slope in the background, sized to the budget
+    };
+
+    struct Stats {
+        juce::uint64 hits {0}, misses {0};
+        size_t numEntries {0}, bytesUsed {0};   //Of the shared table, counted once however many instances use it
+
+        double getHitRate() const {
+            auto total = hits + misses;
+            return total > 0 ? (double) hits / (double) total : 0.0;
+        }
+    };
+
+    static constexpr size_t defaultBudgetBytes = 1 << 20;
+
+    ~CoefficientCache() override;
+
+    //Not realtime safe, call from prepareToPlay. A budget of 0 disables the cache.
+    void prepare(double sampleRate, size_t budgetBytes, Prefill prefill);
+
+    CutCoefficients getLowCut(float freq, int numStages);
+    CutCoefficients getHighCut(float freq, int numStages);
+    BiquadCoefficients getPeak(float freq, float q, float gainDB);
+
+    Stats getStats() const;
+    void resetStats();
+
+private:
+    enum class Kind : juce::uint64 { lowCut = 1, highCut = 2, peak = 3 };
+
+    struct Key {
+        Kind kind;
+        int freq, numStages, gainTenths, qHundredths;
+
+        juce::uint64 pack() const;
+        static Key unpack(juce::uint64 packed);
+    };
+
+    static constexpr int requestQueueSize = 256;
+
+    static CutCoefficients design(double sampleRate, const Key& key);
+    static CutCoefficients designPacked(double sampleRate, juce::uint64 packed);
+    static void prefillCutBands(SharedCoefficientTable& table);
+
+    const CutCoefficients& lookup(const Key& key);
+    void serviceTick(double nowMs) override;
+
+    juce::SharedResourcePointer<SharedDesignService> service;
+    std::shared_ptr<SharedCoefficientTable> table;
+
+    double sampleRate {44100.0};
+    CutCoefficients scratch;
+
+    //Audio thread to service thread, misses that haven't been asked for yet
+    juce::AbstractFifo requests {requestQueueSize};
+    std::array<juce::uint64, requestQueueSize> requestKeys {};
+    juce::uint64 lastRequestedKey {SharedCoefficientTable::emptyKey};
+
+    std::atomic<juce::uint64> hits {0}, misses {0};
+};
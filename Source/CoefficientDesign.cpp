@@ -0,0 +1,237 @@
+/*
+  ==============================================================================
+
+    CoefficientDesign.cpp
+
+  ==============================================================================
+*/
+
+#include "CoefficientDesign.h"
+
+static BiquadCoefficients normalise(double b0, double b1, double b2, double a0, double a1, double a2) {
+    jassert(a0 != 0.0);
+    auto a0inv = 1.0 / a0;
+
+    return { b0 * a0inv, b1 * a0inv, b2 * a0inv, a1 * a0inv, a2 * a0inv };
+}
+
+BiquadCoefficients makePeakCoefficients(double sampleRate, double freq, double q, double gainDB) {
+    jassert(sampleRate > 0.0);
+    jassert(freq > 0.0 && freq <= sampleRate * 0.5);
+    jassert(q > 0.0);
+
+    auto A = std::sqrt(juce::jmax(0.0, juce::Decibels::decibelsToGain(gainDB)));
+    auto omega = (juce::MathConstants<double>::twoPi * freq) / sampleRate;
+    auto alpha = std::sin(omega) / (q * 2.0);
+    auto c2 = -2.0 * std::cos(omega);
+    auto alphaTimesA = alpha * A;
+    auto alphaOverA = alpha / A;
+
+    return normalise(1.0 + alphaTimesA, c2, 1.0 - alphaTimesA, 1.0 + alphaOverA, c2, 1.0 - alphaOverA);
+}
+
+BiquadCoefficients makeLowPassCoefficients(double sampleRate, double freq, double q) {
+    jassert(sampleRate > 0.0);
+    jassert(freq > 0.0 && freq <= sampleRate * 0.5);
+
+    auto n = 1.0 / std::tan(juce::MathConstants<double>::pi * freq / sampleRate);
+    auto nSquared = n * n;
+    auto invQ = 1.0 / q;
+    auto c1 = 1.0 / (1.0 + invQ * n + nSquared);
+
+    return normalise(c1, c1 * 2.0, c1, 1.0, c1 * 2.0 * (1.0 - nSquared), c1 * (1.0 - invQ * n + nSquared));
+}
+
+BiquadCoefficients makeHighPassCoefficients(double sampleRate, double freq, double q) {
+    jassert(sampleRate > 0.0);
+    jassert(freq > 0.0 && freq <= sampleRate * 0.5);
+
+    auto n = std::tan(juce::MathConstants<double>::pi * freq / sampleRate);
+    auto nSquared = n * n;
+    auto invQ = 1.0 / q;
+    auto c1 = 1.0 / (1.0 + invQ * n + nSquared);
+
+    return normalise(c1, c1 * -2.0, c1, 1.0, c1 * 2.0 * (nSquared - 1.0), c1 * (1.0 - invQ * n + nSquared));
+}
+
+BiquadCoefficients makeLowShelfCoefficients(double sampleRate, double freq, double q, double gainDB) {
+    jassert(sampleRate > 0.0);
+    jassert(freq > 0.0 && freq <= sampleRate * 0.5);
+    jassert(q > 0.0);
+
+    auto A = std::sqrt(juce::jmax(0.0, juce::Decibels::decibelsToGain(gainDB)));
+    auto aMinus1 = A - 1.0;
+    auto aPlus1 = A + 1.0;
+    auto omega = (juce::MathConstants<double>::twoPi * freq) / sampleRate;
+    auto cosOmega = std::cos(omega);
+    auto beta = std::sin(omega) * std::sqrt(A) / q;
+    auto aMinus1TimesCos = aMinus1 * cosOmega;
+
+    return normalise(A * (aPlus1 - aMinus1TimesCos + beta), A * 2.0 * (aMinus1 - aPlus1 * cosOmega), A * (aPlus1 - aMinus1TimesCos - beta),
+                     aPlus1 + aMinus1TimesCos + beta, -2.0 * (aMinus1 + aPlus1 * cosOmega), aPlus1 + aMinus1TimesCos - beta);
+}
+
+BiquadCoefficients makeHighShelfCoefficients(double sampleRate, double freq, double q, double gainDB) {
+    jassert(sampleRate > 0.0);
+    jassert(freq > 0.0 && freq <= sampleRate * 0.5);
+    jassert(q > 0.0);
+
+    auto A = std::sqrt(juce::jmax(0.0, juce::Decibels::decibelsToGain(gainDB)));
+    auto aMinus1 = A - 1.0;
+    auto aPlus1 = A + 1.0;
+    auto omega = (juce::MathConstants<double>::twoPi * freq) / sampleRate;
+    auto cosOmega = std::cos(omega);
+    auto beta = std::sin(omega) * std::sqrt(A) / q;
+    auto aMinus1TimesCos = aMinus1 * cosOmega;
+
+    return normalise(A * (aPlus1 + aMinus1TimesCos + beta), A * -2.0 * (aMinus1 + aPlus1 * cosOmega), A * (aPlus1 + aMinus1TimesCos - beta),
+                     aPlus1 - aMinus1TimesCos + beta, 2.0 * (aMinus1 - aPlus1 * cosOmega), aPlus1 - aMinus1TimesCos - beta);
+}
+
+BiquadCoefficients makeNotchCoefficients(double sampleRate, double freq, double q) {
+    jassert(sampleRate > 0.0);
+    jassert(freq > 0.0 && freq <= sampleRate * 0.5);
+    jassert(q > 0.0);
+
+    auto n = 1.0 / std::tan(juce::MathConstants<double>::pi * freq / sampleRate);
+    auto nSquared = n * n;
+    auto invQ = 1.0 / q;
+    auto c1 = 1.0 / (1.0 + n * invQ + nSquared);
+    auto b0 = c1 * (1.0 + nSquared);
+    auto b1 = 2.0 * c1 * (1.0 - nSquared);
+
+    return normalise(b0, b1, b0, 1.0, b1, c1 * (1.0 - n * invQ + nSquared));
+}
+
+//0 dB at freq, what the dynamics detectors listen through
+BiquadCoefficients makeBandPassCoefficients(double sampleRate, double freq, double q) {
+    jassert(sampleRate > 0.0);
+    jassert(freq > 0.0 && freq <= sampleRate * 0.5);
+    jassert(q > 0.0);
+
+    auto omega = (juce::MathConstants<double>::twoPi * freq) / sampleRate;
+    auto alpha = std::sin(omega) / (q * 2.0);
+
+    return normalise(alpha, 0.0, -alpha, 1.0 + alpha, -2.0 * std::cos(omega), 1.0 - alpha);
+}
+
+BiquadCoefficients makeTiltCoefficients(double sampleRate, double freq, double gainDB) {
+    jassert(sampleRate > 0.0);
+    jassert(freq > 0.0 && freq <= sampleRate * 0.5);
+
+    //sqrt(A) (s + w / sqrt(A)) / (s + w sqrt(A)) through the bilinear transform, prewarped so unity lands on freq
+    auto r = juce::Decibels::decibelsToGain(gainDB * 0.5, -1000.0);
+    auto k = std::tan(juce::MathConstants<double>::pi * freq / sampleRate);
+
+    return normalise(r + k, k - r, 0.0, 1.0 + k * r, k * r - 1.0, 0.0);
+}
+
+BiquadCoefficients makeBandCoefficients(double sampleRate, BandType type, double freq, double q, double gainDB) {
+    switch (type) {
+        case BandType::lowShelf:  return makeLowShelfCoefficients(sampleRate, freq, q, gainDB);
+        case BandType::highShelf: return makeHighShelfCoefficients(sampleRate, freq, q, gainDB);
+        case BandType::notch:     return makeNotchCoefficients(sampleRate, freq, q);
+        case BandType::tilt:      return makeTiltCoefficients(sampleRate, freq, gainDB);
+        case BandType::peak:      break;
+    }
+
+    return makePeakCoefficients(sampleRate, freq, q, gainDB);
+}
+
+//Q of each section of an even order Butterworth filter, same as FilterDesign uses
+static double butterworthQ(int stage, int order) {
+    return 1.0 / (2.0 * std::cos((2.0 * stage + 1.0) * juce::MathConstants<double>::pi / (order * 2.0)));
+}
+
+CutCoefficients makeLowCutCoefficients(double sampleRate, double freq, int numStages) {
+    jassert(numStages > 0 && numStages <= maxCutStages);
+
+    CutCoefficients cut;
+    cut.numStages = numStages;
+
+    for (int i = 0; i < numStages; ++i) {
+        cut.stages[(size_t) i] = makeHighPassCoefficients(sampleRate, freq, butterworthQ(i, 2 * numStages));
+    }
+
+    return cut;
+}
+
+CutCoefficients makeHighCutCoefficients(double sampleRate, double freq, int numStages) {
+    jassert(numStages > 0 && numStages <= maxCutStages);
+
+    CutCoefficients cut;
+    cut.numStages = numStages;
+
+    for (int i = 0; i < numStages; ++i) {
+        cut.stages[(size_t) i] = makeLowPassCoefficients(sampleRate, freq, butterworthQ(i, 2 * numStages));
+    }
+
+    return cut;
+}
+
+void accumulateMagnitudeSquared(const BiquadCoefficients& c, const double* phi, double* magnitudeSquared, size_t numPoints) {
+    //The sin^2 form keeps its precision near DC, where cos(w) based evaluation cancels out
+    auto numeratorSum = c.b0 + c.b1 + c.b2;
+    auto n0 = numeratorSum * numeratorSum;
+    auto n1 = 4.0 * (c.b0 * c.b1 + 4.0 * c.b0 * c.b2 + c.b1 * c.b2);
+    auto n2 = 16.0 * c.b0 * c.b2;
+
+    auto denominatorSum = 1.0 + c.a1 + c.a2;
+    auto d0 = denominatorSum * denominatorSum;
+    auto d1 = 4.0 * (c.a1 + 4.0 * c.a2 + c.a1 * c.a2);
+    auto d2 = 16.0 * c.a2;
+
+    for (size_t i = 0; i < numPoints; ++i) {
+        auto p = phi[i];
+        magnitudeSquared[i] *= (n0 - n1 * p + n2 * p * p) / (d0 - d1 * p + d2 * p * p);
+    }
+}
+
+void accumulateChainMagnitudeSquared(const ChainCoefficients& chainCoefficients, const double* phi, double* magnitudeSquared, size_t numPoints) {
+    auto accumulate = [&](const BiquadCoefficients& c) {
+        accumulateMagnitudeSquared(c, phi, magnitudeSquared, numPoints);
+    };
+
+    if (! chainCoefficients.lcBypassed) {
+        for (int i = 0; i < chainCoefficients.lowCut.numStages; ++i) {
+            accumulate(chainCoefficients.lowCut.stages[(size_t) i]);
+        }
+    }
+    if (! chainCoefficients.pdBypassed) {
+        accumulate(chainCoefficients.peak);
+    }
+    if (! chainCoefficients.hcBypassed) {
+        for (int i = 0; i < chainCoefficients.highCut.numStages; ++i) {
+            accumulate(chainCoefficients.highCut.stages[(size_t) i]);
+        }
+    }
+    for (size_t i = 0; i < (size_t) maxBankBands; ++i) {
+        if (chainCoefficients.bank.active[i]) {
+            accumulate(chainCoefficients.bank.bands[i]);
+        }
+    }
+}
+
+double estimateDecaySamples(const BiquadCoefficients& c, double decayDB) {
+    //Poles are the roots of z^2 + a1 z + a2
+    auto discriminant = c.a1 * c.a1 - 4.0 * c.a2;
+    double radius;
+
+    if (discriminant < 0.0) {
+        radius = std::sqrt(c.a2);
+    } else {
+        auto root = std::sqrt(discriminant);
+        radius = juce::jmax(std::abs(-c.a1 + root), std::abs(-c.a1 - root)) * 0.5;
+    }
+
+    if (radius <= 1.0e-12) {
+        return 2.0;
+    }
+
+    //An unstable or marginal design never decays, report something long rather than infinity
+    if (radius >= 1.0) {
+        return 1.0e9;
+    }
+
+    return std::log(juce::Decibels::decibelsToGain(-decayDB, -1000.0)) / std::log(radius);
+}
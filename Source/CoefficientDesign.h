@@ -0,0 +1,106 @@
+/*
+  ==============================================================================
+
+    CoefficientDesign.h
+
+    Allocation-free biquad designs for the three bands and the band bank.
+    These produce the same coefficients as juce::dsp::IIR::Coefficients'
+    makePeakFilter, makeLowShelf, makeHighShelf and makeNotch and
+    FilterDesign::design*HighOrderButterworthMethod, but write into plain
+    structs so they are safe to call from the audio thread.
+
+  ==============================================================================
+*/
+
+#pragma once
+
+#include <JuceHeader.h>
+
+//Normalised biquad (a0 == 1), same order as juce::dsp::IIR::Coefficients stores them
+struct BiquadCoefficients {
+    double b0 {1.0}, b1 {0.0}, b2 {0.0}, a1 {0.0}, a2 {0.0};
+};
+
+//Up to 96 dB/oct
+static constexpr int maxCutStages = 8;
+
+struct CutCoefficients {
+    std::array<BiquadCoefficients, maxCutStages> stages;
+    int numStages {1};
+};
+
+//What each band of the band bank is
+enum class BandType {
+    peak,
+    lowShelf,
+    highShelf,
+    notch,
+    tilt        //First order, -gain/2 below the frequency and +gain/2 above it
+};
+
+static constexpr int numBandTypes = 5;
+static constexpr int maxBankBands = 16;
+
+//Bands that aren't active have no coefficients worth reading
+struct BankCoefficients {
+    std::array<BiquadCoefficients, maxBankBands> bands;
+    std::array<bool, maxBankBands> active {};
+};
+
+//Everything the low cut / peak / high cut cascade and the band bank need, independent of which engine runs them
+struct ChainCoefficients {
+    CutCoefficients lowCut, highCut;
+    BiquadCoefficients peak;
+    BankCoefficients bank;
+
+    bool lcBypassed = false;
+    bool pdBypassed = false;
+    bool hcBypassed = false;
+};
+
+BiquadCoefficients makePeakCoefficients(double sampleRate, double freq, double q, double gainDB);
+BiquadCoefficients makeLowPassCoefficients(double sampleRate, double freq, double q);
+BiquadCoefficients makeHighPassCoefficients(double sampleRate, double freq, double q);
+BiquadCoefficients makeLowShelfCoefficients(double sampleRate, double freq, double q, double gainDB);
+BiquadCoefficients makeHighShelfCoefficients(double sampleRate, double freq, double q, double gainDB);
+BiquadCoefficients makeNotchCoefficients(double sampleRate, double freq, double q);
+BiquadCoefficients makeBandPassCoefficients(double sampleRate, double freq, double q);
+BiquadCoefficients makeTiltCoefficients(double sampleRate, double freq, double gainDB);
+
+//Any bank band type, notches ignore the gain and tilts the Q
+BiquadCoefficients makeBandCoefficients(double sampleRate, BandType type, double freq, double q, double gainDB);
+
+//Butterworth cascades of numStages biquads (order 2*numStages)
+CutCoefficients makeLowCutCoefficients(double sampleRate, double freq, int numStages);
+CutCoefficients makeHighCutCoefficients(double sampleRate, double freq, int numStages);
+
+//Multiplies each of the numPoints squared magnitudes by the biquad's |H|^2 at phi = sin^2(w / 2).
+//A straight loop over plain arrays so it vectorises across the whole frequency table.
+void accumulateMagnitudeSquared(const BiquadCoefficients& c, const double* phi, double* magnitudeSquared, size_t numPoints);
+
+//The same for every stage the chain runs, skipping the bypassed bands and the bank's inactive ones
+void accumulateChainMagnitudeSquared(const ChainCoefficients& chainCoefficients, const double* phi, double* magnitudeSquared, size_t numPoints);
+
+//Samples until the biquad's impulse response has decayed by decayDB, from its slowest pole
+double estimateDecaySamples(const BiquadCoefficients& c, double decayDB = 60.0);
+
+//Gives a filter biquad-sized coefficient storage, call before prepare() so the state is sized once
+template <typename FilterType>
+void allocateBiquadStorage(FilterType& filter) {
+    using CoefficientsType = typename std::remove_reference<decltype(*filter.coefficients)>::type;
+    filter.coefficients = new CoefficientsType(1, 0, 0, 1, 0, 0);
+}
+
+//Writes into the existing storage, no allocation or locking
+template <typename FilterType>
+void applyCoefficients(FilterType& filter, const BiquadCoefficients& c) {
+    using NumericType = typename std::remove_reference<decltype(*filter.coefficients->getRawCoefficients())>::type;
+    jassert(filter.coefficients->getFilterOrder() == 2);
+
+    auto* raw = filter.coefficients->getRawCoefficients();
+    raw[0] = static_cast<NumericType>(c.b0);
+    raw[1] = static_cast<NumericType>(c.b1);
+    raw[2] = static_cast<NumericType>(c.b2);
+    raw[3] = static_cast<NumericType>(c.a1);
+    raw[4] = static_cast<NumericType>(c.a2);
+}
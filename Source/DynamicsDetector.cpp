@@ -0,0 +1,142 @@
+/*
+  ==============================================================================
+
+    DynamicsDetector.cpp
+
+  ==============================================================================
+*/
+
+#include "DynamicsDetector.h"
+
+void DynamicsDetector::prepare(double newSampleRate, int maximumBlockSize) {
+    sampleRate = newSampleRate;
+    keyScratch.assign((size_t) juce::jmax(1, maximumBlockSize), 0.0f);
+    setSettings(settings);
+    reset();
+}
+
+void DynamicsDetector::reset() {
+    numAppended = 0;
+    s1.fill(0.0);
+    s2.fill(0.0);
+    envelope.fill(0.0);
+    gainDB.fill(0.0f);
+    changed.fill(false);
+}
+
+void DynamicsDetector::setSettings(const Settings& newSettings) {
+    settings = newSettings;
+
+    auto coefficientFor = [this](float milliseconds) {
+        return 1.0 - std::exp(-1.0 / (juce::jmax(0.01, (double) milliseconds) * 0.001 * sampleRate));
+    };
+
+    attackCoefficient = coefficientFor(settings.attackMs);
+    releaseCoefficient = coefficientFor(settings.releaseMs);
+}
+
+void DynamicsDetector::setBand(int index, BandType type, double freq, double q) {
+    auto band = (size_t) index;
+    freq = juce::jlimit(10.0, sampleRate * 0.45, freq);
+
+    BiquadCoefficients c;
+    switch (type) {
+        case BandType::lowShelf:
+            c = makeLowPassCoefficients(sampleRate, freq, juce::MathConstants<double>::sqrt2 * 0.5);
+            break;
+        case BandType::highShelf:
+        case BandType::tilt:
+            c = makeHighPassCoefficients(sampleRate, freq, juce::MathConstants<double>::sqrt2 * 0.5);
+            break;
+        case BandType::peak:
+        case BandType::notch:
+            c = makeBandPassCoefficients(sampleRate, freq, q);
+            break;
+    }
+
+    b0[band] = c.b0;
+    b1[band] = c.b1;
+    b2[band] = c.b2;
+    a1[band] = c.a1;
+    a2[band] = c.a2;
+
+    if (! active[band]) {
+        s1[band] = s2[band] = envelope[band] = 0.0;
+        gainDB[band] = 0.0f;
+        active[band] = true;
+        updateActiveBands();
+    }
+}
+
+void DynamicsDetector::clearBand(int index) {
+    auto band = (size_t) index;
+
+    if (active[band]) {
+        active[band] = false;
+        gainDB[band] = 0.0f;
+        updateActiveBands();
+    }
+}
+
+void DynamicsDetector::updateActiveBands() {
+    numActive = 0;
+
+    for (int band = 0; band < maxBands; ++band) {
+        if (active[(size_t) band]) {
+            activeBands[(size_t) numActive++] = band;
+        }
+    }
+}
+
+void DynamicsDetector::processAppended() {
+    changed.fill(false);
+
+    if (numActive > 0) {
+        processKey(numAppended);
+    }
+
+    numAppended = 0;
+}
+
+void DynamicsDetector::processKey(size_t numSamples) {
+    auto slope = 1.0f - 1.0f / juce::jmax(1.0f, settings.ratio);
+    auto* key = keyScratch.data();
+
+    //Band by band, so each one's filter and follower stay in registers across the sub-block
+    for (int i = 0; i < numActive; ++i) {
+        auto band = (size_t) activeBands[(size_t) i];
+
+        auto lb0 = b0[band], lb1 = b1[band], lb2 = b2[band], la1 = a1[band], la2 = a2[band];
+        auto ls1 = s1[band], ls2 = s2[band];
+        auto env = envelope[band];
+        auto peakPower = 0.0;
+
+        for (size_t n = 0; n < numSamples; ++n) {
+            auto x = (double) key[n];
+            auto y = lb0 * x + ls1;
+            ls1 = lb1 * x - la1 * y + ls2;
+            ls2 = lb2 * x - la2 * y;
+
+            auto power = y * y;
+            env += (power > env ? attackCoefficient : releaseCoefficient) * (power - env);
+            peakPower = juce::jmax(peakPower, env);
+        }
+
+        s1[band] = ls1;
+        s2[band] = ls2;
+        envelope[band] = env;
+
+        //Gain computer on the RMS level, then the step limits
+        auto levelDB = (float) (10.0 * std::log10(juce::jmax(peakPower, 1.0e-12)));
+        auto over = levelDB - settings.thresholdDB;
+        auto target = over > 0.0f ? -juce::jmin(maxReductionDB, over * slope) : 0.0f;
+
+        auto& gain = gainDB[band];
+        auto distance = target - gain;
+
+        if (std::abs(distance) >= minStepDB || (target == 0.0f && gain != 0.0f)) {
+            gain += juce::jlimit(-maxStepDB, maxStepDB, distance);
+            changed[band] = true;
+        }
+    }
+}
@@ -0,0 +1,128 @@
+/*
+  ==============================================================================
+
+    DynamicsDetector.h
+
+    Level detection for the dynamic bands. The key (the main input, or the
+    sidechain bus) is downmixed once per sub-block and shared by every
+    band's detector: a biquad that limits it to the region the band acts
+    on, then an attack/release follower on the filtered signal's power.
+
+    The gain computer runs once per sub-block. Its output moves by at most
+    maxStepDB per sub-block, and only once it is minStepDB away from where
+    it was, so a dynamic band is redesigned at most once per sub-block and
+    not at all while the level holds steady.
+
+  ==============================================================================
+*/
+
+#pragma once
+
+#include <JuceHeader.h>
+#include "CoefficientDesign.h"
+
+class DynamicsDetector {
+public:
+    //The peak band first, then every band bank band
+    static constexpr int maxBands = 1 + maxBankBands;
+
+    struct Settings {
+        float thresholdDB {-24.0f};
+        float ratio {4.0f};
+        float attackMs {5.0f};
+        float releaseMs {100.0f};
+    };
+
+    //Deepest cut the dynamics add on top of a band's own gain
+    static constexpr float maxReductionDB = 24.0f;
+    static constexpr float maxStepDB = 1.0f;
+    static constexpr float minStepDB = 0.05f;
+
+    //Not realtime safe, sizes the key scratch buffer
+    void prepare(double sampleRate, int maximumBlockSize);
+    void reset();
+
+    void setSettings(const Settings& newSettings);
+    const Settings& getSettings() const { return settings; }
+
+    //Listens around freq for peaks and notches, below it for low shelves and above it for high shelves and tilts.
+    //A band that was already active keeps its envelope and gain.
+    void setBand(int index, BandType type, double freq, double q);
+    void clearBand(int index);
+
+    bool isActive(int index) const { return active[(size_t) index]; }
+    bool anyActive() const { return numActive > 0; }
+
+    //Runs one sub-block of the key through every active detector, in pieces if it's longer than the maximumBlockSize
+    //given to prepare()
+    template <typename SampleType>
+    void process(const juce::dsp::AudioBlock<SampleType>& key) {
+        changed.fill(false);
+
+        if (numActive == 0 || key.getNumChannels() == 0) {
+            return;
+        }
+
+        for (size_t start = 0; start < key.getNumSamples();) {
+            auto numSamples = downmix(key.getSubBlock(start), 0);
+            processKey(numSamples);
+            start += numSamples;
+        }
+    }
+
+    //The same over a sub-block collected in pieces, for slices that straddle two blocks.
+    //Up to the maximumBlockSize given to prepare() can be appended between two calls to processAppended().
+    template <typename SampleType>
+    void append(const juce::dsp::AudioBlock<SampleType>& key) {
+        if (key.getNumChannels() > 0) {
+            numAppended += downmix(key, numAppended);
+        }
+    }
+
+    void processAppended();
+
+    //Offset for the band's gain, 0 dB or below
+    float getGainDB(int index) const { return gainDB[(size_t) index]; }
+
+    //Whether the last process() or processAppended() moved the band's gain, which then needs a redesign
+    bool hasGainChanged(int index) const { return changed[(size_t) index]; }
+
+private:
+    double sampleRate {44100.0};
+    Settings settings;
+    double attackCoefficient {1.0}, releaseCoefficient {1.0};
+
+    std::vector<float> keyScratch;
+    size_t numAppended {0};
+
+    //Structure-of-arrays over the bands, the active ones listed in activeBands
+    std::array<double, maxBands> b0 {}, b1 {}, b2 {}, a1 {}, a2 {};
+    std::array<double, maxBands> s1 {}, s2 {}, envelope {};
+    std::array<float, maxBands> gainDB {};
+    std::array<bool, maxBands> active {}, changed {};
+    std::array<int, maxBands> activeBands {};
+    int numActive {0};
+
+    void updateActiveBands();
+    //Adds to changed rather than clearing it, so every piece of a sub-block counts
+    void processKey(size_t numSamples);
+
+    //Mono sum of the key into keyScratch from offset, returns how many samples fitted
+    template <typename SampleType>
+    size_t downmix(const juce::dsp::AudioBlock<SampleType>& key, size_t offset) {
+        auto numSamples = juce::jmin(key.getNumSamples(), keyScratch.size() - offset);
+        auto numChannels = key.getNumChannels();
+        auto gain = 1.0f / (float) numChannels;
+        auto* dest = keyScratch.data() + offset;
+
+        for (size_t ch = 0; ch < numChannels; ++ch) {
+            auto* source = key.getChannelPointer(ch);
+            for (size_t n = 0; n < numSamples; ++n) {
+                auto sample = (float) source[n] * gain;
+                dest[n] = ch == 0 ? sample : dest[n] + sample;
+            }
+        }
+
+        return numSamples;
+    }
+};
@@ -0,0 +1,679 @@
+/*
+  ==============================================================================
+
+    FilterEngines.h
+
+    Compile-time filter engine policies for MonoChain and VectorChain. Both
+    realise the same BiquadCoefficients, so every engine shares the design
+    code and the coefficient cache.
+
+    Each engine's Stage runs a block through one biquad, or one sample
+    through tick() so StageCascade can run a whole cut filter per sample.
+
+    DirectFormEngine  transposed direct form II, what juce::dsp::IIR::Filter
+                      runs. Cheapest, but its state misbehaves under fast
+                      coefficient changes and loses precision for very low
+                      cutoffs at high sample rates.
+    SVFEngine         topology-preserving-transform state variable filter.
+                      A few more multiplies per stage, stays well behaved
+                      under modulation and near DC at 192k and above.
+    MixedPrecisionEngine
+                      direct form with the state kept in the sample type but
+                      every multiply-accumulate done in double. Scalar only,
+                      used to measure what double accumulation buys a float
+                      chain.
+
+    Define SIMPLEEQ_SVF_ENGINE=1 to build with the SVF engine.
+
+    A cut filter of direct form stages can also run as BlockStateSpace,
+    blockLength samples at a time out of fixed matrix products instead of
+    one sample after another. StageCascade switches to it by itself for the
+    steeper slopes once their coefficients have settled.
+
+  ==============================================================================
+*/
+
+#pragma once
+
+#include <JuceHeader.h>
+#include "CoefficientDesign.h"
+
+//Turns a designed coefficient into the engine's sample type, scalar or SIMDRegister. setLane() writes a
+//single channel's value, for VectorChain lanes that don't share settings; a scalar is one lane.
+template <typename T>
+struct Broadcast {
+    using Element = T;
+    static constexpr size_t numLanes = 1;
+
+    static T from(double value) { return static_cast<T>(value); }
+    static void setLane(T& target, size_t, double value) { target = static_cast<T>(value); }
+};
+
+#if JUCE_USE_SIMD
+template <typename ElementType>
+struct Broadcast<juce::dsp::SIMDRegister<ElementType>> {
+    using Element = ElementType;
+    static constexpr size_t numLanes = juce::dsp::SIMDRegister<ElementType>::SIMDNumElements;
+
+    static juce::dsp::SIMDRegister<ElementType> from(double value) {
+        return juce::dsp::SIMDRegister<ElementType>::expand(static_cast<ElementType>(value));
+    }
+
+    static void setLane(juce::dsp::SIMDRegister<ElementType>& target, size_t lane, double value) {
+        target.set(lane, static_cast<ElementType>(value));
+    }
+};
+#endif
+
+//The Simper/Cytomic SVF that has the same transfer function as a bilinear-transformed biquad
+struct SVFCoefficients {
+    double a1 {1.0}, a2 {0.0}, a3 {0.0};
+    double m0 {1.0}, m1 {0.0}, m2 {0.0};
+};
+
+inline SVFCoefficients makeSVFCoefficients(const BiquadCoefficients& c) {
+    //The denominator at z = 1 and z = -1 gives back the prewarped cutoff g and damping k
+    auto dcDenominator = 1.0 + c.a1 + c.a2;
+    auto nyquistDenominator = 1.0 - c.a1 + c.a2;
+    jassert(dcDenominator > 0.0 && nyquistDenominator > 0.0);
+
+    auto g = std::sqrt(dcDenominator / nyquistDenominator);
+    auto k = 2.0 * (1.0 - c.a2) / (nyquistDenominator * g);
+    auto a0 = 4.0 / nyquistDenominator;
+
+    //Numerator of the analog prototype, c2 s^2 + c1 s + c0
+    auto c2 = a0 * (c.b0 - c.b1 + c.b2) * 0.25;
+    auto c1 = a0 * (c.b0 - c.b2) / (2.0 * g);
+    auto c0 = a0 * (c.b0 + c.b1 + c.b2) / (4.0 * g * g);
+
+    SVFCoefficients svf;
+    svf.a1 = 1.0 / (1.0 + g * (g + k));
+    svf.a2 = g * svf.a1;
+    svf.a3 = g * svf.a2;
+    svf.m0 = c2;
+    svf.m1 = c1 - k * c2;
+    svf.m2 = c0 - c2;
+    return svf;
+}
+
+//Runs a single engine Stage as a drop-in for juce::dsp::IIR::Filter inside a ProcessorChain
+template <typename StageType>
+class StageFilter {
+public:
+    StageFilter() { stage.setCoefficients({}); stage.reset(); }
+
+    void prepare(const juce::dsp::ProcessSpec&) { reset(); }
+    void reset() { stage.reset(); }
+
+    template <typename ProcessContext>
+    void process(const ProcessContext& context) noexcept {
+        auto&& inputBlock = context.getInputBlock();
+        auto&& outputBlock = context.getOutputBlock();
+        jassert(inputBlock.getNumChannels() == 1);
+
+        if (context.isBypassed) {
+            if (context.usesSeparateInputAndOutputBlocks()) {
+                outputBlock.copyFrom(inputBlock);
+            }
+            return;
+        }
+
+        stage.process(inputBlock.getChannelPointer(0), outputBlock.getChannelPointer(0), inputBlock.getNumSamples());
+    }
+
+    StageType stage;
+};
+
+struct DirectFormEngine {
+    template <typename T>
+    struct Stage {
+        T b0, b1, b2, a1, a2;
+        T s1, s2;
+
+        void setCoefficients(const BiquadCoefficients& c) {
+            b0 = Broadcast<T>::from(c.b0);
+            b1 = Broadcast<T>::from(c.b1);
+            b2 = Broadcast<T>::from(c.b2);
+            a1 = Broadcast<T>::from(c.a1);
+            a2 = Broadcast<T>::from(c.a2);
+        }
+
+        //One lane of a SIMDRegister stage, the other lanes keep theirs
+        void setLaneCoefficients(size_t lane, const BiquadCoefficients& c) {
+            Broadcast<T>::setLane(b0, lane, c.b0);
+            Broadcast<T>::setLane(b1, lane, c.b1);
+            Broadcast<T>::setLane(b2, lane, c.b2);
+            Broadcast<T>::setLane(a1, lane, c.a1);
+            Broadcast<T>::setLane(a2, lane, c.a2);
+        }
+
+        void reset() {
+            s1 = Broadcast<T>::from(0.0);
+            s2 = Broadcast<T>::from(0.0);
+        }
+
+        T tick(T x) noexcept {
+            auto y = b0 * x + s1;
+            s1 = b1 * x - a1 * y + s2;
+            s2 = b2 * x - a2 * y;
+            return y;
+        }
+
+        //Runs on a local copy, which keeps the coefficients and state in registers for the whole run
+        void process(const T* input, T* output, size_t numSamples) noexcept {
+            auto local = *this;
+
+            for (size_t n = 0; n < numSamples; ++n) {
+                output[n] = local.tick(input[n]);
+            }
+
+            s1 = local.s1;
+            s2 = local.s2;
+        }
+    };
+
+    template <typename SampleType>
+    using Filter = juce::dsp::IIR::Filter<SampleType>;
+};
+
+struct SVFEngine {
+    template <typename T>
+    struct Stage {
+        T a1, a2, a3, m0, m1, m2;
+        T ic1eq, ic2eq;
+
+        void setCoefficients(const BiquadCoefficients& c) {
+            auto svf = makeSVFCoefficients(c);
+            a1 = Broadcast<T>::from(svf.a1);
+            a2 = Broadcast<T>::from(svf.a2);
+            a3 = Broadcast<T>::from(svf.a3);
+            m0 = Broadcast<T>::from(svf.m0);
+            m1 = Broadcast<T>::from(svf.m1);
+            m2 = Broadcast<T>::from(svf.m2);
+        }
+
+        void setLaneCoefficients(size_t lane, const BiquadCoefficients& c) {
+            auto svf = makeSVFCoefficients(c);
+            Broadcast<T>::setLane(a1, lane, svf.a1);
+            Broadcast<T>::setLane(a2, lane, svf.a2);
+            Broadcast<T>::setLane(a3, lane, svf.a3);
+            Broadcast<T>::setLane(m0, lane, svf.m0);
+            Broadcast<T>::setLane(m1, lane, svf.m1);
+            Broadcast<T>::setLane(m2, lane, svf.m2);
+        }
+
+        void reset() {
+            ic1eq = Broadcast<T>::from(0.0);
+            ic2eq = Broadcast<T>::from(0.0);
+        }
+
+        T tick(T v0) noexcept {
+            auto v3 = v0 - ic2eq;
+            auto v1 = a1 * ic1eq + a2 * v3;
+            auto v2 = ic2eq + a2 * ic1eq + a3 * v3;
+            ic1eq = v1 + v1 - ic1eq;
+            ic2eq = v2 + v2 - ic2eq;
+            return m0 * v0 + m1 * v1 + m2 * v2;
+        }
+
+        void process(const T* input, T* output, size_t numSamples) noexcept {
+            auto local = *this;
+
+            for (size_t n = 0; n < numSamples; ++n) {
+                output[n] = local.tick(input[n]);
+            }
+
+            ic1eq = local.ic1eq;
+            ic2eq = local.ic2eq;
+        }
+    };
+
+    template <typename SampleType>
+    using Filter = StageFilter<Stage<SampleType>>;
+};
+
+struct MixedPrecisionEngine {
+    template <typename T>
+    struct Stage {
+        double b0, b1, b2, a1, a2;
+        T s1, s2;
+
+        void setCoefficients(const BiquadCoefficients& c) {
+            b0 = c.b0;
+            b1 = c.b1;
+            b2 = c.b2;
+            a1 = c.a1;
+            a2 = c.a2;
+        }
+
+        void reset() {
+            s1 = T(0);
+            s2 = T(0);
+        }
+
+        T tick(T input) noexcept {
+            auto x = (double) input;
+            auto y = b0 * x + (double) s1;
+            s1 = static_cast<T>(b1 * x - a1 * y + (double) s2);
+            s2 = static_cast<T>(b2 * x - a2 * y);
+            return static_cast<T>(y);
+        }
+
+        void process(const T* input, T* output, size_t numSamples) noexcept {
+            auto local = *this;
+
+            for (size_t n = 0; n < numSamples; ++n) {
+                output[n] = local.tick(input[n]);
+            }
+
+            s1 = local.s1;
+            s2 = local.s2;
+        }
+    };
+
+    template <typename SampleType>
+    using Filter = StageFilter<Stage<SampleType>>;
+};
+
+//Which kernel a StageCascade of DirectFormEngine stages runs, the other engines always run per sample
+enum class CascadeKernel {
+    automatic,  //BlockStateSpace for long enough runs of the steeper slopes, once their coefficients have settled
+    perSample,  //The recurrence, one sample after another
+    block       //BlockStateSpace for every long enough run, whatever the slope, for measuring it
+
+    //Both block settings leave a cascade on the per-sample loop when its poles are too close to the unit
+    //circle for BlockStateSpace in the sample type, see getMinimumPoleMargin()
+};
+
+//A transposed direct form cascade in block state-space form. In the per-sample loop every stage waits on the
+//output of the one before it and on its own last output, so each sample is a chain of dependent multiplies.
+//Here the outputs y of a whole block and the state s' after it come out of one fixed matrix product of the
+//block's input x and the state s before it:
+//
+//    [ y  ]   [ feedthrough  observability ] [ x ]
+//    [ s' ] = [ control      transition    ] [ s ]
+//
+//taken a column at a time, so every step is a multiply-add down all the rows with no dependency between them.
+//That pipelines and vectorises, across the samples for a scalar cascade and on top of the lanes for a
+//SIMDRegister one. It takes more multiplies than the recurrence, which the steeper slopes make up for in latency.
+//The state is the stages' own s1 and s2, so a run can move between this and the per-sample loop at any sample.
+template <typename T>
+class BlockStateSpace {
+public:
+    static constexpr int blockLength = 8;
+    static constexpr int maxOrder = 2 * maxCutStages;
+
+    using Stage = DirectFormEngine::Stage<T>;
+
+    //Rounding the matrix to the sample type moves a close pair of poles by about the square root of its epsilon,
+    //which pushes the poles of a cut far below the sample rate past the unit circle: a float low cut at 20 Hz
+    //with 8x oversampling at 96 kHz blows up. Cascades with less margin than this have to run per sample.
+    static double getMinimumPoleMargin() {
+        return std::sqrt((double) std::numeric_limits<typename Broadcast<T>::Element>::epsilon());
+    }
+
+    //1 minus the largest pole radius of the first numStages biquads
+    static double getPoleMargin(const BiquadCoefficients* biquads, int numStages) {
+        auto margin = 1.0;
+
+        for (size_t i = 0; i < (size_t) numStages; ++i) {
+            auto& c = biquads[i];
+            auto discriminant = c.a1 * c.a1 - 4.0 * c.a2;
+            auto radius = discriminant < 0.0 ? std::sqrt(c.a2) : (std::abs(c.a1) + std::sqrt(discriminant)) * 0.5;
+            margin = juce::jmin(margin, 1.0 - radius);
+        }
+
+        return margin;
+    }
+
+    //One lane's matrix, from its first numStages biquads. It is read off the cascade itself run in double,
+    //(numStages * 2 + 1) * blockLength samples of it, which is too much to redo on every coefficient change.
+    void setLane(size_t lane, const BiquadCoefficients* biquads, int numStages) {
+        auto order = (size_t) (2 * numStages);
+        std::array<double, (size_t) maxOrder> state {};
+
+        auto tick = [&](double x) {
+            for (size_t i = 0; i < (size_t) numStages; ++i) {
+                auto& c = biquads[i];
+                auto& s1 = state[2 * i];
+                auto& s2 = state[2 * i + 1];
+                auto y = c.b0 * x + s1;
+                s1 = c.b1 * x - c.a1 * y + s2;
+                s2 = c.b2 * x - c.a2 * y;
+                x = y;
+            }
+            return x;
+        };
+
+        numUsedColumns = (size_t) blockLength + order;
+
+        auto setColumn = [&](size_t column, size_t row, double value) {
+            Broadcast<T>::setLane(columns[column][row], lane, value);
+        };
+
+        //An impulse from rest gives the impulse response, and after i + 1 samples the state that the input
+        //i samples before the end of the block leaves behind
+        std::array<double, (size_t) blockLength> response;
+
+        for (size_t i = 0; i < (size_t) blockLength; ++i) {
+            response[i] = tick(i == 0 ? 1.0 : 0.0);
+
+            for (size_t r = 0; r < order; ++r) {
+                setColumn((size_t) blockLength - 1 - i, (size_t) blockLength + r, state[r]);
+            }
+        }
+
+        for (size_t k = 0; k < (size_t) blockLength; ++k) {
+            for (size_t i = 0; i < (size_t) blockLength; ++i) {
+                setColumn(k, i, i >= k ? response[i - k] : 0.0);
+            }
+        }
+
+        //With no input, each unit state gives its column: the block it rings out, then what it has decayed to
+        for (size_t j = 0; j < order; ++j) {
+            state.fill(0.0);
+            state[j] = 1.0;
+
+            for (size_t i = 0; i < (size_t) blockLength; ++i) {
+                setColumn((size_t) blockLength + j, i, tick(0.0));
+            }
+            for (size_t r = 0; r < order; ++r) {
+                setColumn((size_t) blockLength + j, (size_t) blockLength + r, state[r]);
+            }
+        }
+    }
+
+    //numBlocks * blockLength samples through the first NumStages stages, which have to match setLane()'s numStages.
+    //input and output may be the same.
+    template <int NumStages>
+    void process(Stage* cascade, const T* input, T* output, size_t numBlocks) const noexcept {
+        constexpr size_t size = (size_t) blockLength + 2 * (size_t) NumStages;
+        jassert(numUsedColumns == size);
+
+        //The rows stay a fixed count for the compiler to vectorise, the columns a loop it doesn't unroll into
+        //size * size scalar multiplies
+        const size_t numColumns = numUsedColumns;
+
+        //The block's samples and then the state, going into the product and coming out of it
+        std::array<T, size> in, out;
+        for (size_t i = 0; i < (size_t) NumStages; ++i) {
+            out[(size_t) blockLength + 2 * i] = cascade[i].s1;
+            out[(size_t) blockLength + 2 * i + 1] = cascade[i].s2;
+        }
+
+        for (size_t b = 0; b < numBlocks; ++b, input += blockLength, output += blockLength) {
+            std::copy(input, input + blockLength, in.begin());
+            std::copy(out.begin() + blockLength, out.end(), in.begin() + blockLength);
+
+            out.fill(Broadcast<T>::from(0.0));
+
+            for (size_t column = 0; column < numColumns; ++column) {
+                auto& values = columns[column];
+                auto scale = in[column];
+
+                for (size_t row = 0; row < size; ++row) {
+                    out[row] += values[row] * scale;
+                }
+            }
+
+            std::copy(out.begin(), out.begin() + blockLength, output);
+        }
+
+        for (size_t i = 0; i < (size_t) NumStages; ++i) {
+            cascade[i].s1 = out[(size_t) blockLength + 2 * i];
+            cascade[i].s2 = out[(size_t) blockLength + 2 * i + 1];
+        }
+    }
+
+private:
+    //Column k < blockLength scales input k and column blockLength + j state j. Each holds the rows for the block's
+    //outputs and then the rows for the next state, of which a cascade of fewer stages uses the first 2 * numStages.
+    std::array<std::array<T, (size_t) (blockLength + maxOrder)>, (size_t) (blockLength + maxOrder)> columns;
+    size_t numUsedColumns {0};
+};
+
+//A whole low or high cut, 1 to maxCutStages biquads of one Engine. Every stage count is its own
+//instantiation with a fixed trip count, so the per-sample loop over the stages unrolls and their state
+//lives in locals; setCoefficients() picks the instantiation once per slope change instead of every
+//sample paying for the unused stages.
+//
+//Direct form cascades also keep a BlockStateSpace, built the first time a run takes it after the coefficients
+//last changed. In CascadeKernel::automatic that waits until they have held for settleSamples, so a sweep keeps
+//to the per-sample loop and pays nothing for the matrices, and only for minAutomaticStages stages and up, where
+//the block form comes out ahead. Either kernel leaves the same state behind, up to rounding. A cascade whose
+//poles sit too close to the unit circle for the block form in its sample type always runs per sample.
+template <typename Engine, typename T>
+class StageCascade {
+public:
+    using Stage = typename Engine::template Stage<T>;
+
+    StageCascade() {
+        for (auto& stage : stages) {
+            stage.setCoefficients({});
+            stage.reset();
+        }
+
+        setNumStages(1);
+    }
+
+    static constexpr size_t numLanes = Broadcast<T>::numLanes;
+
+    //The stages past the slope are set to unity, in case another lane's steeper slope brings them in later
+    void setCoefficients(const CutCoefficients& cut) {
+        jassert(cut.numStages > 0 && cut.numStages <= maxCutStages);
+        auto count = juce::jlimit(1, maxCutStages, cut.numStages);
+
+        for (int i = 0; i < maxCutStages; ++i) {
+            stages[(size_t) i].setCoefficients(i < count ? cut.stages[(size_t) i] : BiquadCoefficients {});
+        }
+
+        for (size_t lane = 0; lane < numLanes; ++lane) {
+            setLaneBiquads(lane, cut, count);
+        }
+
+        laneStages.fill(count);
+        setNumStages(count);
+    }
+
+    //One lane's cut, for VectorChain channels that don't share settings. The cascade runs as many stages as
+    //the steepest lane needs and the other lanes run their extra stages as unity, as a bypassed lane runs all of them.
+    void setLaneCoefficients(size_t lane, const CutCoefficients& cut, bool bypassed) {
+        jassert(lane < numLanes);
+        auto count = bypassed ? 0 : juce::jlimit(1, maxCutStages, cut.numStages);
+
+        for (int i = 0; i < maxCutStages; ++i) {
+            stages[(size_t) i].setLaneCoefficients(lane, i < count ? cut.stages[(size_t) i] : BiquadCoefficients {});
+        }
+
+        setLaneBiquads(lane, cut, count);
+        laneStages[lane] = count;
+        setNumStages(juce::jmax(1, *std::max_element(laneStages.begin(), laneStages.end())));
+    }
+
+    int getNumStages() const { return numStages; }
+
+    void setKernel(CascadeKernel kernelToUse) { kernel = kernelToUse; }
+    CascadeKernel getKernel() const { return kernel; }
+
+    //Clears the stages the current slope leaves out too, so switching to a steeper slope starts them from rest
+    void reset() {
+        for (auto& stage : stages) {
+            stage.reset();
+        }
+    }
+
+    void process(const T* input, T* output, size_t numSamples) noexcept {
+        if constexpr (hasBlockForm) {
+            if (shouldRunBlockForm(numSamples)) {
+                //The samples past the last whole block take the per-sample loop, on from the state the blocks left
+                auto numBlocks = numSamples / (size_t) BlockForm::blockLength;
+                auto numBlockSamples = numBlocks * (size_t) BlockForm::blockLength;
+
+                processBlockForm(blockForm, stages.data(), input, output, numBlocks);
+                processStages(stages.data(), input + numBlockSamples, output + numBlockSamples, numSamples - numBlockSamples);
+                return;
+            }
+        }
+
+        processStages(stages.data(), input, output, numSamples);
+    }
+
+private:
+    static constexpr bool hasBlockForm = std::is_same<Engine, DirectFormEngine>::value;
+
+    struct NoBlockForm {};
+    using BlockForm = std::conditional_t<hasBlockForm, BlockStateSpace<T>, NoBlockForm>;
+    using BlockProcessor = void (*)(const BlockForm&, Stage*, const T*, T*, size_t);
+
+    //What CascadeKernel::automatic waits for. From four stages up the block form comes out ahead even with SSE2
+    //doubles, below that it depends on the vector width the build targets. Runs shorter than two blocks spend
+    //more on moving the state in and out than they gain.
+    static constexpr int minAutomaticStages = 4;
+    static constexpr size_t settleSamples = 8192;
+    static constexpr size_t minBlockFormRun = 2 * (size_t) BlockStateSpace<T>::blockLength;
+
+    //Past four biquads the coefficients no longer fit in registers, so longer cascades take a second pass
+    static constexpr int maxFusedStages = 4;
+
+    using Processor = void (*)(Stage*, const T*, T*, size_t);
+
+    template <int NumStages>
+    static void processFused(Stage* cascade, const T* input, T* output, size_t numSamples) noexcept {
+        if constexpr (NumStages > maxFusedStages) {
+            processFused<maxFusedStages>(cascade, input, output, numSamples);
+            processFused<NumStages - maxFusedStages>(cascade + maxFusedStages, output, output, numSamples);
+        } else {
+            std::array<Stage, (size_t) NumStages> local;
+            std::copy(cascade, cascade + NumStages, local.begin());
+
+            for (size_t n = 0; n < numSamples; ++n) {
+                auto x = input[n];
+                for (auto& stage : local) {
+                    x = stage.tick(x);
+                }
+                output[n] = x;
+            }
+
+            std::copy(local.begin(), local.end(), cascade);
+        }
+    }
+
+    template <size_t... Counts>
+    static Processor getProcessor(int count, std::index_sequence<Counts...>) {
+        static constexpr Processor processors[] { &processFused<(int) Counts + 1>... };
+        return processors[count - 1];
+    }
+
+    template <int NumStages>
+    static void processBlocks(const BlockForm& form, Stage* cascade, const T* input, T* output, size_t numBlocks) noexcept {
+        form.template process<NumStages>(cascade, input, output, numBlocks);
+    }
+
+    template <size_t... Counts>
+    static BlockProcessor getBlockProcessor(int count, std::index_sequence<Counts...>) {
+        static constexpr BlockProcessor processors[] { &processBlocks<(int) Counts + 1>... };
+        return processors[count - 1];
+    }
+
+    void setNumStages(int count) {
+        if (count != numStages) {
+            coefficientsChanged();
+        }
+
+        numStages = count;
+        processStages = getProcessor(numStages, std::make_index_sequence<(size_t) maxCutStages>());
+
+        if constexpr (hasBlockForm) {
+            processBlockForm = getBlockProcessor(numStages, std::make_index_sequence<(size_t) maxCutStages>());
+        }
+    }
+
+    //Keeps a copy of what the lane runs for building the block form, which has to start over when it moved
+    void setLaneBiquads(size_t lane, const CutCoefficients& cut, int count) {
+        for (int i = 0; i < maxCutStages; ++i) {
+            auto biquad = i < count ? cut.stages[(size_t) i] : BiquadCoefficients {};
+            auto& kept = laneBiquads[lane][(size_t) i];
+
+            if (biquad.b0 != kept.b0 || biquad.b1 != kept.b1 || biquad.b2 != kept.b2 || biquad.a1 != kept.a1 || biquad.a2 != kept.a2) {
+                kept = biquad;
+                coefficientsChanged();
+            }
+        }
+    }
+
+    void coefficientsChanged() {
+        samplesSinceChange = 0;
+        blockFormReady = false;
+    }
+
+    bool shouldRunBlockForm(size_t numSamples) noexcept {
+        samplesSinceChange = juce::jmin(samplesSinceChange + numSamples, settleSamples);
+
+        if (kernel == CascadeKernel::perSample || numSamples < minBlockFormRun) {
+            return false;
+        }
+
+        if (kernel == CascadeKernel::automatic && (numStages < minAutomaticStages || samplesSinceChange < settleSamples)) {
+            return false;
+        }
+
+        if (! blockFormReady) {
+            //Every lane runs numStages stages, the ones past its own slope as unity
+            auto margin = 1.0;
+            for (size_t lane = 0; lane < numLanes; ++lane) {
+                margin = juce::jmin(margin, BlockForm::getPoleMargin(laneBiquads[lane].data(), numStages));
+            }
+
+            blockFormStable = margin >= BlockForm::getMinimumPoleMargin();
+
+            for (size_t lane = 0; lane < numLanes && blockFormStable; ++lane) {
+                blockForm.setLane(lane, laneBiquads[lane].data(), numStages);
+            }
+
+            blockFormReady = true;
+        }
+
+        return blockFormStable;
+    }
+
+    std::array<Stage, (size_t) maxCutStages> stages;
+    std::array<int, numLanes> laneStages {};
+    int numStages {1};
+    Processor processStages {&processFused<1>};
+
+    std::array<std::array<BiquadCoefficients, (size_t) maxCutStages>, numLanes> laneBiquads {};
+    CascadeKernel kernel {CascadeKernel::automatic};
+    size_t samplesSinceChange {0};
+    bool blockFormReady {false}, blockFormStable {false};
+    BlockForm blockForm;
+    BlockProcessor processBlockForm {nullptr};
+};
+
+#if SIMPLEEQ_SVF_ENGINE
+using SelectedFilterEngine = SVFEngine;
+#else
+using SelectedFilterEngine = DirectFormEngine;
+#endif
+
+//Cut filters for MonoChain, one StageCascade run through the same ProcessorChain wrapper as a single stage
+template <typename Engine, typename SampleType>
+using CascadeFilter = StageFilter<StageCascade<Engine, SampleType>>;
+
+template <typename Engine, typename SampleType>
+void applyCoefficients(CascadeFilter<Engine, SampleType>& filter, const CutCoefficients& cut) {
+    filter.stage.setCoefficients(cut);
+}
+
+template <typename Engine, typename SampleType>
+void setCascadeKernel(CascadeFilter<Engine, SampleType>& filter, CascadeKernel kernel) {
+    filter.stage.setKernel(kernel);
+}
+
+//Stage filters keep their coefficients inline, so there is nothing to allocate
+template <typename StageType>
+void allocateBiquadStorage(StageFilter<StageType>&) {}
+
+template <typename StageType>
+void applyCoefficients(StageFilter<StageType>& filter, const BiquadCoefficients& c) {
+    filter.stage.setCoefficients(c);
+}
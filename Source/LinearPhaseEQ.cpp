@@ -0,0 +1,266 @@
+/*
+  ==============================================================================
+
+    LinearPhaseEQ.cpp
+
+  ==============================================================================
+*/
+
+#include "LinearPhaseEQ.h"
+
+int LinearPhaseEQ::getFirLength(Quality quality, double sampleRate) {
+    int baseLength = 16384;
+
+    switch (quality) {
+        case Quality::low:      baseLength = 4096;  break;
+        case Quality::standard: baseLength = 16384; break;
+        case Quality::high:     baseLength = 65536; break;
+    }
+
+    auto rateMultiple = juce::nextPowerOfTwo(juce::jmax(1, (int) std::ceil(sampleRate / 48000.0)));
+    return juce::jmin(1 << 19, baseLength * rateMultiple);
+}
+
+LinearPhaseEQ::LinearPhaseEQ(CoefficientSource source) : coefficientSource(std::move(source)) {
+}
+
+LinearPhaseEQ::~LinearPhaseEQ() {
+    release();
+}
+
+void LinearPhaseEQ::prepare(double newSampleRate, int maximumBlockSize, int numChannels, Quality quality) {
+    release();
+
+    sampleRate = newSampleRate;
+    firLength = getFirLength(quality, sampleRate);
+
+    juce::dsp::ProcessSpec spec { sampleRate, (juce::uint32) maximumBlockSize, 1 };
+
+    //The smallest partitions cost many times as much for FIRs this long
+    juce::dsp::Convolution::Latency latency { juce::jmax(256, firLength / 32) };
+
+    auto addConvolutions = [&](auto& engines, int numEngines) {
+        for (int ch = 0; ch < numEngines; ++ch) {
+            auto convolution = std::make_unique<juce::dsp::Convolution>(latency, service->getConvolutionQueue());
+            convolution->prepare(spec);
+            engines.push_back(std::move(convolution));
+        }
+    };
+
+    addConvolutions(convolutions, numChannels);
+    addConvolutions(crossConvolutions, numChannels == 2 ? 2 : 0);
+    partitionLatency = convolutions.empty() ? 0 : convolutions.front()->getLatency();
+
+    scratch.setSize(numChannels, maximumBlockSize);
+    crossScratch.setSize(crossConvolutions.empty() ? 0 : 2, maximumBlockSize);
+
+    crossRunning = false;
+    crossHoldSamples = firLength + (int) std::ceil(sampleRate * 0.25);
+    crossHoldRemaining = 0;
+
+    redesignPending = false;
+    designQueued = false;
+    loadFIR();
+    startupRemaining = (int) std::ceil(sampleRate * 0.1);
+    service->addClient(*this);
+}
+
+void LinearPhaseEQ::release() {
+    //No new job gets queued once the service stops visiting, then the one in flight is waited for
+    service->removeClient(*this);
+    service->getPool().removeJob(&designJob, false, -1);
+    convolutions.clear();
+    crossConvolutions.clear();
+    scratch.setSize(0, 0);
+    crossScratch.setSize(0, 0);
+}
+
+void LinearPhaseEQ::process(juce::dsp::AudioBlock<float>& block) {
+    auto numChannels = juce::jmin(block.getNumChannels(), convolutions.size());
+    auto numSamples = block.getNumSamples();
+    auto cross = updateCrossRunning((int) numSamples) && numChannels == 2;
+
+    //Each channel's b term is the other channel's input, taken before the block is filtered in place
+    if (cross) {
+        for (size_t ch = 0; ch < 2; ++ch) {
+            auto crossBlock = juce::dsp::AudioBlock<float>(crossScratch).getSingleChannelBlock(ch).getSubBlock(0, numSamples);
+            crossBlock.copyFrom(block.getSingleChannelBlock(1 - ch));
+            crossConvolutions[ch]->process(juce::dsp::ProcessContextReplacing<float>(crossBlock));
+        }
+    }
+
+    for (size_t ch = 0; ch < numChannels; ++ch) {
+        auto channelBlock = block.getSingleChannelBlock(ch);
+        convolutions[ch]->process(juce::dsp::ProcessContextReplacing<float>(channelBlock));
+
+        if (cross) {
+            channelBlock.add(juce::dsp::AudioBlock<float>(crossScratch).getSingleChannelBlock(ch).getSubBlock(0, numSamples));
+        }
+    }
+
+    //The convolutions still run meanwhile, so the FIR has history from the moment it swaps in. Input before that is
+    //lost, a few ms of the loader's time just after prepare().
+    if (startupRemaining > 0) {
+        if (isFirstFIRLoaded()) {
+            startupRemaining -= (int) numSamples;
+        }
+        block.clear();
+    }
+}
+
+bool LinearPhaseEQ::isFirstFIRLoaded() const {
+    auto loaded = [this](const auto& convolution) { return convolution->getCurrentIRSize() == firLength; };
+    return std::all_of(convolutions.begin(), convolutions.end(), loaded)
+        && std::all_of(crossConvolutions.begin(), crossConvolutions.end(), loaded);
+}
+
+//Cross terms start from rest when a design needs them, so a switch into mid/side misses their first FIR length of
+//history the way the minimum phase chains start theirs from rest
+bool LinearPhaseEQ::updateCrossRunning(int numSamples) {
+    if (crossConvolutions.empty()) {
+        return false;
+    }
+
+    if (crossNeeded.load(std::memory_order_acquire)) {
+        if (! crossRunning) {
+            for (auto& convolution : crossConvolutions) {
+                convolution->reset();
+            }
+            crossRunning = true;
+        }
+
+        crossHoldRemaining = crossHoldSamples;
+    } else if (crossRunning) {
+        crossHoldRemaining -= numSamples;
+        crossRunning = crossHoldRemaining > 0;
+    }
+
+    return crossRunning;
+}
+
+void LinearPhaseEQ::process(juce::dsp::AudioBlock<double>& block) {
+    auto numChannels = juce::jmin(block.getNumChannels(), (size_t) scratch.getNumChannels());
+    auto numSamples = block.getNumSamples();
+    jassert(numSamples <= (size_t) scratch.getNumSamples());
+
+    for (size_t ch = 0; ch < numChannels; ++ch) {
+        auto* source = block.getChannelPointer(ch);
+        auto* dest = scratch.getWritePointer((int) ch);
+        for (size_t n = 0; n < numSamples; ++n) {
+            dest[n] = (float) source[n];
+        }
+    }
+
+    auto floatBlock = juce::dsp::AudioBlock<float>(scratch).getSubsetChannelBlock(0, numChannels).getSubBlock(0, numSamples);
+    process(floatBlock);
+
+    for (size_t ch = 0; ch < numChannels; ++ch) {
+        auto* source = scratch.getReadPointer((int) ch);
+        auto* dest = block.getChannelPointer(ch);
+        for (size_t n = 0; n < numSamples; ++n) {
+            dest[n] = (double) source[n];
+        }
+    }
+}
+
+void LinearPhaseEQ::serviceTick(double) {
+    if (redesignPending.exchange(false, std::memory_order_acquire)) {
+        designQueued = true;
+    }
+
+    //A change that lands while a design is running waits for it to finish and gets a job of its own
+    auto& pool = service->getPool();
+    if (designQueued && ! pool.contains(&designJob)) {
+        designQueued = false;
+        pool.addJob(&designJob, false);
+    }
+}
+
+void LinearPhaseEQ::loadFIR() {
+    auto coefficients = coefficientSource(sampleRate);
+    auto first = service->getFIR(coefficients.first, sampleRate, firLength);
+    auto second = service->getFIR(coefficients.second, sampleRate, firLength);
+
+    //Left/right, or a and b for mid/side, which are the same for both channels
+    std::array<juce::AudioBuffer<float>, 2> direct { juce::AudioBuffer<float>(*first), juce::AudioBuffer<float>(*second) };
+    juce::AudioBuffer<float> cross(1, firLength);
+    cross.clear();
+
+    auto midSide = coefficients.midSide && convolutions.size() == 2;
+    if (midSide) {
+        for (int n = 0; n < firLength; ++n) {
+            auto mid = first->getSample(0, n), side = second->getSample(0, n);
+            direct[0].setSample(0, n, 0.5f * (mid + side));
+            cross.setSample(0, n, 0.5f * (mid - side));
+        }
+        direct[1].makeCopyOf(direct[0]);
+    }
+
+    //Before the loads, so the cross terms have been fed for as long as possible by the time theirs lands
+    crossNeeded.store(midSide, std::memory_order_release);
+
+    //Convolution hands these to the service's loader and crossfades once they're ready
+    auto load = [this](juce::dsp::Convolution& convolution, const juce::AudioBuffer<float>& fir) {
+        convolution.loadImpulseResponse(juce::AudioBuffer<float>(fir), sampleRate, juce::dsp::Convolution::Stereo::no,
+                                        juce::dsp::Convolution::Trim::no, juce::dsp::Convolution::Normalise::no);
+    };
+
+    for (size_t ch = 0; ch < convolutions.size(); ++ch) {
+        load(*convolutions[ch], direct[juce::jmin(ch, (size_t) 1)]);
+    }
+    for (auto& convolution : crossConvolutions) {
+        load(*convolution, cross);
+    }
+}
+
+void LinearPhaseEQ::designFIR(const ChainCoefficients& chainCoefficients, juce::AudioBuffer<float>& fir) {
+    auto length = fir.getNumSamples();
+    jassert(juce::isPowerOfTwo(length));
+
+    auto numBins = (size_t) length / 2 + 1;
+
+    //|H|^2 on the FFT grid, bin k sits at w = 2 pi k / length
+    std::vector<double> phi(numBins), magnitudeSquared(numBins, 1.0);
+    for (size_t k = 0; k < numBins; ++k) {
+        auto s = std::sin(juce::MathConstants<double>::pi * (double) k / (double) length);
+        phi[k] = s * s;
+    }
+
+    accumulateChainMagnitudeSquared(chainCoefficients, phi.data(), magnitudeSquared.data(), numBins);
+
+    //A real, even spectrum, so the inverse transform is a real impulse symmetric about sample 0
+    std::vector<std::complex<float>> spectrum((size_t) length), impulse((size_t) length);
+    double spectrumEnergy = 0.0;
+
+    for (size_t k = 0; k < numBins; ++k) {
+        auto magnitude = (float) std::sqrt(juce::jmax(0.0, magnitudeSquared[k]));
+        spectrum[k] = magnitude;
+
+        if (k > 0 && k < numBins - 1) {
+            spectrum[(size_t) length - k] = magnitude;
+            spectrumEnergy += 2.0 * magnitudeSquared[k];
+        } else {
+            spectrumEnergy += magnitudeSquared[k];
+        }
+    }
+
+    juce::dsp::FFT fft(juce::roundToInt(std::log2((double) length)));
+    fft.perform(spectrum.data(), impulse.data(), true);
+
+    //FFT back ends scale their inverse differently, so normalise with Parseval instead of trusting one
+    double impulseEnergy = 0.0;
+    for (auto& sample : impulse) {
+        impulseEnergy += (double) sample.real() * (double) sample.real();
+    }
+
+    auto scale = impulseEnergy > 0.0 ? std::sqrt(spectrumEnergy / (double) length / impulseEnergy) : 0.0;
+
+    //Rotate the centre to length / 2 and taper with a periodic Blackman window, which is symmetric about it
+    auto* out = fir.getWritePointer(0);
+    auto twoPi = juce::MathConstants<double>::twoPi;
+
+    for (int n = 0; n < length; ++n) {
+        auto window = 0.42 - 0.5 * std::cos(twoPi * n / length) + 0.08 * std::cos(2.0 * twoPi * n / length);
+        out[n] = (float) (impulse[(size_t) ((n + length / 2) % length)].real() * scale * window);
+    }
+}
@@ -0,0 +1,132 @@
+/*
+  ==============================================================================
+
+    LinearPhaseEQ.h
+
+    Linear phase mode. The magnitude response of the current ChainCoefficients
+    is sampled on an FFT grid, turned into a zero phase impulse, centred and
+    windowed into a symmetric FIR. Audio runs through one
+    juce::dsp::Convolution per channel (uniformly partitioned, allocation-free
+    on the audio thread, crossfading whenever a new FIR is loaded).
+
+    Designs happen on the SharedDesignService's pool: the audio thread only
+    raises a flag when a parameter changes, the service thread picks it up
+    and queues this engine's design job. Instances asking for the same FIR
+    share one design, and every engine loads through the service's
+    ConvolutionMessageQueue rather than starting one of its own. The FIR is
+    centred on firLength / 2, and the convolutions run on partitions of
+    firLength / 32 (at least 256) samples, which adds that much again. Both
+    go into the latency reported to the host.
+
+    Each channel gets an FIR of its own, so left/right settings carry over.
+    Mid/side folds into left/right as L' = a L + b R and R' = b L + a R, with
+    a = (mid + side) / 2 and b = (mid - side) / 2. The b terms run through a
+    second pair of convolutions, fed only while a mid/side design needs them.
+
+    Quality      FIR taps at 48 kHz   latency at 48 kHz   lowest usable cut
+    low                 4096               48 ms               ~60 Hz
+    standard           16384              181 ms               ~20 Hz
+    high               65536              725 ms               below 20 Hz
+
+    Tap counts double with each doubling of the sample rate, so the frequency
+    resolution and latency in ms stay the same.
+
+  ==============================================================================
+*/
+
+#pragma once
+
+#include <JuceHeader.h>
+#include "CoefficientDesign.h"
+#include "SharedDesignService.h"
+
+class LinearPhaseEQ : private SharedDesignService::Client {
+public:
+    enum class Quality {
+        low,
+        standard,
+        high
+    };
+
+    static int getFirLength(Quality quality, double sampleRate);
+
+    //The first and second channel's chains, acting on mid and side rather than left and right with midSide
+    struct ChannelCoefficients {
+        ChainCoefficients first, second;
+        bool midSide {false};
+    };
+
+    //Called on a pool thread for the coefficients to turn into FIRs
+    using CoefficientSource = std::function<ChannelCoefficients(double sampleRate)>;
+
+    explicit LinearPhaseEQ(CoefficientSource source);
+    ~LinearPhaseEQ() override;
+
+    //Not realtime safe. Designs the first FIR on this thread and hands it to the convolutions, then registers with
+    //the service. Until it has swapped in the output is silent, which is what the latency puts there anyway.
+    void prepare(double sampleRate, int maximumBlockSize, int numChannels, Quality quality);
+
+    //Not realtime safe. Waits for a design in flight and frees the convolution engines.
+    void release();
+
+    int getFirLength() const { return firLength; }
+    int getLatencySamples() const { return firLength / 2 + partitionLatency; }
+
+    //Audio thread. The service picks this up within a few ms and crossfades the new FIR in.
+    void requestRedesign() { redesignPending.store(true, std::memory_order_release); }
+
+    void process(juce::dsp::AudioBlock<float>& block);
+
+    //The convolution engines are float only, double blocks go through a scratch buffer sized in prepare()
+    void process(juce::dsp::AudioBlock<double>& block);
+
+    //Fills fir (one channel, power of two length) with the symmetric FIR matching chainCoefficients' magnitude
+    static void designFIR(const ChainCoefficients& chainCoefficients, juce::AudioBuffer<float>& fir);
+
+private:
+    //One design at a time per engine, so an older FIR can never land after a newer one
+    struct DesignJob : juce::ThreadPoolJob {
+        explicit DesignJob(LinearPhaseEQ& ownerToUse) : juce::ThreadPoolJob("SimpleEQ linear phase design"), owner(ownerToUse) {}
+
+        JobStatus runJob() override {
+            owner.loadFIR();
+            return jobHasFinished;
+        }
+
+        LinearPhaseEQ& owner;
+    };
+
+    CoefficientSource coefficientSource;
+
+    //Declared before the convolutions, which load through its message queue
+    juce::SharedResourcePointer<SharedDesignService> service;
+    std::vector<std::unique_ptr<juce::dsp::Convolution>> convolutions;
+    juce::AudioBuffer<float> scratch;
+
+    //The b terms, one per channel of a stereo bus, each fed the other channel's input
+    std::vector<std::unique_ptr<juce::dsp::Convolution>> crossConvolutions;
+    juce::AudioBuffer<float> crossScratch;
+
+    //Set by the design that's loading. The audio thread keeps feeding the cross terms for crossHoldSamples after a
+    //design without them, until the zero FIRs that replace them have been swapped and crossfaded in.
+    std::atomic<bool> crossNeeded {false};
+    bool crossRunning {false};
+    int crossHoldSamples {0}, crossHoldRemaining {0};
+
+    double sampleRate {44100.0};
+    int firLength {0}, partitionLatency {0};
+
+    //Audio thread. Counts down Convolution's crossfade from the passthrough it starts with once the first FIR is in.
+    int startupRemaining {0};
+
+    std::atomic<bool> redesignPending {false};
+
+    //Service thread only
+    bool designQueued {false};
+    DesignJob designJob {*this};
+
+    void serviceTick(double nowMs) override;
+    void loadFIR();
+    bool updateCrossRunning(int numSamples);
+    bool isFirstFIRLoaded() const;
+};
@@ -9,52 +9,81 @@
 #include "PluginProcessor.h"
 #include "PluginEditor.h"
 
-void L_n_F::drawRotarySlider(juce::Graphics& g, int x, int y, int width, int height, float sliderPosProportional, float rotaryStartAngle, float rotaryEndAngle, juce::Slider& s) {
+//The parts of a knob that don't move, drawn straight or into the slider's cached face
+static void drawKnobFace(juce::Graphics& g, juce::Rectangle<float> bounds) {
     using namespace juce;
     
-    auto bounds = Rectangle<float>(x, y, width, height);
-    
     g.setColour(Colour::fromRGB(224, 221, 213));
     g.fillEllipse(bounds);
     g.setColour(Colour::fromRGB(255, 254, 252));
     g.drawEllipse(bounds, 2.f);
+}
+
+//The pointer and the value, the parts a value change moves
+static void drawKnobPointer(juce::Graphics& g, juce::Rectangle<float> bounds, float angle, int textHeight, const juce::String& text, float textWidth) {
+    using namespace juce;
+    
+    auto centre = bounds.getCentre();
+    
+    Path p;
+    Rectangle<float> r;
+    r.setLeft(centre.getX()-2);
+    r.setRight(centre.getX()+2);
+    r.setTop(bounds.getY());
+    r.setBottom(centre.getY() - textHeight * 1.5);
+    p.addRoundedRectangle(r, 2.f);
+    
+    p.applyTransform(AffineTransform().rotated(angle, centre.getX(), centre.getY()));
+    g.setColour(Colour::fromRGB(255, 254, 252));
+    g.fillPath(p);
+    
+    g.setFont(textHeight);
+    r.setSize(textWidth + 4, textHeight +2);
+    r.setCentre(bounds.getCentre());
+    g.setColour(Colours::black);
+    g.fillRect(r);
+    g.setColour(Colours::white);
+    g.drawFittedText(text, r.toNearestInt(), Justification::centred, 1);
+}
+
+static float getRotaryStartAngle() { return juce::degreesToRadians(180.f + 45.f); }
+static float getRotaryEndAngle() { return juce::degreesToRadians(180.f - 45.f) + juce::MathConstants<float>::twoPi; }
+
+void L_n_F::drawRotarySlider(juce::Graphics& g, int x, int y, int width, int height, float sliderPosProportional, float rotaryStartAngle, float rotaryEndAngle, juce::Slider& s) {
+    using namespace juce;
+    
+    auto bounds = Rectangle<float>(x, y, width, height);
+    drawKnobFace(g, bounds);
     
     if (auto* rswl = dynamic_cast<RotarySliderWithLabels*>(&s)) {
-        auto centre = bounds.getCentre();
-        
-        Path p;
-        Rectangle<float> r;
-        r.setLeft(centre.getX()-2);
-        r.setRight(centre.getX()+2);
-        r.setTop(bounds.getY());
-        r.setBottom(centre.getY() - rswl->getTextHeight() * 1.5);
-        p.addRoundedRectangle(r, 2.f);
-        
         jassert(rotaryStartAngle < rotaryEndAngle);
         
         auto sliderAngRad = jmap(sliderPosProportional, 0.f, 1.f, rotaryStartAngle, rotaryEndAngle);
         
-        p.applyTransform(AffineTransform().rotated(sliderAngRad, centre.getX(), centre.getY()));
-        g.fillPath(p);
-        
         g.setFont(rswl->getTextHeight());
         auto text = rswl->getDisplayString();
         auto strWidth = g.getCurrentFont().getStringWidth(text);
-        r.setSize(strWidth + 4, rswl->getTextHeight() +2);
-        r.setCentre(bounds.getCentre());
-        g.setColour(Colours::black);
-        g.fillRect(r);
-        g.setColour(Colours::white);
-        g.drawFittedText(text, r.toNearestInt(), Justification::centred, 1);
-        
+        drawKnobPointer(g, bounds, sliderAngRad, rswl->getTextHeight(), text, (float) strWidth);
+    }
+}
+
+RotarySliderWithLabels::RotarySliderWithLabels(juce::RangedAudioParameter& rap, const juce::String& unitSuffix)
+    : juce::Slider(juce::Slider::SliderStyle::RotaryHorizontalVerticalDrag, juce::Slider::TextEntryBoxPosition::NoTextBox), param(&rap), suffix(unitSuffix) {
+    if (auto* choiceParam = dynamic_cast<juce::AudioParameterChoice*>(param)) {
+        choiceNames = choiceParam->choices;
     }
+    
+    //getDisplayString() takes everything that isn't a choice as an AudioParameterFloat
+    jassert(! choiceNames.isEmpty() || dynamic_cast<juce::AudioParameterFloat*>(param) != nullptr);
 }
 
 void RotarySliderWithLabels::paint(juce::Graphics& g) {
     using namespace juce;
     
-    auto startAng = degreesToRadians(180.f + 45.f);
-    auto endAng = degreesToRadians(180.f - 45.f) + MathConstants<float>::twoPi;
+    ScopedPaintTimer paintTimer(paintStats);
+    
+    auto startAng = getRotaryStartAngle();
+    auto endAng = getRotaryEndAngle();
     auto range = getRange();
     auto sliderBounds = getSliderBounds();
     float sliderPosPropVar = jmap(getValue(), range.getStart(), range.getEnd(), 0.0, 1.0);
@@ -64,8 +93,61 @@ void RotarySliderWithLabels::paint(juce::Graphics& g) {
     //g.setColour(Colours::yellow);
     //g.drawRect(getSliderBounds());
     
-    getLookAndFeel().drawRotarySlider(g, sliderBounds.getX(), sliderBounds.getY(), sliderBounds.getWidth(), sliderBounds.getHeight(), sliderPosPropVar, startAng, endAng, *this);
+    if (! cachedRendering) {
+        getLookAndFeel().drawRotarySlider(g, sliderBounds.getX(), sliderBounds.getY(), sliderBounds.getWidth(), sliderBounds.getHeight(), sliderPosPropVar, startAng, endAng, *this);
+        drawLabels(g, sliderBounds);
+        return;
+    }
+    
+    //Moving to a display with another scale redraws the face at that scale rather than stretching it
+    auto scale = g.getInternalContext().getPhysicalPixelScaleFactor();
+    if (! face.isValid() || scale != faceScale) {
+        renderFace(scale);
+    }
+    g.drawImage(face, getLocalBounds().toFloat());
+    
+    if (! displayTextValid) {
+        displayText = getDisplayString();
+        displayTextWidth = (float) Font((float) getTextHeight()).getStringWidth(displayText);
+        displayTextValid = true;
+    }
+    
+    drawKnobPointer(g, sliderBounds.toFloat(), jmap(sliderPosPropVar, 0.f, 1.f, startAng, endAng), getTextHeight(), displayText, displayTextWidth);
+}
+
+void RotarySliderWithLabels::resized() {
+    juce::Slider::resized();
+    invalidateCache();
+}
+
+void RotarySliderWithLabels::valueChanged() {
+    displayTextValid = false;
+}
+
+void RotarySliderWithLabels::setCachedRendering(bool shouldCache) {
+    cachedRendering = shouldCache;
+    invalidateCache();
+    repaint();
+}
+
+void RotarySliderWithLabels::renderFace(float scale) {
+    face = juce::Image(juce::Image::ARGB, juce::jmax(1, juce::roundToInt(getWidth() * scale)), juce::jmax(1, juce::roundToInt(getHeight() * scale)), true);
+    faceScale = scale;
+    
+    juce::Graphics g(face);
+    g.addTransform(juce::AffineTransform::scale(scale));
+    
+    auto sliderBounds = getSliderBounds();
+    drawKnobFace(g, sliderBounds.toFloat());
+    drawLabels(g, sliderBounds);
+}
+
+//The range labels around the knob
+void RotarySliderWithLabels::drawLabels(juce::Graphics& g, juce::Rectangle<int> sliderBounds) const {
+    using namespace juce;
     
+    auto startAng = getRotaryStartAngle();
+    auto endAng = getRotaryEndAngle();
     auto centre = sliderBounds.toFloat().getCentre();
     auto radius = sliderBounds.getWidth();
     
@@ -109,20 +191,12 @@ juce::Rectangle<int> RotarySliderWithLabels::getSliderBounds() const {
 
 juce::String RotarySliderWithLabels::getDisplayString() const{
     using namespace juce;
-    if (auto* choiceParam = dynamic_cast<AudioParameterChoice*>(param)) {
-        return choiceParam->getCurrentChoiceName();
+    if (! choiceNames.isEmpty()) {
+        return choiceNames[jlimit(0, choiceNames.size() - 1, roundToInt(getValue()))];
     }
     
-    String str;
-    
-    if (auto* floatParam = dynamic_cast<AudioParameterFloat*>(param)) {
-        float val = getValue();
-        
-        str = String(val, 0);
-        
-    } else {
-        jassertfalse; //This should not happen
-    }
+    float val = getValue();
+    String str(val, 0);
     
     if (suffix.isNotEmpty()) {
         str << " ";
@@ -135,11 +209,254 @@ juce::String RotarySliderWithLabels::getDisplayString() const{
     return str;
 }
 
+//The main parameters' curve, then the "_2" set's
+static const std::array<juce::Colour, 2> curveColours { juce::Colour::fromRGB(255, 254, 252), juce::Colour::fromRGB(240, 170, 90) };
+
+ResponseCurveComponent::ResponseCurveComponent(SimpleEQAudioProcessor& p) : audioProcessor(p) {
+    audioProcessor.getSpectrumAnalyzer().setActive(true);
+    
+    //paint() fills every pixel, so nothing behind it needs repainting with it
+    setOpaque(true);
+    
+    //Only polls a few atomics until a band or the spectrum actually changes
+    startTimerHz(60);
+}
+
+ResponseCurveComponent::~ResponseCurveComponent() {
+    audioProcessor.getSpectrumAnalyzer().setActive(false);
+}
+
+void ResponseCurveComponent::resized() {
+    tableValid = false;
+    timerCallback();
+}
+
+void ResponseCurveComponent::rebuildTable(double sampleRate) {
+    auto numColumns = (size_t) juce::jmax(1, getWidth());
+    
+    columnPhi.resize(numColumns);
+    scratch.resize(numColumns);
+    for (auto& curve : curves) {
+        for (auto& magnitudes : curve.bandMagnitudesDB) {
+            magnitudes.assign(numColumns, 0.0);
+        }
+    }
+    
+    for (size_t i = 0; i < numColumns; ++i) {
+        auto freq = juce::mapToLog10((double) i / (double) numColumns, 20.0, 20000.0);
+        auto halfW = juce::MathConstants<double>::pi * juce::jmin(freq, sampleRate * 0.5) / sampleRate;
+        columnPhi[i] = std::sin(halfW) * std::sin(halfW);
+    }
+    
+    tableSampleRate = sampleRate;
+    tableValid = true;
+}
+
+void ResponseCurveComponent::updateBand(Curve& curve, int band, const ChainSettings& chainSettings) {
+    auto& magnitudes = curve.bandMagnitudesDB[(size_t) band];
+    auto numColumns = columnPhi.size();
+    
+    std::fill(scratch.begin(), scratch.end(), 1.0);
+    
+    auto accumulateCut = [&](const CutCoefficients& cut) {
+        for (int i = 0; i < cut.numStages; ++i) {
+            accumulateMagnitudeSquared(cut.stages[(size_t) i], columnPhi.data(), scratch.data(), numColumns);
+        }
+    };
+    
+    switch (band) {
+        case ChainPositions::LowCut:
+            if (! chainSettings.lcBypassed) {
+                accumulateCut(makeLowCutCoefficients(tableSampleRate, chainSettings.lcFreq, chainSettings.lcSlope + 1));
+            }
+            break;
+        case ChainPositions::Peak:
+            if (! chainSettings.pdBypassed) {
+                accumulateMagnitudeSquared(makePeakCoefficients(tableSampleRate, chainSettings.peakFreq, chainSettings.peakQ, chainSettings.peakDB_gain),
+                                           columnPhi.data(), scratch.data(), numColumns);
+            }
+            break;
+        case ChainPositions::HighCut:
+            if (! chainSettings.hcBypassed) {
+                accumulateCut(makeHighCutCoefficients(tableSampleRate, chainSettings.hcFreq, chainSettings.hcSlope + 1));
+            }
+            break;
+        case ChainPositions::Bank: {
+            auto bank = makeBankCoefficients(chainSettings, tableSampleRate);
+            for (size_t i = 0; i < (size_t) maxBankBands; ++i) {
+                if (bank.active[i]) {
+                    accumulateMagnitudeSquared(bank.bands[i], columnPhi.data(), scratch.data(), numColumns);
+                }
+            }
+            break;
+        }
+    }
+    
+    //|H|^2 to dB, one log per column however many stages the band has
+    for (size_t i = 0; i < numColumns; ++i) {
+        magnitudes[i] = 10.0 * std::log10(juce::jmax(scratch[i], 1.0e-30));
+    }
+}
+
+void ResponseCurveComponent::rebuildCurve(Curve& curve) {
+    using namespace juce;
+    
+    auto bounds = getLocalBounds().toFloat();
+    auto numColumns = columnPhi.size();
+    auto& bandMagnitudesDB = curve.bandMagnitudesDB;
+    
+    //The bands multiply, so their dB tables add
+    std::copy(bandMagnitudesDB[0].begin(), bandMagnitudesDB[0].end(), scratch.begin());
+    for (size_t band = 1; band < (size_t) numBands; ++band) {
+        for (size_t i = 0; i < numColumns; ++i) {
+            scratch[i] += bandMagnitudesDB[band][i];
+        }
+    }
+    
+    auto mapToY = [&bounds](double magnitudeDB) {
+        return (float) jmap(jlimit(-30.0, 30.0, magnitudeDB), -24.0, 24.0, (double) bounds.getBottom(), (double) bounds.getY());
+    };
+    
+    auto& path = curve.path;
+    path.clear();
+    path.preallocateSpace((int) numColumns * 3);
+    path.startNewSubPath(bounds.getX(), mapToY(scratch[0]));
+    
+    for (size_t i = 1; i < numColumns; ++i) {
+        path.lineTo(bounds.getX() + (float) i, mapToY(scratch[i]));
+    }
+}
+
+//Whether any band's gain moves with the level, which the curve doesn't show
+static bool hasDynamicBands(const ChainSettings& chainSettings) {
+    if (chainSettings.pdDynamic && ! chainSettings.pdBypassed) {
+        return true;
+    }
+    
+    return std::any_of(chainSettings.bands.begin(), chainSettings.bands.end(), [](const BandSettings& band) { return band.isDynamic(); });
+}
+
+void ResponseCurveComponent::timerCallback() {
+    if (getWidth() <= 0) {
+        return;
+    }
+    
+    //What the filters actually run at, so the curve shows the cramping oversampling removes
+    auto sampleRate = audioProcessor.getProcessingSampleRate();
+    
+    auto redrawAll = ! tableValid || sampleRate != tableSampleRate || columnPhi.size() != (size_t) getWidth();
+    if (redrawAll) {
+        rebuildTable(sampleRate);
+    }
+    
+    bool anyChanged = false;
+    std::array<ChainSettings, 2> chainSettings;
+    
+    for (int band = 0; band < numBands; ++band) {
+        auto generation = audioProcessor.getBandGeneration(band);
+        if (! redrawAll && generation == drawnGenerations[(size_t) band]) {
+            continue;
+        }
+        
+        //A new stereo mode or bus layout moves every band, so the second curve is complete whenever it's drawn
+        if (! anyChanged) {
+            chainSettings[0] = getChainSettings(audioProcessor.apvts);
+            drawnStereoMode = audioProcessor.getEffectiveStereoMode(chainSettings[0]);
+            if (getNumCurves() > 1) {
+                chainSettings[1] = getSecondChainSettings(audioProcessor.apvts, chainSettings[0]);
+            }
+            anyDynamic = hasDynamicBands(chainSettings[0]) || (getNumCurves() > 1 && hasDynamicBands(chainSettings[1]));
+            anyChanged = true;
+        }
+        
+        for (int i = 0; i < getNumCurves(); ++i) {
+            updateBand(curves[(size_t) i], band, chainSettings[(size_t) i]);
+        }
+        drawnGenerations[(size_t) band] = generation;
+    }
+    
+    if (anyChanged) {
+        for (int i = 0; i < getNumCurves(); ++i) {
+            rebuildCurve(curves[(size_t) i]);
+        }
+    }
+    
+    auto& analyzer = audioProcessor.getSpectrumAnalyzer();
+    auto analyzerFrame = analyzer.getFrameCount();
+    auto spectrumChanged = analyzerFrame != drawnAnalyzerFrame;
+    
+    if (spectrumChanged) {
+        preSpectrum = analyzer.getPath(SpectrumAnalyzer::pre);
+        postSpectrum = analyzer.getPath(SpectrumAnalyzer::post);
+        drawnAnalyzerFrame = analyzerFrame;
+    }
+    
+    if (anyChanged || spectrumChanged) {
+        repaint();
+    }
+}
+
+void ResponseCurveComponent::paint(juce::Graphics& g) {
+    using namespace juce;
+    
+    ScopedPaintTimer paintTimer(paintStats);
+    
+    g.fillAll(Colour::fromRGB(30, 30, 30));
+    
+    //0 dB line
+    g.setColour(Colour::fromRGB(70, 70, 70));
+    g.drawHorizontalLine(getHeight() / 2, 0.f, (float) getWidth());
+    
+    auto spectrumTransform = AffineTransform::scale((float) getWidth(), (float) getHeight());
+    
+    g.setColour(Colour::fromRGB(90, 120, 160).withAlpha(0.5f));
+    g.strokePath(preSpectrum, PathStrokeType(1.f), spectrumTransform);
+    g.setColour(Colour::fromRGB(120, 200, 230).withAlpha(0.8f));
+    g.strokePath(postSpectrum, PathStrokeType(1.f), spectrumTransform);
+    
+    for (int i = getNumCurves(); --i >= 0;) {
+        g.setColour(curveColours[(size_t) i]);
+        g.strokePath(curves[(size_t) i].path, PathStrokeType(2.f));
+    }
+    
+    drawLabels(g);
+    
+    g.setColour(Colour::fromRGB(224, 221, 213));
+    g.drawRect(getLocalBounds(), 1);
+}
+
+void ResponseCurveComponent::drawLabels(juce::Graphics& g) const {
+    using namespace juce;
+    
+    StringArray labels;
+    switch (drawnStereoMode) {
+        case StereoMode::linked:    break;
+        case StereoMode::leftRight: labels.add("Left");     labels.add("Right"); break;
+        case StereoMode::midSide:   labels.add("Mid");      labels.add("Side"); break;
+        case StereoMode::midOnly:   labels.add("Mid only"); break;
+        case StereoMode::sideOnly:  labels.add("Side only"); break;
+    }
+    
+    g.setFont(12.f);
+    auto area = getLocalBounds().reduced(6, 4).removeFromTop(16);
+    
+    for (int i = 0; i < labels.size(); ++i) {
+        g.setColour(curveColours[(size_t) i]);
+        g.drawText(labels[i], area.removeFromLeft(70), Justification::centredLeft, false);
+    }
+    
+    if (anyDynamic) {
+        g.setColour(Colour::fromRGB(160, 160, 160));
+        g.drawText("Dynamic bands at rest", area, Justification::centredLeft, false);
+    }
+}
+
 //==============================================================================
 SimpleEQAudioProcessorEditor::SimpleEQAudioProcessorEditor (SimpleEQAudioProcessor& p)
-    : AudioProcessorEditor (&p), audioProcessor (p), peakFreqSlider(*audioProcessor.apvts.getParameter("PD_freq"), "Hz"), peakQSlider(*audioProcessor.apvts.getParameter("PD_q"), ""), peakGainSlider(*audioProcessor.apvts.getParameter("PD_gain"), "dB"), lcFreqSlider(*audioProcessor.apvts.getParameter("LC_freq"), "Hz"), lcSlopeSlider(*audioProcessor.apvts.getParameter("LC_slope"), "dB/Oct"), hcFreqSlider(*audioProcessor.apvts.getParameter("HC_freq"), "Hz"), hcSlopeSlider(*audioProcessor.apvts.getParameter("HC_slope"), "dB/Oct"), peakFreqSliderAttachment(audioProcessor.apvts, "PD_freq", peakFreqSlider), peakQSliderAttachment(audioProcessor.apvts, "PD_q", peakQSlider), peakGainSliderAttachment(audioProcessor.apvts, "PD_gain", peakGainSlider), lcFreqSliderAttachment(audioProcessor.apvts, "LC_freq", lcFreqSlider), lcSlopeSliderAttachment(audioProcessor.apvts, "LC_slope", lcSlopeSlider), hcFreqSliderAttachment(audioProcessor.apvts, "HC_freq", hcFreqSlider), hcSlopeSliderAttachment(audioProcessor.apvts, "HC_slope", hcSlopeSlider), lcBypassButtonAtt(audioProcessor.apvts, "LC_bp", lcBypassButton),
+    : AudioProcessorEditor (&p), audioProcessor (p), peakFreqSlider(*audioProcessor.apvts.getParameter("PD_freq"), "Hz"), peakQSlider(*audioProcessor.apvts.getParameter("PD_q"), ""), peakGainSlider(*audioProcessor.apvts.getParameter("PD_gain"), "dB"), lcFreqSlider(*audioProcessor.apvts.getParameter("LC_freq"), "Hz"), lcSlopeSlider(*audioProcessor.apvts.getParameter("LC_slope8"), "dB/Oct"), hcFreqSlider(*audioProcessor.apvts.getParameter("HC_freq"), "Hz"), hcSlopeSlider(*audioProcessor.apvts.getParameter("HC_slope8"), "dB/Oct"), peakFreqSliderAttachment(audioProcessor.apvts, "PD_freq", peakFreqSlider), peakQSliderAttachment(audioProcessor.apvts, "PD_q", peakQSlider), peakGainSliderAttachment(audioProcessor.apvts, "PD_gain", peakGainSlider), lcFreqSliderAttachment(audioProcessor.apvts, "LC_freq", lcFreqSlider), lcSlopeSliderAttachment(audioProcessor.apvts, "LC_slope8", lcSlopeSlider), hcFreqSliderAttachment(audioProcessor.apvts, "HC_freq", hcFreqSlider), hcSlopeSliderAttachment(audioProcessor.apvts, "HC_slope8", hcSlopeSlider), lcBypassButtonAtt(audioProcessor.apvts, "LC_bp", lcBypassButton),
         pdBypassButtonAtt(audioProcessor.apvts, "PD_bp", pdBypassButton),
-        hcBypassButtonAtt(audioProcessor.apvts, "HC_bp", hcBypassButton)
+        hcBypassButtonAtt(audioProcessor.apvts, "HC_bp", hcBypassButton),
+        responseCurveComponent(audioProcessor)
 {
     // Make sure that before the constructor has finished, you've set the
     // editor's size to whatever you need it to be.
@@ -152,22 +469,46 @@ SimpleEQAudioProcessorEditor::SimpleEQAudioProcessorEditor (SimpleEQAudioProcess
     peakGainSlider.labels.add({1.f, "+24dB"});
     lcFreqSlider.labels.add({0.f, "20Hz"});
     lcFreqSlider.labels.add({1.f, "20kHz"});
-    lcSlopeSlider.labels.add({0.f, "48dB/Oct"});
-    lcSlopeSlider.labels.add({1.f, "12dB/Oct"});
+    lcSlopeSlider.labels.add({0.f, "12dB/Oct"});
+    lcSlopeSlider.labels.add({1.f, "96dB/Oct"});
     hcFreqSlider.labels.add({0.f, "20Hz"});
     hcFreqSlider.labels.add({1.f, "20kHz"});
-    hcSlopeSlider.labels.add({0.f, "48dB/Oct"});
-    hcSlopeSlider.labels.add({1.f, "12dB/Oct"});
+    hcSlopeSlider.labels.add({0.f, "12dB/Oct"});
+    hcSlopeSlider.labels.add({1.f, "96dB/Oct"});
+    
+    //Children pick up the editor's LookAndFeel, so one instance serves every slider
+    setLookAndFeel(&lnf);
+    setOpaque(true);
     
     for (auto* comp : getComps()) {
         addAndMakeVisible(comp);
     }
     
+    for (auto* slider : getSliders()) {
+        slider->paintStats = &paintStats;
+    }
+    responseCurveComponent.paintStats = &paintStats;
+    
+    callbackStatsLabel.setJustificationType(juce::Justification::centredRight);
+    callbackStatsLabel.setColour(juce::Label::textColourId, juce::Colour::fromRGB(160, 160, 160));
+    addAndMakeVisible(callbackStatsLabel);
+    
+    cachedKnobsButton.setToggleState(true, juce::dontSendNotification);
+    cachedKnobsButton.onClick = [this] {
+        for (auto* slider : getSliders()) {
+            slider->setCachedRendering(cachedKnobsButton.getToggleState());
+        }
+    };
+    addAndMakeVisible(cachedKnobsButton);
+    
+    startTimerHz(4);
+    
     setSize (1280, 720);
 }
 
 SimpleEQAudioProcessorEditor::~SimpleEQAudioProcessorEditor()
 {
+    setLookAndFeel(nullptr);
 }
 
 //==============================================================================
@@ -175,6 +516,8 @@ void SimpleEQAudioProcessorEditor::paint (juce::Graphics& g)
 {
     using namespace juce;
     
+    ScopedPaintTimer paintTimer(&paintStats);
+    
     g.fillAll (Colour::fromRGB(38, 38, 38));
     
 }
@@ -186,6 +529,10 @@ void SimpleEQAudioProcessorEditor::resized()
     
     auto bounds = getLocalBounds();
     auto responseArea = bounds.removeFromTop(bounds.getHeight()*0.66);
+    auto statsArea = responseArea.removeFromTop(20);
+    callbackStatsLabel.setBounds(statsArea.removeFromRight(520));
+    cachedKnobsButton.setBounds(statsArea.removeFromRight(120));
+    responseCurveComponent.setBounds(responseArea.reduced(10, 0));
     
     auto lcArea = bounds.removeFromLeft(bounds.getWidth()*0.33);
     auto hcArea = bounds.removeFromRight(bounds.getWidth()*0.5);
@@ -201,6 +548,29 @@ void SimpleEQAudioProcessorEditor::resized()
     peakGainSlider.setBounds(bounds);
 }
 
+void SimpleEQAudioProcessorEditor::timerCallback() {
+    auto stats = audioProcessor.getCallbackStats();
+    
+    callbackStatsLabel.setText(juce::String::formatted("CPU %.1f%% (peak %.1f%%)  p99 %.1f us  overruns %llu  paint %.1f us x %u",
+                                                       stats.lastLoad * 100.0, stats.peakLoad * 100.0, stats.p99Micros,
+                                                       (unsigned long long) stats.numOverruns,
+                                                       paintStats.getAverageMicros(), (unsigned) paintStats.numPaints),
+                               juce::dontSendNotification);
+    paintStats.reset();
+}
+
+std::vector<RotarySliderWithLabels*> SimpleEQAudioProcessorEditor::getSliders() {
+    return {
+        &peakFreqSlider,
+        &peakGainSlider,
+        &peakQSlider,
+        &lcFreqSlider,
+        &lcSlopeSlider,
+        &hcFreqSlider,
+        &hcSlopeSlider
+    };
+}
+
 std::vector<juce::Component*> SimpleEQAudioProcessorEditor::getComps() {
     return {
         &peakFreqSlider,
@@ -211,6 +581,8 @@ std::vector<juce::Component*> SimpleEQAudioProcessorEditor::getComps() {
         &hcFreqSlider,
         &hcSlopeSlider,
         
+        &responseCurveComponent,
+        
         &lcBypassButton,
         &pdBypassButton,
         &hcBypassButton
@@ -11,46 +11,139 @@
 #include <JuceHeader.h>
 #include "PluginProcessor.h"
 
+//Time spent in paint() across the editor, so the knob caching can be measured. Message thread only.
+struct PaintStats {
+    juce::int64 ticks {0};
+    juce::uint32 numPaints {0};
+    
+    double getAverageMicros() const {
+        return numPaints > 0 ? juce::Time::highResolutionTicksToSeconds(ticks) * 1.0e6 / numPaints : 0.0;
+    }
+    
+    void reset() {
+        ticks = 0;
+        numPaints = 0;
+    }
+};
+
+//Adds the enclosing paint() to stats, if there are any
+struct ScopedPaintTimer {
+    explicit ScopedPaintTimer(PaintStats* statsToUse) : stats(statsToUse), startTicks(stats != nullptr ? juce::Time::getHighResolutionTicks() : 0) {}
+    
+    ~ScopedPaintTimer() {
+        if (stats != nullptr) {
+            stats->ticks += juce::Time::getHighResolutionTicks() - startTicks;
+            ++stats->numPaints;
+        }
+    }
+    
+    PaintStats* stats;
+    juce::int64 startTicks;
+};
+
+//One instance, owned by the editor and inherited by every slider
 struct L_n_F : juce::LookAndFeel_V4 {
     void drawRotarySlider (juce::Graphics& g, int x, int y, int width, int height, float sliderPosProportional, float rotaryStartAngle, float rotaryEndAngle, juce::Slider&) override;
     
 };
 
 struct RotarySliderWithLabels : juce::Slider {
-    //Constructor + Destructor
-    RotarySliderWithLabels(juce::RangedAudioParameter& rap, const juce::String& unitSuffix) : juce::Slider(juce::Slider::SliderStyle::RotaryHorizontalVerticalDrag, juce::Slider::TextEntryBoxPosition::NoTextBox), param(&rap), suffix(unitSuffix) {
-        setLookAndFeel(&lnf);
-    }
-    
-    ~RotarySliderWithLabels() {
-        setLookAndFeel(nullptr);
-    }
+    //Constructor
+    RotarySliderWithLabels(juce::RangedAudioParameter& rap, const juce::String& unitSuffix);
     
     struct LabelPos {
         float position;
         juce::String label;
     };
     
+    //Drawn into the cached face, call invalidateCache() after changing them once the slider is showing
     juce::Array<LabelPos> labels;
     
     //public inits
     void paint(juce::Graphics& g) override;
+    void resized() override;
+    void valueChanged() override;
     juce::Rectangle<int> getSliderBounds() const;
     int getTextHeight() const {return 14;}
     juce::String getDisplayString() const;
     
+    //Cached draws the face and the range labels into an image once per size and display scale, then only the pointer
+    //and the value text over it. Otherwise everything goes through the LookAndFeel on every repaint.
+    void setCachedRendering(bool shouldCache);
+    void invalidateCache() { face = {}; }
+    
+    PaintStats* paintStats {nullptr};
+    
     //private variables
     private:
-    L_n_F lnf;
     juce::RangedAudioParameter* param;
     juce::String suffix;
+    juce::StringArray choiceNames;  //Only for choice parameters, read once here rather than cast for on every repaint
+    
+    bool cachedRendering {true};
+    juce::Image face;
+    float faceScale {0.0f};
+    
+    //Rebuilt when the value changes, not when it's repainted
+    juce::String displayText;
+    float displayTextWidth {0.0f};
+    bool displayTextValid {false};
     
+    void renderFace(float scale);
+    void drawLabels(juce::Graphics& g, juce::Rectangle<int> sliderBounds) const;
+};
+
+//Draws the combined magnitude response, one curve per set of settings the channels run: two for left/right and
+//mid/side, labelled with the channels they cover. Dynamic bands are drawn at their set gain, without the reduction.
+//Each band's contribution is kept per pixel column and only recomputed when the processor reports that band changed.
+struct ResponseCurveComponent : juce::Component, juce::Timer {
+    ResponseCurveComponent(SimpleEQAudioProcessor& p);
+    ~ResponseCurveComponent() override;
+    
+    void paint(juce::Graphics& g) override;
+    void resized() override;
+    void timerCallback() override;
+    
+    PaintStats* paintStats {nullptr};
+    
+    private:
+    SimpleEQAudioProcessor& audioProcessor;
+    
+    //One entry per pixel column, log spaced from 20 Hz to 20 kHz
+    std::vector<double> columnPhi;
+    std::vector<double> scratch;
+    
+    struct Curve {
+        std::array<std::vector<double>, numBands> bandMagnitudesDB;
+        juce::Path path;
+    };
+    
+    //The main parameters' curve, then the "_2" set's while the mode splits the channels
+    std::array<Curve, 2> curves;
+    StereoMode drawnStereoMode {StereoMode::linked};
+    bool anyDynamic {false};
+    
+    std::array<juce::uint32, numBands> drawnGenerations {};
+    double tableSampleRate {0.0};
+    bool tableValid {false};
+    
+    //Analyzer paths are in normalised coordinates, see SpectrumAnalyzer.h
+    juce::Path preSpectrum, postSpectrum;
+    juce::uint32 drawnAnalyzerFrame {0};
+    
+    void rebuildTable(double sampleRate);
+    int getNumCurves() const { return drawnStereoMode == StereoMode::leftRight || drawnStereoMode == StereoMode::midSide ? 2 : 1; }
+    
+    void updateBand(Curve& curve, int band, const ChainSettings& chainSettings);
+    void rebuildCurve(Curve& curve);
+    void drawLabels(juce::Graphics& g) const;
 };
 
 //==============================================================================
 /**
 */
-class SimpleEQAudioProcessorEditor  : public juce::AudioProcessorEditor
+class SimpleEQAudioProcessorEditor  : public juce::AudioProcessorEditor,
+                                      private juce::Timer
 {
 public:
     SimpleEQAudioProcessorEditor (SimpleEQAudioProcessor&);
@@ -65,6 +158,10 @@ private:
     // access the processor object that created it.
     SimpleEQAudioProcessor& audioProcessor;
     
+    //Shared by every slider, declared first so it outlives them
+    L_n_F lnf;
+    PaintStats paintStats;
+    
     RotarySliderWithLabels peakFreqSlider,
     peakQSlider,
     peakGainSlider,
@@ -89,9 +186,15 @@ private:
     using ButtonAttachment = APVTS::ButtonAttachment;
     ButtonAttachment lcBypassButtonAtt, pdBypassButtonAtt, hcBypassButtonAtt;
     
+    ResponseCurveComponent responseCurveComponent;
+    
     std::vector<juce::Component*> getComps();
+    std::vector<RotarySliderWithLabels*> getSliders();
     
-    MonoChain monoChain;
+    //Callback load readout, polled from the processor's CallbackMonitor, and the paint time since the last poll
+    juce::Label callbackStatsLabel;
+    juce::ToggleButton cachedKnobsButton {"Cached knobs"};
+    void timerCallback() override;
 
     JUCE_DECLARE_NON_COPYABLE_WITH_LEAK_DETECTOR (SimpleEQAudioProcessorEditor)
 };
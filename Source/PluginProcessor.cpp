@@ -16,16 +16,37 @@ SimpleEQAudioProcessor::SimpleEQAudioProcessor()
                      #if ! JucePlugin_IsMidiEffect
                       #if ! JucePlugin_IsSynth
                        .withInput  ("Input",  juce::AudioChannelSet::stereo(), true)
+                       .withInput  ("Sidechain", juce::AudioChannelSet::stereo(), false)
                       #endif
                        .withOutput ("Output", juce::AudioChannelSet::stereo(), true)
                      #endif
                        )
 #endif
 {
+    for (auto* param : getParameters()) {
+        if (auto* rap = dynamic_cast<juce::RangedAudioParameter*>(param)) {
+            apvts.addParameterListener(rap->paramID, this);
+            rangedParameters.push_back(rap);
+            treeStateValues.push_back(apvts.getRawParameterValue(rap->paramID));
+            parameterIDs.add(rap->paramID);
+        }
+    }
+    
+    presetBank = PresetBank(parameterIDs);
+    
+    hostNotificationsPending = std::vector<std::atomic<bool>>(rangedParameters.size());
+    startTimerHz(30);
 }
 
 SimpleEQAudioProcessor::~SimpleEQAudioProcessor()
 {
+    stopTimer();
+    
+    for (auto* param : getParameters()) {
+        if (auto* rap = dynamic_cast<juce::RangedAudioParameter*>(param)) {
+            apvts.removeParameterListener(rap->paramID, this);
+        }
+    }
 }
 
 //==============================================================================
@@ -61,33 +82,83 @@ bool SimpleEQAudioProcessor::isMidiEffect() const
    #endif
 }
 
+//Sum of the slowest decays of every active stage, a safe upper bound for the cascade
+static double estimateChainDecaySamples(const ChainCoefficients& chainCoefficients, double decayDB = 60.0) {
+    double samples = 0.0;
+    
+    auto addCut = [&samples, decayDB](const CutCoefficients& cut) {
+        for (int i = 0; i < cut.numStages; ++i) {
+            samples += estimateDecaySamples(cut.stages[(size_t) i], decayDB);
+        }
+    };
+    
+    if (! chainCoefficients.lcBypassed) {
+        addCut(chainCoefficients.lowCut);
+    }
+    if (! chainCoefficients.pdBypassed) {
+        samples += estimateDecaySamples(chainCoefficients.peak, decayDB);
+    }
+    if (! chainCoefficients.hcBypassed) {
+        addCut(chainCoefficients.highCut);
+    }
+    for (int band = 0; band < maxBankBands; ++band) {
+        if (chainCoefficients.bank.active[(size_t) band]) {
+            samples += estimateDecaySamples(chainCoefficients.bank.bands[(size_t) band], decayDB);
+        }
+    }
+    
+    return samples;
+}
+
 double SimpleEQAudioProcessor::getTailLengthSeconds() const
 {
-    return 0.0;
+    auto sampleRate = getSampleRate() > 0.0 ? getSampleRate() : 44100.0;
+    
+    //The whole FIR has to pass after the input stops, the latency is reported separately
+    if (linearPhaseActive) {
+        return linearPhaseEQ.getFirLength() / sampleRate;
+    }
+    
+    auto filterRate = processingSampleRate.load();
+    auto chainSettings = getChainSettings(chainParameters);
+    auto decaySamples = juce::jmax(estimateChainDecaySamples(makeChainCoefficients(chainSettings, filterRate)),
+                                   estimateChainDecaySamples(makeChainCoefficients(getSecondSettingsIfSplit(chainSettings), filterRate)));
+    return decaySamples / filterRate;
 }
 
 int SimpleEQAudioProcessor::getNumPrograms()
 {
-    return 1;   // NB: some hosts don't cope very well if you tell them there are 0 programs,
-                // so this should be at least 1, even if you're not really implementing programs.
+    const juce::ScopedLock lock (presetLock);
+    return juce::jmax(1, presetBank.getNumPresets());   // NB: some hosts don't cope very well if you tell them there are 0 programs,
+                                                        // so this should be at least 1, even if you're not really implementing programs.
 }
 
 int SimpleEQAudioProcessor::getCurrentProgram()
 {
-    return 0;
+    const juce::ScopedLock lock (presetLock);
+    return currentProgram;
 }
 
 void SimpleEQAudioProcessor::setCurrentProgram (int index)
 {
+    const juce::ScopedLock lock (presetLock);
+    
+    if (juce::isPositiveAndBelow(index, presetBank.getNumPresets())) {
+        currentProgram = index;
+        applyParameterValues(presetBank.getPreset(index).values, &presetBankMapping);
+    }
 }
 
 const juce::String SimpleEQAudioProcessor::getProgramName (int index)
 {
-    return {};
+    const juce::ScopedLock lock (presetLock);
+    return juce::isPositiveAndBelow(index, presetBank.getNumPresets()) ? presetBank.getPreset(index).name : juce::String();
 }
 
 void SimpleEQAudioProcessor::changeProgramName (int index, const juce::String& newName)
 {
+    const juce::ScopedLock lock (presetLock);
+    presetBank.renamePreset(index, newName);
 }
 
 //==============================================================================
@@ -96,16 +167,66 @@ void SimpleEQAudioProcessor::prepareToPlay (double sampleRate, int samplesPerBlo
     // Use this method as the place to do any pre-playback
     // initialisation that you need..
     
-    juce::dsp::ProcessSpec spec;
+    linearPhaseActive = phaseMode.load() == PhaseMode::linear;
+    
+    //Everything that designs or runs the IIR chains sees the oversampled rate
+    auto order = linearPhaseActive ? 0 : oversamplingOrder.load();
+    processingSampleRate = sampleRate * (1 << order);
+    
+    //The grid counts host samples from here, so a render started with prepareToPlay lands its changes in the same places
+    sampleAccurateActive = sampleAccurateEnabled.load();
+    automationGrid = juce::jmax(1, sampleAccurateGridSize.load());
+    samplePosition = 0;
+    scheduledChanges.reset();
+    
+    coefficientCache.prepare(processingSampleRate, cacheBudgetBytes.load(), cachePrefill.load());
+    callbackMonitor.prepare(sampleRate);
+    spectrumAnalyzer.prepare(sampleRate);
+    
+    //A grid slice's key is collected across blocks before the detectors run on it
+    dynamicsDetector.prepare(sampleRate, sampleAccurateActive ? juce::jmax(samplesPerBlock, (int) automationGrid) : samplesPerBlock);
     
-    spec.maximumBlockSize = samplesPerBlock;
-    spec.numChannels = 1;
-    spec.sampleRate = sampleRate;
+    auto numChannels = juce::jmax(1, getMainBusNumInputChannels());
+    auto useDouble = isUsingDoublePrecision();
+    numMainChannels = numChannels;
+    markAllBandsDirty();
     
-    leftChain.prepare(spec);
-    rightChain.prepare(spec);
+    auto crossfadeSamples = juce::roundToInt(presetCrossfadeSeconds.load() * sampleRate);
+    floatFilters.prepare(useDouble ? 0 : numChannels, sampleRate, samplesPerBlock, order, crossfadeSamples);
+    doubleFilters.prepare(useDouble ? numChannels : 0, sampleRate, samplesPerBlock, order, crossfadeSamples);
+    
+    auto kernel = sampleAccurateActive ? CascadeKernel::perSample : cutKernel.load();
+    floatFilters.setCascadeKernel(kernel);
+    doubleFilters.setCascadeKernel(kernel);
+    
+    //updateAllFilters below designs from the same parameters a waiting switch was made from
+    auto ready = SwitchState::ready;
+    switchState.compare_exchange_strong(ready, SwitchState::idle);
+    
+    if (linearPhaseActive) {
+        linearPhaseEQ.prepare(sampleRate, samplesPerBlock, numChannels, linearPhaseQuality.load());
+        setLatencySamples(linearPhaseEQ.getLatencySamples());
+    } else {
+        linearPhaseEQ.release();
+        setLatencySamples(useDouble ? doubleFilters.getLive().getLatencySamples() : floatFilters.getLive().getLatencySamples());
+    }
+    
+    auto rampSeconds = smoothingRampSeconds.load();
+    for (auto* smoother : { &lcFreqSmoother, &hcFreqSmoother, &peakFreqSmoother, &peakQSmoother }) {
+        smoother->reset(sampleRate, rampSeconds);
+    }
+    peakGainSmoother.reset(sampleRate, rampSeconds);
+    activeSubBlockSize = (size_t) juce::jmax(1, smoothingSubBlockSize.load());
     
     updateAllFilters();
+    gridTargets = getChainSettings(chainParameters);
+    gridSecondTargets = getSecondSettingsIfSplit(gridTargets);
+    resetSmoothers(gridTargets);
+    
+    silentSamples = 0;
+    wasPassthrough = false;
+    wasIdle = false;
+    refreshFastPaths(true);
 }
 
 void SimpleEQAudioProcessor::releaseResources()
@@ -121,18 +242,21 @@ bool SimpleEQAudioProcessor::isBusesLayoutSupported (const BusesLayout& layouts)
     juce::ignoreUnused (layouts);
     return true;
   #else
-    // This is the place where you check if the layout is supported.
-    // In this template code we only support mono or stereo.
-    // Some plugin hosts, such as certain GarageBand versions, will only
-    // load plugins that support stereo bus layouts.
-    if (layouts.getMainOutputChannelSet() != juce::AudioChannelSet::mono()
-     && layouts.getMainOutputChannelSet() != juce::AudioChannelSet::stereo())
+    // Every channel runs through the same cascade, so any layout from mono
+    // up to maxChannels works, including LCR, 5.1, 7.1 and 7.1.4 beds.
+    auto mainOutput = layouts.getMainOutputChannelSet();
+    
+    if (mainOutput.isDisabled() || mainOutput.size() > maxChannels)
         return false;
 
     // This checks if the input layout matches the output layout
    #if ! JucePlugin_IsSynth
     if (layouts.getMainOutputChannelSet() != layouts.getMainInputChannelSet())
         return false;
+    
+    // The sidechain only keys the dynamic bands, so it can be off or any width
+    if (layouts.inputBuses.size() > 1 && layouts.getChannelSet(true, 1).size() > maxChannels)
+        return false;
    #endif
 
     return true;
@@ -140,10 +264,36 @@ bool SimpleEQAudioProcessor::isBusesLayoutSupported (const BusesLayout& layouts)
 }
 #endif
 
-void SimpleEQAudioProcessor::processBlock (juce::AudioBuffer<float>& buffer, juce::MidiBuffer& midiMessages)
+//Below -120 dBFS on every channel, well under any dither
+template <typename SampleType>
+static bool isSilent(const juce::AudioBuffer<SampleType>& buffer, int numChannels) {
+    for (int ch = 0; ch < numChannels; ++ch) {
+        if (buffer.getMagnitude(ch, 0, buffer.getNumSamples()) > (SampleType) 1.0e-6) {
+            return false;
+        }
+    }
+    
+    return true;
+}
+
+void SimpleEQAudioProcessor::processBlock (juce::AudioBuffer<float>& buffer, juce::MidiBuffer&)
+{
+    processBlockT(buffer, floatFilters);
+}
+
+void SimpleEQAudioProcessor::processBlock (juce::AudioBuffer<double>& buffer, juce::MidiBuffer&)
+{
+    processBlockT(buffer, doubleFilters);
+}
+
+template <typename SampleType>
+void SimpleEQAudioProcessor::processBlockT (juce::AudioBuffer<SampleType>& buffer, CrossfadingFilters<SampleType>& crossfadingFilters)
 {
     juce::ScopedNoDenormals noDenormals;
-    auto totalNumInputChannels  = getTotalNumInputChannels();
+    auto startTicks = callbackMonitor.beginBlock();
+    
+    //The sidechain's channels come after the main bus's, they're only ever read
+    auto totalNumInputChannels  = getMainBusNumInputChannels();
     auto totalNumOutputChannels = getTotalNumOutputChannels();
 
     // In case we have more outputs than inputs, this code clears any output
@@ -162,17 +312,311 @@ void SimpleEQAudioProcessor::processBlock (juce::AudioBuffer<float>& buffer, juc
     // Alternatively, you can process the samples with the channels
     // interleaved by keeping the same state.
     
-    updateAllFilters();
-  
-    juce::dsp::AudioBlock<float> block(buffer);
-    auto leftBlock = block.getSingleChannelBlock(0);
-    auto rightBlock = block.getSingleChannelBlock(1);
+    //Scheduled changes land on the grid inside the block, or all at its start like the wrappers' automation
+    auto sampleAccurate = sampleAccurateActive && ! linearPhaseActive;
+    
+    //A published preset switch becomes a crossfade to the spare filters. Until it's published the parameters are
+    //somewhere between two presets, so the filters hold what they have. Sample accurate automation does both on
+    //the grid instead.
+    auto holding = false;
+    if (! sampleAccurate) {
+        takePendingSwitch();
+        holding = ! linearPhaseActive && isWaitingForSwitch();
+    }
+    
+    auto blockPosition = samplePosition.load(std::memory_order_relaxed);
+    if (! sampleAccurate) {
+        applyScheduledChanges(blockPosition + buffer.getNumSamples() - 1);
+    }
+    
+    auto& filters = crossfadingFilters.getLive();
+    auto vectorised = processingEngine.load() == ProcessingEngine::vectorised;
+    
+    auto numChannels = juce::jmin((size_t) totalNumInputChannels, filters.chains.size());
+    auto block = juce::dsp::AudioBlock<SampleType>(buffer).getSubsetChannelBlock(0, numChannels);
+    
+    //The dynamic bands listen to the sidechain when it's asked for and connected, the unfiltered input otherwise
+    auto key = block;
+    if (useSidechain && getBusCount(true) > 1 && getChannelCountOfBus(true, 1) > 0) {
+        auto firstSidechainChannel = getChannelIndexInProcessBlockBuffer(true, 1, 0);
+        auto numSidechainChannels = juce::jmin(getChannelCountOfBus(true, 1), buffer.getNumChannels() - firstSidechainChannel);
+        key = juce::dsp::AudioBlock<SampleType>(buffer).getSubsetChannelBlock((size_t) firstSidechainChannel, (size_t) numSidechainChannels);
+    }
+    
+    //The only cost while no editor is open
+    auto analysing = spectrumAnalyzer.isActive();
+    if (analysing) {
+        spectrumAnalyzer.push(SpectrumAnalyzer::pre, block);
+    }
+    
+    auto smoothing = smoothingEnabled.load() && ! linearPhaseActive;
+    auto smoothersMoving = lcFreqSmoother.isSmoothing() || hcFreqSmoother.isSmoothing() || peakFreqSmoother.isSmoothing()
+                        || peakQSmoother.isSmoothing() || peakGainSmoother.isSmoothing();
+    
+    refreshFastPaths();
+    
+    auto dynamic = dynamicsDetector.anyActive() && ! linearPhaseActive;
+    auto silent = isSilent(buffer, (int) numChannels);
+    silentSamples = silent ? silentSamples + buffer.getNumSamples() : 0;
+    
+    if (silent && tailStale) {
+        updateTailFlushSamples();
+    }
+    
+    //Every band is bypassed or has no effect, so the input already is the output. Only without latency,
+    //and not while a ramp towards the neutral settings is still running.
+    //Neither fast path runs with sample accurate automation, where they start depends on the block boundaries.
+    //The filters keep running while the output fades to the dry input, and fade back in from rest.
+    crossfadingFilters.setDry(! sampleAccurate && ! holding && chainIsNeutral && getLatencySamples() == 0 && ! (smoothing && smoothersMoving));
+    auto passthrough = crossfadingFilters.isDry();
+    
+    //The silence before this block already covered every filter's ring-out
+    auto sleeping = ! sampleAccurate && ! passthrough && ! holding && silent && silentSamples - buffer.getNumSamples() >= tailFlushSamples;
+    
+    //Sample accurate slices start and end their crossfades themselves
+    if (! sampleAccurate) {
+        crossfadingFilters.beginBlock(block);
+    }
+    
+    if (passthrough || sleeping) {
+        //Keep the designs current, with the smoothers on their targets, so waking up doesn't start from stale coefficients.
+        //A ramp cut short by sleeping left every band it touched on an intermediate design.
+        if (smoothing) {
+            snapSmoothers(smoothersMoving);
+        } else {
+            applyParameterChanges();
+        }
+        
+        //The detectors keep following the key, so their envelopes have decayed with it by the time the filters wake up
+        if (dynamic) {
+            for (size_t start = 0; start < key.getNumSamples(); start += activeSubBlockSize) {
+                dynamicsDetector.process(key.getSubBlock(start, juce::jmin(activeSubBlockSize, key.getNumSamples() - start)));
+            }
+        }
+        callbackMonitor.countBlock(passthrough ? CallbackMonitor::BlockPath::passthrough : CallbackMonitor::BlockPath::sleeping);
+    } else {
+        //Bypassed stages hold whatever state they had, start the chains from rest instead
+        if (wasPassthrough) {
+            filters.reset();
+        }
+        
+        //The idle blocks designed the dynamic bands without the detectors' gains
+        if (wasIdle && dynamic) {
+            markDynamicBandsDirty();
+        }
+        
+        //Smoothing turned off mid-ramp jumps to the targets rather than staying where the ramp got to
+        if (! smoothing && wasSmoothing && smoothersMoving && ! holding && ! sampleAccurate && ! linearPhaseActive) {
+            snapSmoothers(true);
+        }
+        
+        if (holding) {
+            filters.process(block, vectorised);
+        } else if (linearPhaseActive) {
+            applyParameterChanges();
+            linearPhaseEQ.process(block);
+        } else if (sampleAccurate) {
+            if (smoothing && ! wasSmoothing) {
+                resetSmoothers(gridTargets);
+            }
+            processSampleAccurate(block, key, crossfadingFilters, smoothing);
+        } else if (smoothing || dynamic) {
+            if (smoothing && ! wasSmoothing) {
+                resetSmoothers(getChainSettings(chainParameters));
+            }
+            processSmoothed(block, key, filters, smoothing);
+        } else {
+            applyParameterChanges();
+            filters.process(block, vectorised);
+        }
+        
+        wasSmoothing = smoothing;
+        callbackMonitor.countBlock(silent ? CallbackMonitor::BlockPath::silentTail : CallbackMonitor::BlockPath::processed);
+    }
+    
+    wasPassthrough = passthrough;
+    wasIdle = passthrough || sleeping;
+    if (! sampleAccurate) {
+        crossfadingFilters.endBlock(block, vectorised);
+    }
+    
+    if (analysing) {
+        spectrumAnalyzer.push(SpectrumAnalyzer::post, block);
+    }
+    
+    samplePosition.store(blockPosition + buffer.getNumSamples(), std::memory_order_relaxed);
+    callbackMonitor.endBlock(startTicks, buffer.getNumSamples());
+}
+
+void SimpleEQAudioProcessor::resetSmoothers(const ChainSettings& chainSettings) {
+    lcFreqSmoother.setCurrentAndTargetValue(chainSettings.lcFreq);
+    hcFreqSmoother.setCurrentAndTargetValue(chainSettings.hcFreq);
+    peakFreqSmoother.setCurrentAndTargetValue(chainSettings.peakFreq);
+    peakQSmoother.setCurrentAndTargetValue(chainSettings.peakQ);
+    peakGainSmoother.setCurrentAndTargetValue(chainSettings.peakDB_gain);
+}
+
+//Puts the smoothers on the parameters' current values. A ramp that was still running left the bands it moved on an
+//intermediate design, so then every band is redesigned.
+void SimpleEQAudioProcessor::snapSmoothers(bool wereMoving) {
+    resetSmoothers(getChainSettings(chainParameters));
+    
+    if (wereMoving) {
+        updateAllFilters();
+        markDynamicBandsDirty();
+    } else {
+        applyParameterChanges();
+    }
+}
+
+void SimpleEQAudioProcessor::setSmootherTargets(const ChainSettings& targets, bool smoothing) {
+    if (smoothing) {
+        lcFreqSmoother.setTargetValue(targets.lcFreq);
+        hcFreqSmoother.setTargetValue(targets.hcFreq);
+        peakFreqSmoother.setTargetValue(targets.peakFreq);
+        peakQSmoother.setTargetValue(targets.peakQ);
+        peakGainSmoother.setTargetValue(targets.peakDB_gain);
+    } else {
+        resetSmoothers(targets);
+    }
+}
+
+//Splits the block on a fixed grid and redesigns only the bands that are still ramping or that the dynamics moved.
+//Without smoothing the parameters jump straight to their targets and only the dynamics move.
+template <typename SampleType>
+void SimpleEQAudioProcessor::processSmoothed(juce::dsp::AudioBlock<SampleType>& block, const juce::dsp::AudioBlock<SampleType>& key,
+                                             ChannelFilters<SampleType>& filters, bool smoothing) {
+    auto targets = getChainSettings(chainParameters);
+    setSmootherTargets(targets, smoothing);
+    
+    auto dynamic = dynamicsDetector.anyActive();
+    
+    //The right or side channel's own settings land at the start of the block, only the main ones ramp
+    auto secondTargets = getSecondSettingsIfSplit(targets);
+    
+    //Slope and bypass changes, and anything in the band bank, still land at the start of the block
+    auto dirty = consumeDirtyBands();
+    
+    auto subBlockSize = activeSubBlockSize;
+    auto vectorised = processingEngine.load() == ProcessingEngine::vectorised;
+    auto numSamples = block.getNumSamples();
+    
+    for (size_t start = 0; start < numSamples; start += subBlockSize) {
+        auto length = juce::jmin(subBlockSize, numSamples - start);
+        
+        //Detect on the key before this stretch of the block is filtered, so the main input can be its own key
+        if (dynamic) {
+            dynamicsDetector.process(key.getSubBlock(start, length));
+        }
+        
+        designSlice(targets, secondTargets, length, dirty, dynamic);
+        dirty = {};
+        
+        auto subBlock = block.getSubBlock(start, length);
+        filters.process(subBlock, vectorised);
+    }
+}
+
+//Slices run from one grid line to the next. One cut short by the end of the block carries on with the same designs at
+//the start of the next block, so the output doesn't depend on where the host splits the stream. Preset switches start
+//on a grid line too, and while one is being written the line only steps the smoothers and detectors.
+template <typename SampleType>
+void SimpleEQAudioProcessor::processSampleAccurate(juce::dsp::AudioBlock<SampleType>& block, const juce::dsp::AudioBlock<SampleType>& key,
+                                                   CrossfadingFilters<SampleType>& crossfadingFilters, bool smoothing) {
+    auto vectorised = processingEngine.load() == ProcessingEngine::vectorised;
+    auto blockPosition = samplePosition.load(std::memory_order_relaxed);
+    auto numSamples = block.getNumSamples();
+    
+    for (size_t start = 0; start < numSamples;) {
+        auto position = blockPosition + (juce::int64) start;
+        auto intoSlice = position % automationGrid;
+        auto length = (size_t) juce::jmin(automationGrid - intoSlice, (juce::int64) (numSamples - start));
+        
+        if (intoSlice == 0) {
+            if (takePendingSwitch()) {
+                gridTargets = getChainSettings(chainParameters);
+                gridSecondTargets = getSecondSettingsIfSplit(gridTargets);
+            }
+            
+            applyScheduledChanges(position);
+            refreshFastPaths();
+            
+            //Generations are read before the parameters, as in updateAllFilters()
+            auto dirty = isWaitingForSwitch() ? std::array<bool, numBands> {} : consumeDirtyBands();
+            if (std::any_of(dirty.begin(), dirty.end(), [](bool d) { return d; })) {
+                gridTargets = getChainSettings(chainParameters);
+                gridSecondTargets = getSecondSettingsIfSplit(gridTargets);
+                setSmootherTargets(gridTargets, smoothing);
+            }
+            
+            //The detectors run on the whole slice that just ended, however many blocks it was spread over
+            auto dynamic = dynamicsDetector.anyActive();
+            if (dynamic) {
+                dynamicsDetector.processAppended();
+            }
+            
+            designSlice(gridTargets, gridSecondTargets, (size_t) automationGrid, dirty, dynamic);
+        }
+        
+        if (dynamicsDetector.anyActive()) {
+            dynamicsDetector.append(key.getSubBlock(start, length));
+        }
+        
+        auto slice = block.getSubBlock(start, length);
+        crossfadingFilters.beginBlock(slice);
+        crossfadingFilters.getLive().process(slice, vectorised);
+        crossfadingFilters.endBlock(slice, vectorised);
+        start += length;
+    }
+}
+
+void SimpleEQAudioProcessor::designSlice(const ChainSettings& targets, const ChainSettings& secondTargets, size_t length,
+                                         const std::array<bool, numBands>& dirty, bool dynamic) {
+    auto current = targets;
+    
+    auto lcMoving = lcFreqSmoother.isSmoothing();
+    auto hcMoving = hcFreqSmoother.isSmoothing();
+    auto peakMoving = peakFreqSmoother.isSmoothing() || peakQSmoother.isSmoothing() || peakGainSmoother.isSmoothing();
+    
+    current.lcFreq = lcFreqSmoother.skip((int) length);
+    current.hcFreq = hcFreqSmoother.skip((int) length);
+    current.peakFreq = peakFreqSmoother.skip((int) length);
+    current.peakQ = peakQSmoother.skip((int) length);
+    current.peakDB_gain = peakGainSmoother.skip((int) length);
     
-    juce::dsp::ProcessContextReplacing<float> leftContext(leftBlock);
-    juce::dsp::ProcessContextReplacing<float> rightContext(rightBlock);
+    //Both channels' bands follow the one detector
+    auto currentSecond = secondTargets;
+    auto bankMoving = false;
+    if (dynamic) {
+        if (dynamicsDetector.isActive(0)) {
+            current.peakDB_gain += dynamicsDetector.getGainDB(0);
+            currentSecond.peakDB_gain += dynamicsDetector.getGainDB(0);
+            peakMoving = peakMoving || dynamicsDetector.hasGainChanged(0);
+        }
+        
+        for (int band = 0; band < numBankBands; ++band) {
+            if (dynamicsDetector.isActive(band + 1)) {
+                current.bands[(size_t) band].gainDB += dynamicsDetector.getGainDB(band + 1);
+                currentSecond.bands[(size_t) band].gainDB += dynamicsDetector.getGainDB(band + 1);
+                bankMoving = bankMoving || dynamicsDetector.hasGainChanged(band + 1);
+            }
+        }
+    }
     
-    leftChain.process(leftContext);
-    rightChain.process(rightContext);
+    updateChannels(current, currentSecond, [&](const ChainSettings& settings, int channel) {
+        if (lcMoving || dirty[ChainPositions::LowCut]) {
+            updateLCFilters(settings, ! lcMoving, channel);
+        }
+        if (hcMoving || dirty[ChainPositions::HighCut]) {
+            updateHCFilters(settings, ! hcMoving, channel);
+        }
+        if (peakMoving || dirty[ChainPositions::Peak]) {
+            updatePeakFilter(settings, ! peakMoving, channel);
+        }
+        if (bankMoving || dirty[ChainPositions::Bank]) {
+            updateBankFilters(settings, channel);
+        }
+    });
 }
 
 //==============================================================================
@@ -197,86 +641,948 @@ void SimpleEQAudioProcessor::getStateInformation (juce::MemoryBlock& destData)
     // as intermediaries to make it easy to save and load complex data.
 }
 
+//Parameters that were replaced rather than changed in place. The plain values carry over, the slopes kept their indices.
+static juce::String getCurrentParameterID(const juce::String& parameterID) {
+    static const std::array<std::pair<const char*, const char*>, 4> replaced {{
+        { "LC_slope", "LC_slope8" }, { "HC_slope", "HC_slope8" }, { "LC_slope_2", "LC_slope8_2" }, { "HC_slope_2", "HC_slope8_2" }
+    }};
+    
+    for (auto& ids : replaced) {
+        if (parameterID == ids.first) {
+            return ids.second;
+        }
+    }
+    
+    return parameterID;
+}
+
+//A state saved before a parameter was replaced holds it under the old ID
+static void upgradeState(juce::ValueTree& tree) {
+    for (auto child : tree) {
+        auto parameterID = child.getProperty("id").toString();
+        auto currentID = getCurrentParameterID(parameterID);
+        
+        if (currentID != parameterID && ! tree.getChildWithProperty("id", currentID).isValid()) {
+            child.setProperty("id", currentID, nullptr);
+        }
+    }
+}
+
 void SimpleEQAudioProcessor::setStateInformation (const void* data, int sizeInBytes)
 {
     auto tree = juce::ValueTree::readFromData(data, sizeInBytes);
     if (tree.isValid()) {
-        apvts.replaceState(tree);
-        updateAllFilters();
+        upgradeState(tree);
+        
+        //The host may call this from any thread, so it switches like a preset rather than redesigning in place
+        switchParameters([this, &tree] {
+            apvts.replaceState(tree);
+            markAllBandsDirty();
+        });
     }
     // You should use this method to restore your parameters from this memory block,
     // whose contents will have been created by the getStateInformation() call.
 }
 
-ChainSettings getChainSettings(juce::AudioProcessorValueTreeState& apvts) {
+//The band bank's parameters, createParameterLayout and getChainSettings generate every band's from this table
+struct BandParameterDescriptor {
+    enum Kind {
+        choice,
+        toggle,
+        continuous
+    };
+    
+    BandParameter parameter;
+    const char* suffix;
+    const char* name;
+    Kind kind;
+    juce::NormalisableRange<float> range;
+    float (*getDefault)(int band);
+    void (*apply)(BandSettings& settings, float value);
+};
+
+static const char* const bankParameterPrefix = "B";
+
+static const juce::StringArray bandTypeNames { "Peak", "Low Shelf", "High Shelf", "Notch", "Tilt" };
+
+static const std::array<BandParameterDescriptor, numBandParameters> bandParameterDescriptors {{
+    { BandParameter::type, "type", "Type", BandParameterDescriptor::choice, {},
+      [](int) { return 0.0f; },
+      [](BandSettings& settings, float value) { settings.type = static_cast<BandType>(juce::jlimit(0, numBandTypes - 1, juce::roundToInt(value))); } },
+    
+    //Spread log-evenly over the audio band, so switching several on doesn't stack them
+    { BandParameter::freq, "freq", "Frequency", BandParameterDescriptor::continuous, { 20.0f, 20000.0f, 1.0f, 1.0f },
+      [](int band) { return (float) juce::roundToInt(juce::mapToLog10(((float) band + 0.5f) / (float) numBankBands, 20.0f, 20000.0f)); },
+      [](BandSettings& settings, float value) { settings.freq = value; } },
+    
+    { BandParameter::gain, "gain", "Gain", BandParameterDescriptor::continuous, { -24.0f, 24.0f, 0.1f, 1.0f },
+      [](int) { return 0.0f; },
+      [](BandSettings& settings, float value) { settings.gainDB = value; } },
+    
+    { BandParameter::q, "q", "Q", BandParameterDescriptor::continuous, { 0.1f, 24.0f, 0.01f, 1.0f },
+      [](int) { return 1.0f; },
+      [](BandSettings& settings, float value) { settings.q = value; } },
+    
+    { BandParameter::enabled, "on", "Enabled", BandParameterDescriptor::toggle, {},
+      [](int) { return 0.0f; },
+      [](BandSettings& settings, float value) { settings.enabled = value > 0.5f; } },
+    
+    //Shares the peak band's threshold, ratio, times and key
+    { BandParameter::dynamic, "dyn", "Dynamic", BandParameterDescriptor::toggle, {},
+      [](int) { return 0.0f; },
+      [](BandSettings& settings, float value) { settings.dynamic = value > 0.5f; } }
+}};
+
+const juce::String& getBandParameterID(int band, BandParameter parameter) {
+    static const auto ids = [] {
+        std::array<std::array<juce::String, numBandParameters>, numBankBands> table;
+        
+        for (int b = 0; b < numBankBands; ++b) {
+            for (auto& descriptor : bandParameterDescriptors) {
+                table[(size_t) b][(size_t) descriptor.parameter] = juce::String(bankParameterPrefix) + juce::String(b + 1) + "_" + descriptor.suffix;
+            }
+        }
+        
+        return table;
+    }();
+    
+    return ids[(size_t) band][(size_t) parameter];
+}
+
+ChainParameters::ChainParameters(const juce::AudioProcessorValueTreeState& apvts) {
+    auto get = [&apvts](juce::StringRef parameterID) {
+        auto* parameter = apvts.getParameter(parameterID);
+        jassert(parameter != nullptr);
+        return parameter;
+    };
+    
+    auto getCutsAndPeak = [&get](const juce::String& suffix) {
+        CutsAndPeak set;
+        set.lcFreq = get("LC_freq" + suffix);
+        set.hcFreq = get("HC_freq" + suffix);
+        set.peakFreq = get("PD_freq" + suffix);
+        set.peakGain = get("PD_gain" + suffix);
+        set.peakQ = get("PD_q" + suffix);
+        set.lcSlope = get("LC_slope8" + suffix);
+        set.hcSlope = get("HC_slope8" + suffix);
+        set.lcBypassed = get("LC_bp" + suffix);
+        set.pdBypassed = get("PD_bp" + suffix);
+        set.hcBypassed = get("HC_bp" + suffix);
+        return set;
+    };
+    
+    first = getCutsAndPeak("");
+    second = getCutsAndPeak("_2");
+    
+    pdDynamic = get("PD_dyn");
+    useSidechain = get("PD_sc");
+    threshold = get("PD_thresh");
+    ratio = get("PD_ratio");
+    attack = get("PD_attack");
+    release = get("PD_release");
+    stereoMode = get("ST_mode");
+    
+    for (int band = 0; band < numBankBands; ++band) {
+        for (auto& descriptor : bandParameterDescriptors) {
+            bands[(size_t) band][(size_t) descriptor.parameter] = get(getBandParameterID(band, descriptor.parameter));
+        }
+    }
+}
+
+//The parameter's own value. The tree state's copy only follows once the parameter's listeners have been told, which
+//the audio thread leaves to the message thread for scheduled changes.
+static float getPlainValue(const juce::RangedAudioParameter* parameter) {
+    return parameter->convertFrom0to1(parameter->getValue());
+}
+
+static void readCutsAndPeak(const ChainParameters::CutsAndPeak& set, ChainSettings& settings) {
+    settings.lcFreq = getPlainValue(set.lcFreq);
+    settings.hcFreq = getPlainValue(set.hcFreq);
+    settings.peakFreq = getPlainValue(set.peakFreq);
+    settings.peakDB_gain = getPlainValue(set.peakGain);
+    settings.peakQ = getPlainValue(set.peakQ);
+    settings.lcSlope = static_cast<Slope>(getPlainValue(set.lcSlope));
+    settings.hcSlope = static_cast<Slope>(getPlainValue(set.hcSlope));
+    
+    settings.lcBypassed = getPlainValue(set.lcBypassed) > 0.5f;
+    settings.pdBypassed = getPlainValue(set.pdBypassed) > 0.5f;
+    settings.hcBypassed = getPlainValue(set.hcBypassed) > 0.5f;
+}
+
+ChainSettings getChainSettings(const ChainParameters& parameters) {
     ChainSettings settings;
+    readCutsAndPeak(parameters.first, settings);
     
-    settings.lcFreq = apvts.getRawParameterValue("LC_freq")->load();
-    settings.hcFreq = apvts.getRawParameterValue("HC_freq")->load();
-    settings.peakFreq = apvts.getRawParameterValue("PD_freq")->load();
-    settings.peakDB_gain = apvts.getRawParameterValue("PD_gain")->load();
-    settings.peakQ = apvts.getRawParameterValue("PD_q")->load();
-    settings.lcSlope = static_cast<Slope>(apvts.getRawParameterValue("LC_slope")->load());
-    settings.hcSlope = static_cast<Slope>(apvts.getRawParameterValue("HC_slope")->load());
+    settings.pdDynamic = getPlainValue(parameters.pdDynamic) > 0.5f;
+    settings.useSidechain = getPlainValue(parameters.useSidechain) > 0.5f;
+    settings.dynamics.thresholdDB = getPlainValue(parameters.threshold);
+    settings.dynamics.ratio = getPlainValue(parameters.ratio);
+    settings.dynamics.attackMs = getPlainValue(parameters.attack);
+    settings.dynamics.releaseMs = getPlainValue(parameters.release);
     
-    settings.lcBypassed = apvts.getRawParameterValue("LC_bp")->load() > 0.5f;
-    settings.pdBypassed = apvts.getRawParameterValue("PD_bp")->load() > 0.5f;
-    settings.hcBypassed = apvts.getRawParameterValue("HC_bp")->load() > 0.5f;
+    settings.stereoMode = static_cast<StereoMode>(getPlainValue(parameters.stereoMode));
+    
+    for (int band = 0; band < numBankBands; ++band) {
+        for (auto& descriptor : bandParameterDescriptors) {
+            descriptor.apply(settings.bands[(size_t) band], getPlainValue(parameters.bands[(size_t) band][(size_t) descriptor.parameter]));
+        }
+    }
     
     return settings;
 }
 
-//Updating P/D Filter
-void SimpleEQAudioProcessor::updatePeakFilter(const ChainSettings &chainSettings) {
-    auto peakCoefficients = juce::dsp::IIR::Coefficients<float>::makePeakFilter(getSampleRate(), chainSettings.peakFreq, chainSettings.peakQ, juce::Decibels::decibelsToGain(chainSettings.peakDB_gain));
+ChainSettings getSecondChainSettings(const ChainParameters& parameters, const ChainSettings& first) {
+    auto settings = first;
+    readCutsAndPeak(parameters.second, settings);
+    return settings;
+}
+
+ChainSettings getChainSettings(const juce::AudioProcessorValueTreeState& apvts) {
+    return getChainSettings(ChainParameters(apvts));
+}
+
+ChainSettings getSecondChainSettings(const juce::AudioProcessorValueTreeState& apvts, const ChainSettings& first) {
+    return getSecondChainSettings(ChainParameters(apvts), first);
+}
+
+ChainCoefficients makeChainCoefficients(const ChainSettings& chainSettings, double sampleRate) {
+    ChainCoefficients chainCoefficients;
+    
+    chainCoefficients.lowCut = makeLowCutCoefficients(sampleRate, chainSettings.lcFreq, chainSettings.lcSlope + 1);
+    chainCoefficients.peak = makePeakCoefficients(sampleRate, chainSettings.peakFreq, chainSettings.peakQ, chainSettings.peakDB_gain);
+    chainCoefficients.highCut = makeHighCutCoefficients(sampleRate, chainSettings.hcFreq, chainSettings.hcSlope + 1);
+    
+    chainCoefficients.lcBypassed = chainSettings.lcBypassed;
+    chainCoefficients.pdBypassed = chainSettings.pdBypassed;
+    chainCoefficients.hcBypassed = chainSettings.hcBypassed;
+    
+    chainCoefficients.bank = makeBankCoefficients(chainSettings, sampleRate);
+    
+    return chainCoefficients;
+}
+
+BankCoefficients makeBankCoefficients(const ChainSettings& chainSettings, double sampleRate) {
+    BankCoefficients bankCoefficients;
+    
+    for (size_t band = 0; band < (size_t) numBankBands; ++band) {
+        auto& settings = chainSettings.bands[band];
+        
+        //0 dB peaks, shelves and tilts are exactly unity, leaving them out keeps the bank's loop short
+        if (settings.isNeutral()) {
+            continue;
+        }
+        
+        auto freq = juce::jmin((double) settings.freq, sampleRate * 0.5);
+        bankCoefficients.bands[band] = makeBandCoefficients(sampleRate, settings.type, freq, settings.q, settings.gainDB);
+        bankCoefficients.active[band] = true;
+    }
+    
+    return bankCoefficients;
+}
+
+float SimpleEQAudioProcessor::measureEngineDifference(const ChainSettings& chainSettings, double sampleRate, int numSamples) {
+   #if JUCE_USE_SIMD
+    auto chainCoefficients = makeChainCoefficients(chainSettings, sampleRate);
+    
+    juce::dsp::ProcessSpec spec { sampleRate, (juce::uint32) numSamples, 1 };
+    std::array<MonoChain, 2> scalarChains;
+    
+    for (auto& chain : scalarChains) {
+        allocateChainStorage(chain);
+        chain.prepare(spec);
+        applyChainCoefficients(chain, chainCoefficients);
+    }
+    
+    VectorChain<float> vector;
+    vector.prepare(numSamples);
+    vector.setCoefficients(chainCoefficients);
+    
+    juce::AudioBuffer<float> scalarBuffer(2, numSamples);
+    juce::Random random(0x5eed);
+    
+    for (int ch = 0; ch < 2; ++ch) {
+        for (int n = 0; n < numSamples; ++n) {
+            scalarBuffer.setSample(ch, n, random.nextFloat() * 2.0f - 1.0f);
+        }
+    }
+    
+    juce::AudioBuffer<float> vectorBuffer(scalarBuffer);
+    
+    juce::dsp::AudioBlock<float> scalarBlock(scalarBuffer);
+    juce::dsp::AudioBlock<float> vectorBlock(vectorBuffer);
+    
+    for (size_t ch = 0; ch < 2; ++ch) {
+        auto channelBlock = scalarBlock.getSingleChannelBlock(ch);
+        scalarChains[ch].process(juce::dsp::ProcessContextReplacing<float>(channelBlock));
+    }
+    vector.process(vectorBlock);
+    
+    float maxDifference = 0.0f;
+    
+    for (int ch = 0; ch < 2; ++ch) {
+        for (int n = 0; n < numSamples; ++n) {
+            maxDifference = juce::jmax(maxDifference, std::abs(scalarBuffer.getSample(ch, n) - vectorBuffer.getSample(ch, n)));
+        }
+    }
+    
+    return maxDifference;
+   #else
+    juce::ignoreUnused(chainSettings, sampleRate, numSamples);
+    return 0.0f;
+   #endif
+}
+
+static int getBandForParameter(const juce::String& parameterID) {
+    if (parameterID.startsWith(bankParameterPrefix)) {
+        return ChainPositions::Bank;
+    }
+    if (parameterID.startsWith("LC_")) {
+        return ChainPositions::LowCut;
+    }
+    if (parameterID.startsWith("HC_")) {
+        return ChainPositions::HighCut;
+    }
+    return ChainPositions::Peak;
+}
+
+void SimpleEQAudioProcessor::parameterChanged(const juce::String& parameterID, float) {
+    //A new stereo mode changes what every band does to which channel
+    if (parameterID.startsWith("ST_")) {
+        markAllBandsDirty();
+        return;
+    }
+    
+    bandGenerations[(size_t) getBandForParameter(parameterID)].fetch_add(1, std::memory_order_release);
+}
+
+void SimpleEQAudioProcessor::setCoefficientCacheBudget(size_t budgetBytes, CoefficientCache::Prefill prefill) {
+    cacheBudgetBytes = budgetBytes;
+    cachePrefill = prefill;
+}
+
+void SimpleEQAudioProcessor::setOversamplingFactor(int factor) {
+    //Oversampling supports up to 2^3 here, the half-band stages get expensive past that
+    oversamplingOrder = factor >= 8 ? 3 : factor >= 4 ? 2 : factor >= 2 ? 1 : 0;
+}
+
+void SimpleEQAudioProcessor::setPhaseMode(PhaseMode mode, LinearPhaseEQ::Quality quality) {
+    linearPhaseQuality = quality;
+    phaseMode = mode;
+}
+
+void SimpleEQAudioProcessor::setParameterSmoothing(bool enabled, int subBlockSize, double rampSeconds) {
+    smoothingSubBlockSize = juce::jmax(1, subBlockSize);
+    smoothingRampSeconds = juce::jmax(0.0, rampSeconds);
+    smoothingEnabled = enabled;
+}
+
+void SimpleEQAudioProcessor::setSampleAccurateAutomation(bool enabled, int gridSize) {
+    sampleAccurateGridSize = juce::jmax(1, gridSize);
+    sampleAccurateEnabled = enabled;
+}
+
+bool SimpleEQAudioProcessor::scheduleParameterChange(const juce::String& parameterID, float value, juce::int64 position) {
+    auto index = parameterIDs.indexOf(parameterID);
+    if (index < 0 || scheduledChanges.getFreeSpace() == 0) {
+        return false;
+    }
+    
+    int start1, size1, start2, size2;
+    scheduledChanges.prepareToWrite(1, start1, size1, start2, size2);
+    scheduledChangeSlots[(size_t) (size1 > 0 ? start1 : start2)] = { position, index, rangedParameters[(size_t) index]->convertTo0to1(value) };
+    scheduledChanges.finishedWrite(1);
+    return true;
+}
+
+//Applies every change scheduled up to lastPosition the way JUCE's VST3 wrapper applies a host's automation on the
+//audio thread, so the parameter listeners mark the bands dirty as for any other change
+void SimpleEQAudioProcessor::applyScheduledChanges(juce::int64 lastPosition) {
+    while (scheduledChanges.getNumReady() > 0) {
+        int start1, size1, start2, size2;
+        scheduledChanges.prepareToRead(1, start1, size1, start2, size2);
+        
+        auto& change = scheduledChangeSlots[(size_t) (size1 > 0 ? start1 : start2)];
+        if (change.samplePosition > lastPosition) {
+            return;
+        }
+        
+        //The designs read the parameter's own value, the listeners and the host are told on the message thread
+        auto* parameter = rangedParameters[(size_t) change.parameterIndex];
+        parameter->setValue(change.normalisedValue);
+        parameterChanged(parameter->paramID, parameter->convertFrom0to1(change.normalisedValue));
+        hostNotificationsPending[(size_t) change.parameterIndex].store(true, std::memory_order_release);
+        scheduledChanges.finishedRead(1);
+    }
+}
+
+//The tree state's copy of a value only moves when the listeners are told, so it is what they last heard. A parameter
+//that has come back to it since isn't sent again, where the listener call would only redesign the band for nothing.
+void SimpleEQAudioProcessor::timerCallback() {
+    for (size_t i = 0; i < rangedParameters.size(); ++i) {
+        if (! hostNotificationsPending[i].exchange(false, std::memory_order_acquire)) {
+            continue;
+        }
+        
+        auto* parameter = rangedParameters[i];
+        auto value = parameter->getValue();
+        
+        if (parameter->convertFrom0to1(value) != treeStateValues[i]->load(std::memory_order_relaxed)) {
+            parameter->sendValueChangedMessageToListeners(value);
+        }
+    }
+}
+
+void SimpleEQAudioProcessor::markAllBandsDirty() {
+    for (auto& generation : bandGenerations) {
+        generation.fetch_add(1, std::memory_order_release);
+    }
+}
+
+bool SimpleEQAudioProcessor::loadPresetBank(const juce::File& file) {
+    PresetBank loaded;
+    if (! loaded.load(file)) {
+        return false;
+    }
+    
+    //Matched by ID once here, so switching programs never looks a parameter up
+    std::vector<int> mapping;
+    mapping.reserve((size_t) loaded.getParameterIDs().size());
+    for (auto& parameterID : loaded.getParameterIDs()) {
+        mapping.push_back(parameterIDs.indexOf(getCurrentParameterID(parameterID)));
+    }
+    
+    {
+        const juce::ScopedLock lock (presetLock);
+        presetBank = std::move(loaded);
+        presetBankMapping = std::move(mapping);
+        currentProgram = 0;
+    }
+    
+    updateHostDisplay(juce::AudioProcessorListener::ChangeDetails().withProgramChanged(true));
+    return true;
+}
+
+bool SimpleEQAudioProcessor::savePresetBank(const juce::File& file) const {
+    const juce::ScopedLock lock (presetLock);
+    return presetBank.save(file);
+}
+
+void SimpleEQAudioProcessor::addPreset(const juce::String& name) {
+    {
+        const juce::ScopedLock lock (presetLock);
+        
+        //A bank written with another parameter layout is re-keyed to ours first, so the new preset keeps every parameter
+        if (presetBank.getParameterIDs() != parameterIDs) {
+            PresetBank rekeyed(parameterIDs);
+            
+            for (int i = 0; i < presetBank.getNumPresets(); ++i) {
+                auto& preset = presetBank.getPreset(i);
+                
+                std::vector<float> values;
+                for (auto* param : rangedParameters) {
+                    values.push_back(param->convertFrom0to1(param->getDefaultValue()));
+                }
+                for (size_t v = 0; v < preset.values.size() && v < presetBankMapping.size(); ++v) {
+                    if (presetBankMapping[v] >= 0) {
+                        values[(size_t) presetBankMapping[v]] = preset.values[v];
+                    }
+                }
+                
+                rekeyed.addPreset(preset.name, std::move(values));
+            }
+            
+            presetBank = std::move(rekeyed);
+            presetBankMapping.resize(rangedParameters.size());
+            std::iota(presetBankMapping.begin(), presetBankMapping.end(), 0);
+        }
+        
+        presetBank.addPreset(name, captureParameterValues());
+    }
+    
+    updateHostDisplay(juce::AudioProcessorListener::ChangeDetails().withProgramChanged(true));
+}
+
+void SimpleEQAudioProcessor::storeSnapshot(int slot) {
+    jassert(juce::isPositiveAndBelow(slot, numSnapshots));
+    const juce::ScopedLock lock (presetLock);
+    
+    if (juce::isPositiveAndBelow(slot, numSnapshots)) {
+        snapshots[(size_t) slot] = captureParameterValues();
+    }
+}
+
+bool SimpleEQAudioProcessor::recallSnapshot(int slot) {
+    const juce::ScopedLock lock (presetLock);
+    
+    if (! hasSnapshot(slot)) {
+        return false;
+    }
+    
+    applyParameterValues(snapshots[(size_t) slot], nullptr);
+    return true;
+}
+
+bool SimpleEQAudioProcessor::hasSnapshot(int slot) const {
+    const juce::ScopedLock lock (presetLock);
+    return juce::isPositiveAndBelow(slot, numSnapshots) && ! snapshots[(size_t) slot].empty();
+}
+
+void SimpleEQAudioProcessor::setPresetCrossfade(double seconds) {
+    presetCrossfadeSeconds = juce::jmax(0.0, seconds);
+}
+
+//Plain values, in rangedParameters' order
+std::vector<float> SimpleEQAudioProcessor::captureParameterValues() const {
+    std::vector<float> values;
+    values.reserve(rangedParameters.size());
+    
+    for (auto* param : rangedParameters) {
+        values.push_back(param->convertFrom0to1(param->getValue()));
+    }
+    
+    return values;
+}
+
+//mapping gives each value's index in rangedParameters, null when the values are already in that order.
+//Parameters the values don't cover go back to their defaults, so a preset always recalls the same sound.
+void SimpleEQAudioProcessor::applyParameterValues(const std::vector<float>& values, const std::vector<int>* mapping) {
+    std::vector<float> targets;
+    targets.reserve(rangedParameters.size());
+    for (auto* param : rangedParameters) {
+        targets.push_back(param->getDefaultValue());
+    }
+    
+    for (size_t i = 0; i < values.size(); ++i) {
+        auto index = mapping == nullptr ? (int) i : i < mapping->size() ? (*mapping)[i] : -1;
+        
+        if (juce::isPositiveAndBelow(index, (int) rangedParameters.size())) {
+            targets[(size_t) index] = rangedParameters[(size_t) index]->convertTo0to1(values[i]);
+        }
+    }
+    
+    switchParameters([this, &targets] {
+        //Only what differs is set, so switching between similar presets leaves most bands clean
+        for (size_t i = 0; i < rangedParameters.size(); ++i) {
+            if (rangedParameters[i]->getValue() != targets[i]) {
+                rangedParameters[i]->setValueNotifyingHost(targets[i]);
+            }
+        }
+    });
+}
+
+//Any thread but the audio thread. The audio thread holds its filters from here until the new designs are published.
+void SimpleEQAudioProcessor::switchParameters(const std::function<void()>& changeParameters) {
+    const juce::ScopedLock lock (presetLock);
+    
+    switchesInProgress.fetch_add(1, std::memory_order_acq_rel);
+    changeParameters();
+    
+    //Generations before parameters, like updateAllFilters, so a change that lands in between is picked up as an ordinary one
+    PreparedSwitch prepared;
+    for (size_t band = 0; band < numBands; ++band) {
+        prepared.generations[band] = bandGenerations[band].load(std::memory_order_acquire);
+    }
+    
+    //The second set is always designed, whether the stereo mode the audio thread lands on uses it is up to updateChannels
+    prepared.first = getChainSettings(chainParameters);
+    prepared.second = getSecondChainSettings(chainParameters, prepared.first);
+    prepared.sampleRate = processingSampleRate.load();
+    prepared.firstCoefficients = makeChainCoefficients(prepared.first, prepared.sampleRate);
+    prepared.secondCoefficients = makeChainCoefficients(prepared.second, prepared.sampleRate);
+    
+    //A switch still waiting is replaced. One the audio thread is reading is waited out, that's only a few stores.
+    for (;;) {
+        auto state = switchState.load(std::memory_order_acquire);
+        if (state != SwitchState::reading && switchState.compare_exchange_weak(state, SwitchState::writing, std::memory_order_acquire)) {
+            break;
+        }
+        juce::Thread::yield();
+    }
+    
+    preparedSwitch = prepared;
+    switchState.store(SwitchState::ready, std::memory_order_release);
+    switchesInProgress.fetch_sub(1, std::memory_order_acq_rel);
+}
+
+//Audio thread. Starts the crossfade to a published switch, unless the last one is still fading out.
+//True if the switch's designs were installed.
+bool SimpleEQAudioProcessor::takePendingSwitch() {
+    if (floatFilters.isFading() || doubleFilters.isFading()) {
+        return false;
+    }
+    
+    auto ready = SwitchState::ready;
+    if (! switchState.compare_exchange_strong(ready, SwitchState::reading, std::memory_order_acquire)) {
+        return false;
+    }
+    
+    auto installed = false;
+    
+    //Linear phase designs its FIR from the parameters, which already hold the new values, and crossfades it in itself.
+    //A switch designed for another rate is left to the ordinary dirty band redesign.
+    auto& prepared = preparedSwitch;
+    if (! linearPhaseActive && prepared.sampleRate == processingSampleRate.load()) {
+        floatFilters.beginSwitch();
+        doubleFilters.beginSwitch();
+        
+        //Stages skipped while passing through hold stale state, the outgoing set fades out from rest instead
+        if (wasPassthrough) {
+            floatFilters.getOutgoing().reset();
+            doubleFilters.getOutgoing().reset();
+        }
+        
+        updateChannels(prepared.first, prepared.second, [this, &prepared](const ChainSettings& settings, int channel) {
+            //updateChannels hands over first, second, or an all-bypassed copy that only needs its flags from here
+            auto& chainCoefficients = &settings == &prepared.second ? prepared.secondCoefficients : prepared.firstCoefficients;
+            setChainCoefficients(chainCoefficients, settings, channel);
+        });
+        
+        appliedGenerations = prepared.generations;
+        resetSmoothers(prepared.first);
+        
+        //The prepared designs are static, the next slice adds the detectors' gains again
+        markDynamicBandsDirty();
+        installed = true;
+    }
+    
+    switchState.store(SwitchState::idle, std::memory_order_release);
+    return installed;
+}
+
+//A switch is being written to the parameters, or is published but not taken yet
+bool SimpleEQAudioProcessor::isWaitingForSwitch() const {
+    return switchesInProgress.load(std::memory_order_acquire) > 0 || switchState.load(std::memory_order_acquire) != SwitchState::idle;
+}
+
+static const BankCoefficients noBankBands;
+
+//Designs made elsewhere, with the bypass flags and the bank's on/off from chainSettings
+void SimpleEQAudioProcessor::setChainCoefficients(const ChainCoefficients& chainCoefficients, const ChainSettings& chainSettings, int channel) {
+    auto anyBandEnabled = std::any_of(chainSettings.bands.begin(), chainSettings.bands.end(), [](const BandSettings& band) { return band.enabled; });
+    auto& bankCoefficients = anyBandEnabled ? chainCoefficients.bank : noBankBands;
+    
+    floatFilters.getLive().setLowCut(chainCoefficients.lowCut, chainSettings.lcBypassed, channel);
+    floatFilters.getLive().setPeak(chainCoefficients.peak, chainSettings.pdBypassed, channel);
+    floatFilters.getLive().setHighCut(chainCoefficients.highCut, chainSettings.hcBypassed, channel);
+    floatFilters.getLive().setBank(bankCoefficients, channel);
     
-    leftChain.setBypassed<ChainPositions::Peak>(chainSettings.pdBypassed);
-    rightChain.setBypassed<ChainPositions::Peak>(chainSettings.pdBypassed);
+    doubleFilters.getLive().setLowCut(chainCoefficients.lowCut, chainSettings.lcBypassed, channel);
+    doubleFilters.getLive().setPeak(chainCoefficients.peak, chainSettings.pdBypassed, channel);
+    doubleFilters.getLive().setHighCut(chainCoefficients.highCut, chainSettings.hcBypassed, channel);
+    doubleFilters.getLive().setBank(bankCoefficients, channel);
     
-    updateCoefficients(leftChain.get<ChainPositions::Peak>().coefficients, peakCoefficients);
-    updateCoefficients(rightChain.get<ChainPositions::Peak>().coefficients, peakCoefficients);
+    recordInstalled(channel, [&](ChainCoefficients& installed) {
+        installed.lowCut = chainCoefficients.lowCut;
+        installed.peak = chainCoefficients.peak;
+        installed.highCut = chainCoefficients.highCut;
+        installed.bank = bankCoefficients;
+        installed.lcBypassed = chainSettings.lcBypassed;
+        installed.pdBypassed = chainSettings.pdBypassed;
+        installed.hcBypassed = chainSettings.hcBypassed;
+    });
 }
 
-void::SimpleEQAudioProcessor::updateCoefficients(Coefficients &old, const Coefficients &replacements) {
-    *old = *replacements;
+//Updating P/D Filter
+void SimpleEQAudioProcessor::updatePeakFilter(const ChainSettings &chainSettings, bool quantised, int channel) {
+    auto peakCoefficients = quantised ? coefficientCache.getPeak(chainSettings.peakFreq, chainSettings.peakQ, chainSettings.peakDB_gain)
+                                      : makePeakCoefficients(processingSampleRate, chainSettings.peakFreq, chainSettings.peakQ, chainSettings.peakDB_gain);
+    
+    callbackMonitor.addRedesign();
+    
+    //The precision that isn't in use has no channels, so this costs nothing
+    floatFilters.getLive().setPeak(peakCoefficients, chainSettings.pdBypassed, channel);
+    doubleFilters.getLive().setPeak(peakCoefficients, chainSettings.pdBypassed, channel);
+    
+    recordInstalled(channel, [&](ChainCoefficients& installed) {
+        installed.peak = peakCoefficients;
+        installed.pdBypassed = chainSettings.pdBypassed;
+    });
 }
 
 //Updating LC
-void::SimpleEQAudioProcessor::updateLCFilters(const ChainSettings &chainSettings) {
-    auto cutCoefficients = juce::dsp::FilterDesign<float>::designIIRHighpassHighOrderButterworthMethod(chainSettings.lcFreq, getSampleRate(), 2*(chainSettings.lcSlope + 1));
+void::SimpleEQAudioProcessor::updateLCFilters(const ChainSettings &chainSettings, bool quantised, int channel) {
+    auto cutCoefficients = quantised ? coefficientCache.getLowCut(chainSettings.lcFreq, chainSettings.lcSlope + 1)
+                                     : makeLowCutCoefficients(processingSampleRate, chainSettings.lcFreq, chainSettings.lcSlope + 1);
     
-    auto& leftLC = leftChain.get<ChainPositions::LowCut>();
-    auto& rightLC = rightChain.get<ChainPositions::LowCut>();
+    callbackMonitor.addRedesign();
     
-    leftChain.setBypassed<ChainPositions::LowCut>(chainSettings.lcBypassed);
-    rightChain.setBypassed<ChainPositions::LowCut>(chainSettings.lcBypassed);
+    floatFilters.getLive().setLowCut(cutCoefficients, chainSettings.lcBypassed, channel);
+    doubleFilters.getLive().setLowCut(cutCoefficients, chainSettings.lcBypassed, channel);
     
-    updateCutFilter(leftLC, cutCoefficients, chainSettings.lcSlope);
-    updateCutFilter(rightLC, cutCoefficients, chainSettings.lcSlope);
+    recordInstalled(channel, [&](ChainCoefficients& installed) {
+        installed.lowCut = cutCoefficients;
+        installed.lcBypassed = chainSettings.lcBypassed;
+    });
 }
 
 //Updating HC
-void::SimpleEQAudioProcessor::updateHCFilters(const ChainSettings &chainSettings) {
-    auto HCutCoefficients = juce::dsp::FilterDesign<float>::designIIRLowpassHighOrderButterworthMethod(chainSettings.hcFreq, getSampleRate(), 2*(chainSettings.hcSlope + 1));
+void::SimpleEQAudioProcessor::updateHCFilters(const ChainSettings &chainSettings, bool quantised, int channel) {
+    auto HCutCoefficients = quantised ? coefficientCache.getHighCut(chainSettings.hcFreq, chainSettings.hcSlope + 1)
+                                      : makeHighCutCoefficients(processingSampleRate, chainSettings.hcFreq, chainSettings.hcSlope + 1);
+    
+    callbackMonitor.addRedesign();
     
-    auto& leftHC = leftChain.get<ChainPositions::HighCut>();
-    auto& rightHC = rightChain.get<ChainPositions::HighCut>();
+    floatFilters.getLive().setHighCut(HCutCoefficients, chainSettings.hcBypassed, channel);
+    doubleFilters.getLive().setHighCut(HCutCoefficients, chainSettings.hcBypassed, channel);
     
-    leftChain.setBypassed<ChainPositions::HighCut>(chainSettings.hcBypassed);
-    rightChain.setBypassed<ChainPositions::HighCut>(chainSettings.hcBypassed);
+    recordInstalled(channel, [&](ChainCoefficients& installed) {
+        installed.highCut = HCutCoefficients;
+        installed.hcBypassed = chainSettings.hcBypassed;
+    });
+}
+
+//Updating the band bank, a handful of designs at most, so always exact
+void SimpleEQAudioProcessor::updateBankFilters(const ChainSettings &chainSettings, int channel) {
+    auto bankCoefficients = makeBankCoefficients(chainSettings, processingSampleRate);
+    
+    callbackMonitor.addRedesign();
+    
+    floatFilters.getLive().setBank(bankCoefficients, channel);
+    doubleFilters.getLive().setBank(bankCoefficients, channel);
+    
+    recordInstalled(channel, [&](ChainCoefficients& installed) { installed.bank = bankCoefficients; });
+}
+
+StereoMode SimpleEQAudioProcessor::getEffectiveStereoMode(const ChainSettings& chainSettings) const {
+    return numMainChannels == 2 ? chainSettings.stereoMode : StereoMode::linked;
+}
+
+//Only reads the "_2" parameters when a mode uses them
+ChainSettings SimpleEQAudioProcessor::getSecondSettingsIfSplit(const ChainSettings& first) const {
+    auto mode = getEffectiveStereoMode(first);
+    return mode == StereoMode::leftRight || mode == StereoMode::midSide ? getSecondChainSettings(chainParameters, first) : first;
+}
+
+//The channel that mid or side only leaves alone, everything bypassed
+static ChainSettings getUntouchedSettings(const ChainSettings& first) {
+    auto untouched = first;
+    untouched.lcBypassed = untouched.pdBypassed = untouched.hcBypassed = true;
+    for (auto& band : untouched.bands) {
+        band.enabled = false;
+    }
     
-    updateCutFilter(leftHC, HCutCoefficients, chainSettings.hcSlope);
-    updateCutFilter(rightHC, HCutCoefficients, chainSettings.hcSlope);
+    return untouched;
+}
+
+template <typename Update>
+void SimpleEQAudioProcessor::updateChannels(const ChainSettings& first, const ChainSettings& second, Update&& update) {
+    auto mode = getEffectiveStereoMode(first);
+    
+    if (mode != activeStereoMode) {
+        activeStereoMode = mode;
+        auto midSide = mode == StereoMode::midSide || mode == StereoMode::midOnly || mode == StereoMode::sideOnly;
+        floatFilters.getLive().setMidSide(midSide);
+        doubleFilters.getLive().setMidSide(midSide);
+    }
+    
+    //Linked channels share one design of every band
+    if (mode == StereoMode::linked) {
+        update(first, ChannelFilters<float>::allChannels);
+        return;
+    }
+    
+    auto untouched = getUntouchedSettings(first);
+    
+    switch (mode) {
+        case StereoMode::leftRight:
+        case StereoMode::midSide:
+            update(first, 0);
+            update(second, 1);
+            break;
+        case StereoMode::midOnly:
+            update(first, 0);
+            update(untouched, 1);
+            break;
+        case StereoMode::sideOnly:
+            update(untouched, 0);
+            update(first, 1);
+            break;
+        case StereoMode::linked:
+            break;
+    }
+}
+
+LinearPhaseEQ::ChannelCoefficients SimpleEQAudioProcessor::makeLinearPhaseCoefficients(double sampleRate) const {
+    auto first = getChainSettings(chainParameters);
+    auto mode = getEffectiveStereoMode(first);
+    auto second = getSecondSettingsIfSplit(first);
+    
+    if (mode == StereoMode::midOnly) {
+        second = getUntouchedSettings(first);
+    } else if (mode == StereoMode::sideOnly) {
+        second = first;
+        first = getUntouchedSettings(second);
+    }
+    
+    LinearPhaseEQ::ChannelCoefficients coefficients;
+    coefficients.first = makeChainCoefficients(first, sampleRate);
+    coefficients.second = makeChainCoefficients(second, sampleRate);
+    coefficients.midSide = mode == StereoMode::midSide || mode == StereoMode::midOnly || mode == StereoMode::sideOnly;
+    return coefficients;
+}
+
+//Picks up parameter changes without needing to process: redesigns dirty bands, or queues a new FIR
+void SimpleEQAudioProcessor::applyParameterChanges() {
+    if (! linearPhaseActive) {
+        updateDirtyFilters();
+        return;
+    }
+    
+    //Parameter changes become a new FIR, designed and crossfaded in off the audio thread
+    auto dirty = consumeDirtyBands();
+    if (std::any_of(dirty.begin(), dirty.end(), [](bool d) { return d; })) {
+        linearPhaseEQ.requestRedesign();
+    }
+}
+
+//Works out which fast paths the current settings allow, only when a band has changed since the last look
+void SimpleEQAudioProcessor::refreshFastPaths(bool force) {
+    auto changed = force;
+    
+    for (size_t band = 0; band < numBands; ++band) {
+        auto generation = bandGenerations[band].load(std::memory_order_acquire);
+        changed = changed || generation != fastPathGenerations[band];
+        fastPathGenerations[band] = generation;
+    }
+    
+    if (! changed) {
+        return;
+    }
+    
+    auto chainSettings = getChainSettings(chainParameters);
+    
+    //Dynamic bands, each detector follows its band's static frequency and Q
+    if (chainSettings.pdDynamic && ! chainSettings.pdBypassed) {
+        dynamicsDetector.setBand(0, BandType::peak, chainSettings.peakFreq, chainSettings.peakQ);
+    } else {
+        dynamicsDetector.clearBand(0);
+    }
+    
+    for (int band = 0; band < numBankBands; ++band) {
+        auto& settings = chainSettings.bands[(size_t) band];
+        
+        if (settings.isDynamic()) {
+            dynamicsDetector.setBand(band + 1, settings.type, settings.freq, settings.q);
+        } else {
+            dynamicsDetector.clearBand(band + 1);
+        }
+    }
+    
+    dynamicsDetector.setSettings(chainSettings.dynamics);
+    useSidechain = chainSettings.useSidechain;
+    
+    //A 0 dB static peak is exactly unity. Cuts always shape something, even at the ends of their ranges.
+    //Mid or side only leave the other channel alone, and encoding and decoding alone is exactly unity too.
+    auto isNeutral = [](const ChainSettings& settings) {
+        return settings.lcBypassed && settings.hcBypassed
+            && (settings.pdBypassed || (settings.peakDB_gain == 0.0f && ! settings.pdDynamic))
+            && std::all_of(settings.bands.begin(), settings.bands.end(), [](const BandSettings& band) { return band.isNeutral(); });
+    };
+    
+    chainIsNeutral = isNeutral(chainSettings) && isNeutral(getSecondSettingsIfSplit(chainSettings));
+    tailStale = true;
+}
+
+template <typename Function>
+void SimpleEQAudioProcessor::recordInstalled(int channel, Function&& function) {
+    for (size_t ch = 0; ch < installedCoefficients.size(); ++ch) {
+        if (channel == ChannelFilters<float>::allChannels || (size_t) channel == ch) {
+            function(installedCoefficients[ch]);
+        }
+    }
+    
+    tailStale = true;
+}
+
+//From the designs already installed, the slowest channel down to -100 dB so stopping afterwards leaves nothing audible
+void SimpleEQAudioProcessor::updateTailFlushSamples() {
+    tailStale = false;
+    
+    //The latency, then the half of the FIR after its centre
+    if (linearPhaseActive) {
+        tailFlushSamples = linearPhaseEQ.getLatencySamples() + linearPhaseEQ.getFirLength() / 2;
+        return;
+    }
+    
+    auto hostRate = getSampleRate() > 0.0 ? getSampleRate() : 44100.0;
+    auto filterRate = processingSampleRate.load();
+    
+    auto decaySamples = 0.0;
+    for (auto& installed : installedCoefficients) {
+        decaySamples = juce::jmax(decaySamples, estimateChainDecaySamples(installed, 100.0));
+    }
+    
+    decaySamples *= hostRate / filterRate;
+    tailFlushSamples = (juce::int64) std::ceil(juce::jmin(decaySamples, hostRate * 30.0)) + getLatencySamples();
 }
 
 //Consolidating Updates
 void::SimpleEQAudioProcessor::updateAllFilters() {
-    auto chainSettings = getChainSettings(apvts);
+    //Generations are read before the parameters, so a change that lands in between is picked up next block
+    for (size_t band = 0; band < numBands; ++band) {
+        appliedGenerations[band] = bandGenerations[band].load(std::memory_order_acquire);
+    }
+    
+    auto chainSettings = getChainSettings(chainParameters);
+    
+    updateChannels(chainSettings, getSecondSettingsIfSplit(chainSettings), [this](const ChainSettings& settings, int channel) {
+        updatePeakFilter(settings, true, channel);
+        
+        updateLCFilters(settings, true, channel);
+        updateHCFilters(settings, true, channel);
+        updateBankFilters(settings, channel);
+    });
+}
+
+//For designs made without the detectors' gains. Only the audio thread's record moves, views aren't told.
+void SimpleEQAudioProcessor::markDynamicBandsDirty() {
+    if (dynamicsDetector.isActive(0)) {
+        --appliedGenerations[ChainPositions::Peak];
+    }
+    for (int band = 0; band < numBankBands; ++band) {
+        if (dynamicsDetector.isActive(band + 1)) {
+            --appliedGenerations[ChainPositions::Bank];
+            break;
+        }
+    }
+}
+
+std::array<bool, numBands> SimpleEQAudioProcessor::consumeDirtyBands() {
+    std::array<bool, numBands> dirty {};
+    
+    for (size_t band = 0; band < numBands; ++band) {
+        auto generation = bandGenerations[band].load(std::memory_order_acquire);
+        dirty[band] = generation != appliedGenerations[band];
+        appliedGenerations[band] = generation;
+    }
+    
+    return dirty;
+}
+
+//Only redesigns the bands whose parameters moved since the last block
+void::SimpleEQAudioProcessor::updateDirtyFilters() {
+    auto dirty = consumeDirtyBands();
+    
+    if (std::none_of(dirty.begin(), dirty.end(), [](bool d) { return d; })) {
+        return;
+    }
     
-    updatePeakFilter(chainSettings);
+    auto chainSettings = getChainSettings(chainParameters);
     
-    updateLCFilters(chainSettings);
-    updateHCFilters(chainSettings);
+    updateChannels(chainSettings, getSecondSettingsIfSplit(chainSettings), [this, &dirty](const ChainSettings& settings, int channel) {
+        if (dirty[ChainPositions::Peak]) {
+            updatePeakFilter(settings, true, channel);
+        }
+        if (dirty[ChainPositions::LowCut]) {
+            updateLCFilters(settings, true, channel);
+        }
+        if (dirty[ChainPositions::HighCut]) {
+            updateHCFilters(settings, true, channel);
+        }
+        if (dirty[ChainPositions::Bank]) {
+            updateBankFilters(settings, channel);
+        }
+    });
 }
 
 //Create Parameters
@@ -294,19 +1600,70 @@ juce::AudioProcessorValueTreeState::ParameterLayout SimpleEQAudioProcessor::crea
     
     //Filter Parameters
     juce::StringArray filterValues;
-    for (int i = 0; i<4; ++i) {
+    for (int i = 0; i < maxCutStages; ++i) {
         juce::String str;
-        str << (48 - 12*i);
-        str << " dbB/oct";
+        str << (12 + 12*i);
+        str << " dB/oct";
         filterValues.add(str);
     }
-    layout.add(std::make_unique<juce::AudioParameterChoice>(juce::ParameterID("LC_slope", 1), "Low Cut Slope", filterValues, 0));
-    layout.add(std::make_unique<juce::AudioParameterChoice>(juce::ParameterID("HC_slope", 1), "High Cut Slope", filterValues, 0));
+    //New IDs for the eight slopes: a host keeps automation normalised, and LC_slope's four choices put 48 dB/oct at 1.
+    //Saved states and preset banks are moved over in getCurrentParameterID().
+    layout.add(std::make_unique<juce::AudioParameterChoice>(juce::ParameterID("LC_slope8", 2), "Low Cut Slope", filterValues, 0));
+    layout.add(std::make_unique<juce::AudioParameterChoice>(juce::ParameterID("HC_slope8", 2), "High Cut Slope", filterValues, 0));
     
     layout.add(std::make_unique<juce::AudioParameterBool>(juce::ParameterID("LC_bp", 1), "Low Cut Bypassed", false));
     layout.add(std::make_unique<juce::AudioParameterBool>(juce::ParameterID("PD_bp", 1), "Peak Bypassed", false));
     layout.add(std::make_unique<juce::AudioParameterBool>(juce::ParameterID("HC_bp", 1), "High Cut Bypassed", false));
     
+    //Dynamic Parameters, the peak band's and every dynamic bank band's
+    layout.add(std::make_unique<juce::AudioParameterBool>(juce::ParameterID("PD_dyn", 1), "Peak/Dip Dynamic", false));
+    layout.add(std::make_unique<juce::AudioParameterFloat>(juce::ParameterID("PD_thresh", 1), "Dynamic Threshold", juce::NormalisableRange<float>(-60.0f, 0.0f, 0.1f, 1.0f), -24.0f));
+    layout.add(std::make_unique<juce::AudioParameterFloat>(juce::ParameterID("PD_ratio", 1), "Dynamic Ratio", juce::NormalisableRange<float>(1.0f, 20.0f, 0.1f, 1.0f), 4.0f));
+    layout.add(std::make_unique<juce::AudioParameterFloat>(juce::ParameterID("PD_attack", 1), "Dynamic Attack", juce::NormalisableRange<float>(0.1f, 100.0f, 0.1f, 1.0f), 5.0f));
+    layout.add(std::make_unique<juce::AudioParameterFloat>(juce::ParameterID("PD_release", 1), "Dynamic Release", juce::NormalisableRange<float>(5.0f, 1000.0f, 1.0f, 1.0f), 100.0f));
+    layout.add(std::make_unique<juce::AudioParameterBool>(juce::ParameterID("PD_sc", 1), "Dynamic Sidechain", false));
+    
+    //Stereo Parameters, the second set drives the right or side channel of a stereo bus
+    juce::StringArray stereoModes { "Linked", "Left/Right", "Mid/Side", "Mid Only", "Side Only" };
+    layout.add(std::make_unique<juce::AudioParameterChoice>(juce::ParameterID("ST_mode", 1), "Stereo Mode", stereoModes, 0));
+    
+    layout.add(std::make_unique<juce::AudioParameterFloat>(juce::ParameterID("LC_freq_2", 1), "Low Cut Frequency 2", juce::NormalisableRange<float>(20.0f, 20000.0f, 1.0f, 1.0f), 120.0f));
+    layout.add(std::make_unique<juce::AudioParameterFloat>(juce::ParameterID("HC_freq_2", 1), "High Cut Frequency 2", juce::NormalisableRange<float>(20.0f, 20000.0f, 1.0f, 1.0f), 20000.0f));
+    layout.add(std::make_unique<juce::AudioParameterFloat>(juce::ParameterID("PD_freq_2", 1), "Peak/Dip Frequency 2", juce::NormalisableRange<float>(20.0f, 20000.0f, 1.0f, 1.0f), 300.0f));
+    layout.add(std::make_unique<juce::AudioParameterFloat>(juce::ParameterID("PD_gain_2", 1), "Peak/Dip Gain 2", juce::NormalisableRange<float>(-24.0f, 24.0f, 0.1f, 1.0f), 0.0f));
+    layout.add(std::make_unique<juce::AudioParameterFloat>(juce::ParameterID("PD_q_2", 1), "Peak/Dip Q 2", juce::NormalisableRange<float>(0.1f, 24.0f, 0.01f, 1.0f), 1.0f));
+    layout.add(std::make_unique<juce::AudioParameterChoice>(juce::ParameterID("LC_slope8_2", 2), "Low Cut Slope 2", filterValues, 0));
+    layout.add(std::make_unique<juce::AudioParameterChoice>(juce::ParameterID("HC_slope8_2", 2), "High Cut Slope 2", filterValues, 0));
+    layout.add(std::make_unique<juce::AudioParameterBool>(juce::ParameterID("LC_bp_2", 1), "Low Cut Bypassed 2", false));
+    layout.add(std::make_unique<juce::AudioParameterBool>(juce::ParameterID("PD_bp_2", 1), "Peak Bypassed 2", false));
+    layout.add(std::make_unique<juce::AudioParameterBool>(juce::ParameterID("HC_bp_2", 1), "High Cut Bypassed 2", false));
+    
+    //Band Bank Parameters, one group per band
+    for (int band = 0; band < numBankBands; ++band) {
+        auto bandName = "Band " + juce::String(band + 1);
+        auto group = std::make_unique<juce::AudioProcessorParameterGroup>(bankParameterPrefix + juce::String(band + 1), bandName, "|");
+        
+        for (auto& descriptor : bandParameterDescriptors) {
+            auto parameterID = juce::ParameterID(getBandParameterID(band, descriptor.parameter), 1);
+            auto name = bandName + " " + descriptor.name;
+            auto defaultValue = descriptor.getDefault(band);
+            
+            switch (descriptor.kind) {
+                case BandParameterDescriptor::choice:
+                    group->addChild(std::make_unique<juce::AudioParameterChoice>(parameterID, name, bandTypeNames, (int) defaultValue));
+                    break;
+                case BandParameterDescriptor::toggle:
+                    group->addChild(std::make_unique<juce::AudioParameterBool>(parameterID, name, defaultValue > 0.5f));
+                    break;
+                case BandParameterDescriptor::continuous:
+                    group->addChild(std::make_unique<juce::AudioParameterFloat>(parameterID, name, descriptor.range, defaultValue));
+                    break;
+            }
+        }
+        
+        layout.add(std::move(group));
+    }
+    
     return layout;
 }
 
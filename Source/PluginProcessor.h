@@ -9,14 +9,54 @@
 #pragma once
 
 #include <JuceHeader.h>
+#include "CoefficientDesign.h"
+#include "CoefficientCache.h"
+#include "CallbackMonitor.h"
+#include "SpectrumAnalyzer.h"
+#include "LinearPhaseEQ.h"
+#include "FilterEngines.h"
+#include "VectorChain.h"
+#include "BandBank.h"
+#include "DynamicsDetector.h"
+#include "PresetBank.h"
 
 enum Slope {
     Slope_12,
     Slope_24,
     Slope_36,
-    Slope_48
+    Slope_48,
+    Slope_60,
+    Slope_72,
+    Slope_84,
+    Slope_96
 };
 
+//One band of the band bank
+struct BandSettings {
+    BandType type {BandType::peak};
+    float freq {1000.0f}, gainDB {0.0f}, q {1.0f};
+    bool enabled {false};
+    bool dynamic {false};   //Gain pulled down by the level around the band, notches have no gain to pull
+    
+    bool isDynamic() const { return enabled && dynamic && type != BandType::notch; }
+    
+    //Off, or a static type with a gain set to 0 dB. A notch always cuts.
+    bool isNeutral() const { return ! enabled || (type != BandType::notch && gainDB == 0.0f && ! dynamic); }
+};
+
+static constexpr int numBankBands = maxBankBands;
+
+//How a stereo bus's two channels share the bands. Every other layout is always linked.
+enum class StereoMode {
+    linked,     //One set of settings and one design for both channels
+    leftRight,  //Left from the main parameters, right from the "_2" set
+    midSide,    //Mid from the main parameters, side from the "_2" set
+    midOnly,    //Mid from the main parameters, side untouched
+    sideOnly    //Side from the main parameters, mid untouched
+};
+
+static constexpr int numStereoModes = 5;
+
 struct ChainSettings {
     float lcFreq {0.0f}, hcFreq {0.0f};
     float peakFreq {0.0f}, peakDB_gain {0.0f}, peakQ {1.0f};
@@ -25,25 +65,494 @@ struct ChainSettings {
     bool lcBypassed = false;
     bool pdBypassed = false;
     bool hcBypassed = false;
+    
+    //The peak band's dynamic mode, the thresholds and times are shared with the dynamic bank bands
+    bool pdDynamic = false;
+    bool useSidechain = false;
+    DynamicsDetector::Settings dynamics;
+    
+    std::array<BandSettings, numBankBands> bands;
+    
+    StereoMode stereoMode {StereoMode::linked};
 };
 
-ChainSettings getChainSettings(juce::AudioProcessorValueTreeState& apvts);
+//Every bank band has one of each, with IDs like "B3_freq" (see the descriptor table in PluginProcessor.cpp)
+enum class BandParameter {
+    type,
+    freq,
+    gain,
+    q,
+    enabled,
+    dynamic
+};
+
+static constexpr int numBandParameters = 6;
 
-//DSP Namespace Aliases
-using Filter = juce::dsp::IIR::Filter<float>;
-using CutFilter = juce::dsp::ProcessorChain<Filter, Filter, Filter, Filter>;
-using MonoChain = juce::dsp::ProcessorChain<CutFilter, Filter, CutFilter>;
+//The IDs are built once, so looking parameters up by them never allocates
+const juce::String& getBandParameterID(int band, BandParameter parameter);
+
+//Every parameter ChainSettings are read from, looked up by ID once instead of on every read
+struct ChainParameters {
+    explicit ChainParameters(const juce::AudioProcessorValueTreeState& apvts);
+    
+    //The cuts and the peak, from the main parameters or the "_2" set
+    struct CutsAndPeak {
+        juce::RangedAudioParameter *lcFreq, *hcFreq, *peakFreq, *peakGain, *peakQ, *lcSlope, *hcSlope;
+        juce::RangedAudioParameter *lcBypassed, *pdBypassed, *hcBypassed;
+    };
+    
+    CutsAndPeak first, second;
+    juce::RangedAudioParameter *pdDynamic, *useSidechain, *threshold, *ratio, *attack, *release;
+    juce::RangedAudioParameter *stereoMode;
+    std::array<std::array<juce::RangedAudioParameter*, numBandParameters>, numBankBands> bands;
+};
+
+ChainSettings getChainSettings(const ChainParameters& parameters);
+
+//The right or side channel's settings: the cuts and the peak from the "_2" parameters, the rest shared with first
+ChainSettings getSecondChainSettings(const ChainParameters& parameters, const ChainSettings& first);
+
+//The same, looking every parameter up. Off the audio thread only.
+ChainSettings getChainSettings(const juce::AudioProcessorValueTreeState& apvts);
+ChainSettings getSecondChainSettings(const juce::AudioProcessorValueTreeState& apvts, const ChainSettings& first);
+
+//DSP Namespace Aliases, the Engine policy picks the biquad topology at compile time (see FilterEngines.h)
+template <typename Engine, typename SampleType = float>
+using CutFilterT = CascadeFilter<Engine, SampleType>;
+
+template <typename Engine, typename SampleType = float>
+using MonoChainT = juce::dsp::ProcessorChain<CutFilterT<Engine, SampleType>, typename Engine::template Filter<SampleType>, CutFilterT<Engine, SampleType>,
+                                             BankFilter<SampleType>>;
+
+using Filter = SelectedFilterEngine::Filter<float>;
+using CutFilter = CutFilterT<SelectedFilterEngine>;
+using MonoChain = MonoChainT<SelectedFilterEngine>;
 
 enum ChainPositions {
     LowCut,
     Peak,
-    HighCut
+    HighCut,
+    Bank
+};
+
+static constexpr int numBands = 4;
+
+//The slope picks which of the cascade's compiled stage counts runs, there are no per-stage bypasses
+template <typename CutFilterType>
+void updateCutFilter(CutFilterType& cut, const CutCoefficients& cutCoefficients) {
+    applyCoefficients(cut, cutCoefficients);
+}
+
+//Gives the peak biquad-sized coefficients so later updates can write in place, the cuts keep theirs inline
+template <typename ChainType>
+void allocateChainStorage(ChainType& chain) {
+    allocateBiquadStorage(chain.template get<ChainPositions::Peak>());
+}
+
+ChainCoefficients makeChainCoefficients(const ChainSettings& chainSettings, double sampleRate);
+BankCoefficients makeBankCoefficients(const ChainSettings& chainSettings, double sampleRate);
+
+template <typename ChainType>
+void applyChainCoefficients(ChainType& chain, const ChainCoefficients& chainCoefficients) {
+    updateCutFilter(chain.template get<ChainPositions::LowCut>(), chainCoefficients.lowCut);
+    applyCoefficients(chain.template get<ChainPositions::Peak>(), chainCoefficients.peak);
+    updateCutFilter(chain.template get<ChainPositions::HighCut>(), chainCoefficients.highCut);
+    applyCoefficients(chain.template get<ChainPositions::Bank>(), chainCoefficients.bank);
+    
+    chain.template setBypassed<ChainPositions::LowCut>(chainCoefficients.lcBypassed);
+    chain.template setBypassed<ChainPositions::Peak>(chainCoefficients.pdBypassed);
+    chain.template setBypassed<ChainPositions::HighCut>(chainCoefficients.hcBypassed);
+}
+
+//Everything that filters the main bus at one sample precision, sized to the bus layout in prepare()
+template <typename SampleType>
+struct ChannelFilters {
+    //What the setters take to set every channel at once, otherwise they set the one channel
+    static constexpr int allChannels = -1;
+    
+    //One chain per channel, the scalar reference path
+    std::vector<MonoChainT<SelectedFilterEngine, SampleType>> chains;
+    
+   #if JUCE_USE_SIMD
+    VectorFilterBank<SampleType> bank;
+   #endif
+    
+    //Polyphase half-band IIR oversampling around the chains, null when running at the host rate
+    std::unique_ptr<juce::dsp::Oversampling<SampleType>> oversampling;
+    
+    //Channels 0 and 1 run as mid and side
+    bool midSide {false};
+    
+    //Not realtime safe. Preparing 0 channels frees everything, which is what the unused precision gets.
+    //sampleRate is the host rate; the chains run at sampleRate << oversamplingOrder.
+    void prepare(int numChannels, double sampleRate, int maximumBlockSize, int oversamplingOrder = 0) {
+        oversampling.reset();
+        
+        if (oversamplingOrder > 0 && numChannels > 0) {
+            oversampling = std::make_unique<juce::dsp::Oversampling<SampleType>>((size_t) numChannels, (size_t) oversamplingOrder,
+                                                                                juce::dsp::Oversampling<SampleType>::filterHalfBandPolyphaseIIR,
+                                                                                true, true);
+            oversampling->initProcessing((size_t) maximumBlockSize);
+        }
+        
+        auto factor = 1 << juce::jmax(0, oversamplingOrder);
+        sampleRate *= factor;
+        maximumBlockSize *= factor;
+        
+        juce::dsp::ProcessSpec spec { sampleRate, (juce::uint32) maximumBlockSize, 1 };
+        
+        chains = std::vector<MonoChainT<SelectedFilterEngine, SampleType>>((size_t) numChannels);
+        
+        //Coefficients are rewritten in place from now on, so give every stage its storage before prepare sizes the state
+        for (auto& chain : chains) {
+            allocateChainStorage(chain);
+            chain.prepare(spec);
+        }
+        
+       #if JUCE_USE_SIMD
+        bank.prepare(numChannels, maximumBlockSize);
+        bank.setMidSide(midSide);
+       #endif
+    }
+    
+    void setLowCut(const CutCoefficients& cutCoefficients, bool bypassed, int channel = allChannels) {
+        forChannel(channel, [&](auto& chain) {
+            chain.template setBypassed<ChainPositions::LowCut>(bypassed);
+            updateCutFilter(chain.template get<ChainPositions::LowCut>(), cutCoefficients);
+        });
+        
+       #if JUCE_USE_SIMD
+        bank.setLowCut(cutCoefficients, bypassed, channel);
+       #endif
+    }
+    
+    void setPeak(const BiquadCoefficients& peakCoefficients, bool bypassed, int channel = allChannels) {
+        forChannel(channel, [&](auto& chain) {
+            chain.template setBypassed<ChainPositions::Peak>(bypassed);
+            applyCoefficients(chain.template get<ChainPositions::Peak>(), peakCoefficients);
+        });
+        
+       #if JUCE_USE_SIMD
+        bank.setPeak(peakCoefficients, bypassed, channel);
+       #endif
+    }
+    
+    void setHighCut(const CutCoefficients& cutCoefficients, bool bypassed, int channel = allChannels) {
+        forChannel(channel, [&](auto& chain) {
+            chain.template setBypassed<ChainPositions::HighCut>(bypassed);
+            updateCutFilter(chain.template get<ChainPositions::HighCut>(), cutCoefficients);
+        });
+        
+       #if JUCE_USE_SIMD
+        bank.setHighCut(cutCoefficients, bypassed, channel);
+       #endif
+    }
+    
+    void setBank(const BankCoefficients& bankCoefficients, int channel = allChannels) {
+        forChannel(channel, [&](auto& chain) {
+            applyCoefficients(chain.template get<ChainPositions::Bank>(), bankCoefficients);
+        });
+        
+       #if JUCE_USE_SIMD
+        bank.setBank(bankCoefficients, channel);
+       #endif
+    }
+    
+    //The filters' state means left and right or mid and side, so switching starts them from rest
+    void setMidSide(bool shouldUseMidSide) {
+        if (shouldUseMidSide == midSide) {
+            return;
+        }
+        
+        midSide = shouldUseMidSide;
+        
+       #if JUCE_USE_SIMD
+        bank.setMidSide(midSide);
+       #endif
+        
+        reset();
+    }
+    
+    //Both cut filters of every chain
+    void setCascadeKernel(CascadeKernel kernel) {
+        for (auto& chain : chains) {
+            ::setCascadeKernel(chain.template get<ChainPositions::LowCut>(), kernel);
+            ::setCascadeKernel(chain.template get<ChainPositions::HighCut>(), kernel);
+        }
+        
+       #if JUCE_USE_SIMD
+        bank.setCascadeKernel(kernel);
+       #endif
+    }
+    
+    template <typename Function>
+    void forChannel(int channel, Function&& function) {
+        if (channel == allChannels) {
+            for (auto& chain : chains) {
+                function(chain);
+            }
+        } else if ((size_t) channel < chains.size()) {
+            function(chains[(size_t) channel]);
+        }
+    }
+    
+    void reset() {
+        for (auto& chain : chains) {
+            chain.reset();
+        }
+        
+       #if JUCE_USE_SIMD
+        bank.reset();
+       #endif
+        
+        if (oversampling != nullptr) {
+            oversampling->reset();
+        }
+    }
+    
+    int getLatencySamples() const {
+        return oversampling != nullptr ? juce::roundToInt(oversampling->getLatencyInSamples()) : 0;
+    }
+    
+    void process(juce::dsp::AudioBlock<SampleType>& block, bool vectorised) {
+        if (oversampling != nullptr) {
+            auto upsampled = oversampling->processSamplesUp(block);
+            processChains(upsampled, vectorised);
+            oversampling->processSamplesDown(block);
+            return;
+        }
+        
+        processChains(block, vectorised);
+    }
+    
+    void processChains(juce::dsp::AudioBlock<SampleType>& block, bool vectorised) {
+       #if JUCE_USE_SIMD
+        if (vectorised) {
+            bank.process(block);
+            return;
+        }
+       #else
+        juce::ignoreUnused(vectorised);
+       #endif
+        
+        //The reference path matrixes in passes of its own, VectorChain does it while interleaving
+        auto encodeMidSide = midSide && block.getNumChannels() >= 2;
+        if (encodeMidSide) {
+            matrixMidSide(block, (SampleType) 0.5);
+        }
+        
+        for (size_t ch = 0; ch < block.getNumChannels() && ch < chains.size(); ++ch) {
+            auto channelBlock = block.getSingleChannelBlock(ch);
+            juce::dsp::ProcessContextReplacing<SampleType> context(channelBlock);
+            chains[ch].process(context);
+        }
+        
+        if (encodeMidSide) {
+            matrixMidSide(block, (SampleType) 1);
+        }
+    }
+    
+    //(a, b) -> ((a + b) * gain, (a - b) * gain) on the first two channels, 0.5 encodes and 1 decodes
+    static void matrixMidSide(juce::dsp::AudioBlock<SampleType>& block, SampleType gain) {
+        auto* first = block.getChannelPointer(0);
+        auto* second = block.getChannelPointer(1);
+        
+        for (size_t n = 0; n < block.getNumSamples(); ++n) {
+            auto a = first[n];
+            auto b = second[n];
+            first[n] = (a + b) * gain;
+            second[n] = (a - b) * gain;
+        }
+    }
+};
+
+//The live ChannelFilters and a spare set. A preset switch makes the spare set live from rest with the new designs
+//and keeps the old set running on the same input while it fades out, so its ringing goes with it instead of
+//being cut off or carried into settings it doesn't belong to.
+//Going into or out of passthrough fades between the live set's output and the dry input over the same length.
+template <typename SampleType>
+struct CrossfadingFilters {
+    std::array<ChannelFilters<SampleType>, 2> sets;
+    size_t live {0};
+    
+    //The dry input, for the outgoing set to run on while the live set works in place
+    juce::AudioBuffer<SampleType> outgoingBuffer;
+    int fadeLength {0}, fadeRemaining {0};
+    
+    //The dry input again, for the passthrough fade, and how much of it is in the output
+    juce::AudioBuffer<SampleType> dryBuffer;
+    SampleType dryGain {0}, dryTarget {0};
+    int dryRemaining {0};
+    
+    ChannelFilters<SampleType>& getLive() { return sets[live]; }
+    const ChannelFilters<SampleType>& getLive() const { return sets[live]; }
+    ChannelFilters<SampleType>& getOutgoing() { return sets[1 - live]; }
+    
+    bool isFading() const { return fadeRemaining > 0; }
+    
+    //Not realtime safe. Both sets are prepared up front, so a switch never allocates.
+    void prepare(int numChannels, double sampleRate, int maximumBlockSize, int oversamplingOrder, int crossfadeSamples) {
+        for (auto& set : sets) {
+            set.prepare(numChannels, sampleRate, maximumBlockSize, oversamplingOrder);
+        }
+        
+        outgoingBuffer.setSize(numChannels, numChannels > 0 ? maximumBlockSize : 0);
+        dryBuffer.setSize(numChannels, numChannels > 0 ? maximumBlockSize : 0);
+        
+        //The precision that isn't in use is prepared without channels and never processes, so a fade it started
+        //would never finish and hold off every later switch
+        fadeLength = numChannels > 0 ? juce::jmax(0, crossfadeSamples) : 0;
+        fadeRemaining = 0;
+        dryGain = dryTarget = 0;
+        dryRemaining = 0;
+    }
+    
+    void setCascadeKernel(CascadeKernel kernel) {
+        for (auto& set : sets) {
+            set.setCascadeKernel(kernel);
+        }
+    }
+    
+    //Without a fade the new designs land on the live set like any other parameter change
+    void beginSwitch() {
+        if (fadeLength == 0) {
+            return;
+        }
+        
+        auto midSide = getLive().midSide;
+        live = 1 - live;
+        getLive().setMidSide(midSide);
+        getLive().reset();
+        fadeRemaining = fadeLength;
+    }
+    
+    //Starts a fade towards the dry input or back to the live set's output, from wherever the last one got to
+    void setDry(bool shouldBeDry) {
+        auto target = shouldBeDry ? (SampleType) 1 : (SampleType) 0;
+        if (target == dryTarget) {
+            return;
+        }
+        
+        dryTarget = target;
+        dryRemaining = (int) std::ceil(std::abs(dryTarget - dryGain) * (SampleType) fadeLength);
+        if (dryRemaining == 0 || dryBuffer.getNumSamples() == 0) {
+            dryGain = dryTarget;
+            dryRemaining = 0;
+        }
+    }
+    
+    //Fully faded to the dry input, the filters needn't run
+    bool isDry() const { return dryRemaining == 0 && dryGain == (SampleType) 1; }
+    
+    //Before the live set runs in place
+    void beginBlock(const juce::dsp::AudioBlock<SampleType>& block) {
+        if (isFading()) {
+            auto numFading = getNumFading(block);
+            getOutgoingBlock(block, numFading).copyFrom(block.getSubBlock(0, numFading));
+        }
+        if (dryRemaining > 0) {
+            auto numDry = getNumDry(block);
+            getDryBlock(block, numDry).copyFrom(block.getSubBlock(0, numDry));
+        }
+    }
+    
+    //After the live set has run on block. Both sets filtered the same input, so their outputs are correlated
+    //and a linear fade keeps the level flat.
+    void endBlock(juce::dsp::AudioBlock<SampleType>& block, bool vectorised) {
+        endSwitchFade(block, vectorised);
+        endDryFade(block);
+    }
+    
+    void endSwitchFade(juce::dsp::AudioBlock<SampleType>& block, bool vectorised) {
+        if (! isFading()) {
+            return;
+        }
+        
+        auto numFading = getNumFading(block);
+        if (numFading == 0) {
+            fadeRemaining = 0;
+            return;
+        }
+        
+        auto outgoing = getOutgoingBlock(block, numFading);
+        getOutgoing().process(outgoing, vectorised);
+        
+        //A block longer than the outgoing buffer finishes the fade within the part of it that fits
+        auto endsEarly = numFading < block.getNumSamples() && numFading < (size_t) fadeRemaining;
+        auto startGain = (SampleType) (fadeLength - fadeRemaining) / (SampleType) fadeLength;
+        auto step = endsEarly ? ((SampleType) 1 - startGain) / (SampleType) numFading : (SampleType) 1 / (SampleType) fadeLength;
+        
+        for (size_t ch = 0; ch < block.getNumChannels(); ++ch) {
+            auto* incoming = block.getChannelPointer(ch);
+            auto* fadingOut = outgoing.getChannelPointer(ch);
+            auto gain = startGain;
+            
+            for (size_t n = 0; n < numFading; ++n) {
+                gain += step;
+                incoming[n] = fadingOut[n] + gain * (incoming[n] - fadingOut[n]);
+            }
+        }
+        
+        fadeRemaining = endsEarly ? 0 : fadeRemaining - (int) numFading;
+    }
+    
+    //The rest of a block after a fade to dry is the dry input. A block longer than the dry buffer lands on the
+    //target where the buffer ends.
+    void endDryFade(juce::dsp::AudioBlock<SampleType>& block) {
+        if (dryRemaining == 0) {
+            return;
+        }
+        
+        auto numDry = getNumDry(block);
+        auto numMixing = juce::jmin(numDry, (size_t) dryRemaining);
+        auto dry = getDryBlock(block, numDry);
+        auto step = (dryTarget - dryGain) / (SampleType) dryRemaining;
+        
+        for (size_t ch = 0; ch < block.getNumChannels(); ++ch) {
+            auto* wet = block.getChannelPointer(ch);
+            auto* input = dry.getChannelPointer(ch);
+            auto gain = dryGain;
+            
+            for (size_t n = 0; n < numMixing; ++n) {
+                gain += step;
+                wet[n] += gain * (input[n] - wet[n]);
+            }
+            for (size_t n = numMixing; n < numDry; ++n) {
+                wet[n] = input[n];
+            }
+        }
+        
+        dryRemaining = numMixing < block.getNumSamples() ? 0 : dryRemaining - (int) numMixing;
+        dryGain = dryRemaining == 0 ? dryTarget : dryGain + step * (SampleType) numMixing;
+    }
+    
+    //Samples still fading, and after a fade to dry the rest of the block too
+    size_t getNumDry(const juce::dsp::AudioBlock<SampleType>& block) const {
+        auto numNeeded = dryTarget == (SampleType) 1 ? block.getNumSamples() : (size_t) dryRemaining;
+        return juce::jmin(block.getNumSamples(), numNeeded, (size_t) dryBuffer.getNumSamples());
+    }
+    
+    juce::dsp::AudioBlock<SampleType> getDryBlock(const juce::dsp::AudioBlock<SampleType>& block, size_t numSamples) {
+        return juce::dsp::AudioBlock<SampleType>(dryBuffer).getSubsetChannelBlock(0, block.getNumChannels()).getSubBlock(0, numSamples);
+    }
+    
+    //Only the samples still fading need the outgoing set, and no more of them than the buffer holds
+    size_t getNumFading(const juce::dsp::AudioBlock<SampleType>& block) const {
+        return juce::jmin(block.getNumSamples(), (size_t) fadeRemaining, (size_t) outgoingBuffer.getNumSamples());
+    }
+    
+    juce::dsp::AudioBlock<SampleType> getOutgoingBlock(const juce::dsp::AudioBlock<SampleType>& block, size_t numSamples) {
+        jassert(block.getNumChannels() <= (size_t) outgoingBuffer.getNumChannels() && numSamples <= (size_t) outgoingBuffer.getNumSamples());
+        return juce::dsp::AudioBlock<SampleType>(outgoingBuffer).getSubsetChannelBlock(0, block.getNumChannels()).getSubBlock(0, numSamples);
+    }
 };
 
 //==============================================================================
 /**
 */
-class SimpleEQAudioProcessor  : public juce::AudioProcessor
+class SimpleEQAudioProcessor  : public juce::AudioProcessor,
+                                private juce::AudioProcessorValueTreeState::Listener,
+                                private juce::Timer
 {
 public:
     //==============================================================================
@@ -59,6 +568,10 @@ public:
    #endif
 
     void processBlock (juce::AudioBuffer<float>&, juce::MidiBuffer&) override;
+    void processBlock (juce::AudioBuffer<double>&, juce::MidiBuffer&) override;
+    
+    //The whole chain runs in double when the host asks for it, for low cutoffs at high sample rates
+    bool supportsDoublePrecisionProcessing() const override { return true; }
 
     //==============================================================================
     juce::AudioProcessorEditor* createEditor() override;
@@ -73,6 +586,7 @@ public:
     double getTailLengthSeconds() const override;
 
     //==============================================================================
+    //The loaded preset bank's presets, or a single unnamed program without one
     int getNumPrograms() override;
     int getCurrentProgram() override;
     void setCurrentProgram (int index) override;
@@ -85,51 +599,278 @@ public:
     
     static juce::AudioProcessorValueTreeState::ParameterLayout createParameterLayout();
     juce::AudioProcessorValueTreeState apvts{*this, nullptr, "Parameters", createParameterLayout()};
+    
+    //What the audio thread reads the parameters through
+    const ChainParameters chainParameters {apvts};
+    
+    //Takes effect on the next prepareToPlay, a budget of 0 turns the cache off
+    void setCoefficientCacheBudget(size_t budgetBytes, CoefficientCache::Prefill prefill);
+    CoefficientCache::Stats getCoefficientCacheStats() const { return coefficientCache.getStats(); }
+    
+    enum class ProcessingEngine {
+        scalar,     //One MonoChain per channel, the reference path
+        vectorised  //Channels packed numLanes at a time into VectorChains where SIMD is available
+    };
+    
+    void setProcessingEngine(ProcessingEngine engine) { processingEngine = engine; }
+    ProcessingEngine getProcessingEngine() const { return processingEngine; }
+    
+    //How the low and high cuts run, see StageCascade. Automatic switches a settled cut of 48 dB/oct or steeper to
+    //the block state-space kernel; sample accurate automation always runs per sample, the block kernel's blocks
+    //would start wherever a buffer does. Takes effect on the next prepareToPlay.
+    void setCutKernel(CascadeKernel kernel) { cutKernel = kernel; }
+    CascadeKernel getCutKernel() const { return cutKernel; }
+    
+    //Largest absolute difference between the vectorised and scalar engines on a stereo noise burst
+    static float measureEngineDifference(const ChainSettings& chainSettings, double sampleRate, int numSamples = 4096);
+    static constexpr float defaultEngineTolerance = 1.0e-4f;
+    static bool vectorisedEngineMatchesScalar(const ChainSettings& chainSettings, double sampleRate, float tolerance = defaultEngineTolerance) {
+        return measureEngineDifference(chainSettings, sampleRate) <= tolerance;
+    }
+    
+    //Block timings, callback load and redesign counts, safe to poll from any thread but the audio thread
+    CallbackMonitor::Stats getCallbackStats() const { return callbackMonitor.getStats(); }
+    void resetCallbackStats() { callbackMonitor.resetStats(); }
+    void setInstrumentationEnabled(bool enabled) { callbackMonitor.setEnabled(enabled); }
+    
+    enum class PhaseMode {
+        minimum,    //The IIR chains, no latency
+        linear      //A symmetric FIR of the same magnitude response, with firLength / 2 samples of latency
+    };
+    
+    //Takes effect on the next prepareToPlay, which reports the new latency to the host
+    void setPhaseMode(PhaseMode mode, LinearPhaseEQ::Quality quality = LinearPhaseEQ::Quality::standard);
+    PhaseMode getPhaseMode() const { return phaseMode; }
+    
+    //1, 2, 4 or 8. Takes effect on the next prepareToPlay, which reports the filters' latency to the host.
+    //Linear phase mode always runs at the host rate.
+    void setOversamplingFactor(int factor);
+    int getOversamplingFactor() const { return 1 << oversamplingOrder.load(); }
+    
+    //The rate the filters are designed for and run at, the host rate times the oversampling factor
+    double getProcessingSampleRate() const { return processingSampleRate; }
+    
+    //Pre/post spectrum, only fed while an editor has it active
+    SpectrumAnalyzer& getSpectrumAnalyzer() { return spectrumAnalyzer; }
+    
+    //Changes whenever a parameter of the band does, so views can redraw only what moved
+    juce::uint32 getBandGeneration(int band) const { return bandGenerations[(size_t) band].load(std::memory_order_acquire); }
+    
+    //The stereo mode the bands run in with these settings, linked unless the main bus is stereo.
+    //A different bus layout moves every band's generation.
+    StereoMode getEffectiveStereoMode (const ChainSettings& chainSettings) const;
+    
+    //Ramps frequency, gain and Q inside the block and redesigns the moving bands every subBlockSize samples.
+    //The ramp time and sub-block size take effect on the next prepareToPlay, turning it on or off on the next block.
+    //Turned off mid-ramp, the bands jump to their targets.
+    void setParameterSmoothing(bool enabled, int subBlockSize = 32, double rampSeconds = 0.05);
+    bool isParameterSmoothingEnabled() const { return smoothingEnabled; }
+    
+    //Lands parameter changes on a grid of gridSize samples counted from prepareToPlay rather than at the start of
+    //whichever block they arrive in, so a render comes out bit-identical at any buffer size. Only the bands that changed
+    //are redesigned at a grid line, the rest of the cascade runs straight through it. The fast paths are off in this
+    //mode, the smoothers step once per grid line and dynamic bands key on the slice before a line rather than the one
+    //after it. Linear phase mode isn't affected. Takes effect on the next prepareToPlay.
+    void setSampleAccurateAutomation(bool enabled, int gridSize = 32);
+    bool isSampleAccurateAutomationEnabled() const { return sampleAccurateEnabled; }
+    
+    //JUCE's plugin wrappers hand a host's automation over at the start of the block, so changes from them, and from any
+    //other thread, land on the next grid line. A host that drives the processor directly can schedule them instead:
+    //each lands on the first grid line at or after samplePosition, counted from prepareToPlay, or at the start of its
+    //block without sample accurate automation. One thread at a time, in position order, after prepareToPlay.
+    //The audio thread only redesigns from them, the host and the parameter listeners hear about them on the message
+    //thread. False if the parameter is unknown or the queue is full.
+    bool scheduleParameterChange(const juce::String& parameterID, float value, juce::int64 samplePosition);
+    juce::int64 getSamplePosition() const { return samplePosition.load(std::memory_order_relaxed); }
+    
+    //Programs, snapshots and setStateInformation all switch the same way: the new designs are made on the calling
+    //thread and the audio thread crossfades from the running filters to a fresh set with them. With sample accurate
+    //automation the crossfade starts on the first grid line after the switch is published, so a switch made between
+    //two blocks renders the same at any buffer size that has a block boundary there.
+    //Not realtime safe, any thread but the audio thread.
+    bool loadPresetBank(const juce::File& file);
+    bool savePresetBank(const juce::File& file) const;
+    void addPreset(const juce::String& name);
+    
+    //A, B, C and D, in memory only
+    static constexpr int numSnapshots = 4;
+    void storeSnapshot(int slot);
+    bool recallSnapshot(int slot);
+    bool hasSnapshot(int slot) const;
+    
+    //Takes effect on the next prepareToPlay, 0 lands a switch on the running filters without a crossfade.
+    //Also the length of the fade into and out of passthrough.
+    void setPresetCrossfade(double seconds);
 
 private:
     
-    MonoChain leftChain, rightChain;
+    //Only the precision the host is using gets prepared, the other stays empty
+    CrossfadingFilters<float> floatFilters;
+    CrossfadingFilters<double> doubleFilters;
     
-    void updatePeakFilter(const ChainSettings& chainSettings);
-    using Coefficients = Filter::CoefficientsPtr;
-    static void updateCoefficients(Coefficients& old, const Coefficients& replacements);
+    std::atomic<ProcessingEngine> processingEngine {ProcessingEngine::vectorised};
+    std::atomic<CascadeKernel> cutKernel {CascadeKernel::automatic};
     
-    template<int Index, typename ChainType, typename CoefficientType>
-    void updateSwitchCase(ChainType& chain, const CoefficientType& coefficients) {
-        updateCoefficients(chain.template get<Index>().coefficients, coefficients[Index]);
-        chain.template setBypassed<Index>(false);
-    }
+    //Up to 7.1.4 and the 16 channel ambisonic/Atmos bed layouts
+    static constexpr int maxChannels = 16;
     
-    template <typename ChainType, typename CoefficientType>
-    void updateCutFilter(ChainType& leftLC, const CoefficientType& cutCoefficients, const Slope& lcSlope) {
-        leftLC.template setBypassed<0>(true);
-        leftLC.template setBypassed<1>(true);
-        leftLC.template setBypassed<2>(true);
-        leftLC.template setBypassed<3>(true);
-        
-        switch(lcSlope) {
-            case Slope_48: {
-                updateSwitchCase<3>(leftLC, cutCoefficients);
-            }
-            break;
-            case Slope_36: {
-                updateSwitchCase<2>(leftLC, cutCoefficients);
-            }
-            break;
-            case Slope_24: {
-                updateSwitchCase<1>(leftLC, cutCoefficients);
-            }
-            break;
-            case Slope_12: {
-                updateSwitchCase<0>(leftLC, cutCoefficients);
-            }
-            break;
-        }
-    }
+    //Bumped by parameterChanged() from any thread, compared against on the audio thread
+    std::array<std::atomic<juce::uint32>, numBands> bandGenerations {};
+    std::array<juce::uint32, numBands> appliedGenerations {};
+    
+    CoefficientCache coefficientCache;
+    std::atomic<size_t> cacheBudgetBytes {CoefficientCache::defaultBudgetBytes};
+    std::atomic<CoefficientCache::Prefill> cachePrefill {CoefficientCache::Prefill::none};
+    
+    CallbackMonitor callbackMonitor;
+    SpectrumAnalyzer spectrumAnalyzer;
+    
+    std::atomic<PhaseMode> phaseMode {PhaseMode::minimum};
+    std::atomic<LinearPhaseEQ::Quality> linearPhaseQuality {LinearPhaseEQ::Quality::standard};
+    std::atomic<bool> linearPhaseActive {false};
+    
+    std::atomic<int> oversamplingOrder {0};
+    std::atomic<double> processingSampleRate {44100.0};
+    LinearPhaseEQ linearPhaseEQ {[this](double sampleRate) { return makeLinearPhaseCoefficients(sampleRate); }};
     
-    void updateLCFilters (const ChainSettings& chainSettings);
-    void updateHCFilters (const ChainSettings& chainSettings);
+    //Pool thread. Each channel's chain the way updateChannels hands them out, for linear phase to design its FIRs from.
+    LinearPhaseEQ::ChannelCoefficients makeLinearPhaseCoefficients (double sampleRate) const;
+    
+    void parameterChanged(const juce::String& parameterID, float newValue) override;
+    void markAllBandsDirty();
+    std::array<bool, numBands> consumeDirtyBands();
+    
+    std::atomic<bool> smoothingEnabled {false};
+    std::atomic<int> smoothingSubBlockSize {32};
+    std::atomic<double> smoothingRampSeconds {0.05};
+    size_t activeSubBlockSize {32};
+    bool wasSmoothing {false};
+    
+    juce::SmoothedValue<float, juce::ValueSmoothingTypes::Multiplicative> lcFreqSmoother, hcFreqSmoother, peakFreqSmoother, peakQSmoother;
+    juce::SmoothedValue<float, juce::ValueSmoothingTypes::Linear> peakGainSmoother;
+    
+    void resetSmoothers(const ChainSettings& chainSettings);
+    void setSmootherTargets(const ChainSettings& targets, bool smoothing);
+    void snapSmoothers(bool wereMoving);
+    void markDynamicBandsDirty();
+    
+    //Steps the smoothers by length, adds the dynamics' gains and redesigns the bands that moved or are dirty
+    void designSlice(const ChainSettings& targets, const ChainSettings& secondTargets, size_t length,
+                     const std::array<bool, numBands>& dirty, bool dynamic);
+    
+    std::atomic<bool> sampleAccurateEnabled {false};
+    std::atomic<int> sampleAccurateGridSize {32};
+    bool sampleAccurateActive {false};
+    juce::int64 automationGrid {32};
+    std::atomic<juce::int64> samplePosition {0};
+    
+    //The settings the last grid line designed from, re-read only when a band is dirty
+    ChainSettings gridTargets, gridSecondTargets;
+    
+    struct ScheduledChange {
+        juce::int64 samplePosition;
+        int parameterIndex;
+        float normalisedValue;
+    };
+    
+    static constexpr int scheduledChangeQueueSize = 1024;
+    juce::AbstractFifo scheduledChanges {scheduledChangeQueueSize};
+    std::array<ScheduledChange, scheduledChangeQueueSize> scheduledChangeSlots {};
+    
+    void applyScheduledChanges(juce::int64 lastPosition);
+    
+    //Scheduled changes the host and the tree state haven't been told about yet, one flag per rangedParameters entry
+    std::vector<std::atomic<bool>> hostNotificationsPending;
+    std::vector<std::atomic<float>*> treeStateValues;
+    void timerCallback() override;
+    
+    template <typename SampleType>
+    void processBlockT(juce::AudioBuffer<SampleType>& buffer, CrossfadingFilters<SampleType>& crossfadingFilters);
+    template <typename SampleType>
+    void processSmoothed(juce::dsp::AudioBlock<SampleType>& block, const juce::dsp::AudioBlock<SampleType>& key,
+                         ChannelFilters<SampleType>& filters, bool smoothing);
+    template <typename SampleType>
+    void processSampleAccurate(juce::dsp::AudioBlock<SampleType>& block, const juce::dsp::AudioBlock<SampleType>& key,
+                               CrossfadingFilters<SampleType>& crossfadingFilters, bool smoothing);
+    
+    //Set up from the parameters in refreshFastPaths(), run from processSmoothed()
+    DynamicsDetector dynamicsDetector;
+    bool useSidechain {false};
+    
+    //quantised designs go through the coefficient cache, smoothed ramps are designed exactly.
+    //channel picks the one channel to update, by default every channel shares the design.
+    void updatePeakFilter(const ChainSettings& chainSettings, bool quantised = true, int channel = ChannelFilters<float>::allChannels);
+    
+    void updateLCFilters (const ChainSettings& chainSettings, bool quantised = true, int channel = ChannelFilters<float>::allChannels);
+    void updateHCFilters (const ChainSettings& chainSettings, bool quantised = true, int channel = ChannelFilters<float>::allChannels);
+    void updateBankFilters (const ChainSettings& chainSettings, int channel = ChannelFilters<float>::allChannels);
+    
+    //Calls update(settings, channel) once in linked mode, otherwise once per channel with that channel's settings.
+    //Also switches the filters between left/right and mid/side when the mode has changed.
+    template <typename Update>
+    void updateChannels (const ChainSettings& first, const ChainSettings& second, Update&& update);
+    
+    //The stereo mode the filters are running in, linked unless the main bus is stereo
+    StereoMode activeStereoMode {StereoMode::linked};
+    int numMainChannels {2};
+    
+    ChainSettings getSecondSettingsIfSplit (const ChainSettings& first) const;
     void updateAllFilters ();
+    void updateDirtyFilters ();
+    void applyParameterChanges ();
+    
+    //Fast paths, refreshed whenever a band's generation moves
+    std::array<juce::uint32, numBands> fastPathGenerations {};
+    bool chainIsNeutral {false};
+    bool wasPassthrough {false};
+    bool wasIdle {false};
+    juce::int64 tailFlushSamples {0};
+    juce::int64 silentSamples {0};
+    
+    void refreshFastPaths (bool force = false);
+    
+    //What each channel's bands have installed, for the ring-out the sleeping path waits for. tailFlushSamples is
+    //worked out from them only while the input is silent, and again only after something was redesigned.
+    std::array<ChainCoefficients, 2> installedCoefficients;
+    bool tailStale {true};
+    
+    template <typename Function>
+    void recordInstalled (int channel, Function&& function);
+    void updateTailFlushSamples ();
+    
+    //Every ranged parameter in layout order, which is the order presets and snapshots keep their values in
+    std::vector<juce::RangedAudioParameter*> rangedParameters;
+    juce::StringArray parameterIDs;
+    
+    //Guards the bank, the snapshots and the switching thread's side of the hand over
+    juce::CriticalSection presetLock;
+    PresetBank presetBank;
+    std::vector<int> presetBankMapping;     //Each bank value's index in rangedParameters, -1 for ones we don't have
+    int currentProgram {0};
+    std::array<std::vector<float>, numSnapshots> snapshots;
+    std::atomic<double> presetCrossfadeSeconds {0.02};
+    
+    //A switch's designs, made on the switching thread and read in place by the audio thread
+    struct PreparedSwitch {
+        ChainSettings first, second;
+        ChainCoefficients firstCoefficients, secondCoefficients;
+        std::array<juce::uint32, numBands> generations {};
+        double sampleRate {0.0};
+    };
+    
+    //idle -> writing -> ready on the switching thread, ready -> reading -> idle on the audio thread.
+    //The audio thread never waits: a switch it can't take yet stays ready, and a newer one replaces it.
+    enum class SwitchState { idle, writing, ready, reading };
+    PreparedSwitch preparedSwitch;
+    std::atomic<SwitchState> switchState {SwitchState::idle};
+    std::atomic<int> switchesInProgress {0};
+    
+    std::vector<float> captureParameterValues() const;
+    void applyParameterValues(const std::vector<float>& values, const std::vector<int>* mapping);
+    void switchParameters(const std::function<void()>& changeParameters);
+    bool takePendingSwitch();
+    bool isWaitingForSwitch() const;
+    void setChainCoefficients(const ChainCoefficients& chainCoefficients, const ChainSettings& chainSettings, int channel);
     
     //==============================================================================
     
@@ -0,0 +1,160 @@
+/*
+  ==============================================================================
+
+    PresetBank.cpp
+
+  ==============================================================================
+*/
+
+#include "PresetBank.h"
+
+static constexpr char bankMagic[4] { 'S', 'E', 'Q', 'B' };
+
+//Reads straight out of the stream's memory, which is the mapped file when loading
+static bool readString(juce::MemoryInputStream& stream, juce::String& string) {
+    if (stream.getNumBytesRemaining() < 2) {
+        return false;
+    }
+
+    auto length = (int) (juce::uint16) stream.readShort();
+    if (stream.getNumBytesRemaining() < length) {
+        return false;
+    }
+
+    string = juce::String::fromUTF8(static_cast<const char*>(stream.getData()) + stream.getPosition(), length);
+    stream.skipNextBytes(length);
+    return true;
+}
+
+static bool writeString(juce::OutputStream& stream, const juce::String& string) {
+    auto length = string.getNumBytesAsUTF8();
+    if (length > 0xffff) {
+        jassertfalse;
+        return false;
+    }
+
+    return stream.writeShort((short) length) && stream.write(string.toRawUTF8(), length);
+}
+
+void PresetBank::addPreset(const juce::String& name, std::vector<float> values) {
+    jassert(values.size() == (size_t) parameterIDs.size());
+    presets.push_back({ name, std::move(values) });
+}
+
+void PresetBank::renamePreset(int index, const juce::String& newName) {
+    if (juce::isPositiveAndBelow(index, getNumPresets())) {
+        presets[(size_t) index].name = newName;
+    }
+}
+
+void PresetBank::removePreset(int index) {
+    if (juce::isPositiveAndBelow(index, getNumPresets())) {
+        presets.erase(presets.begin() + index);
+    }
+}
+
+bool PresetBank::read(const void* data, size_t numBytes) {
+    juce::MemoryInputStream stream(data, numBytes, false);
+
+    char magic[4] {};
+    if (stream.read(magic, 4) != 4 || std::memcmp(magic, bankMagic, 4) != 0 || stream.getNumBytesRemaining() < 12) {
+        return false;
+    }
+
+    auto version = (juce::uint32) stream.readInt();
+    auto numParameters = (juce::uint32) stream.readInt();
+    auto numPresets = (juce::uint32) stream.readInt();
+
+    //Every ID takes at least its length, every preset its name's length and its values
+    auto valueBytes = (juce::uint64) numParameters * sizeof(float);
+    if (version == 0 || version > currentVersion || (juce::uint64) numParameters * 2 > (juce::uint64) stream.getNumBytesRemaining()
+        || (juce::uint64) numPresets * (2 + valueBytes) > (juce::uint64) stream.getNumBytesRemaining()) {
+        return false;
+    }
+
+    juce::StringArray newParameterIDs;
+    newParameterIDs.ensureStorageAllocated((int) numParameters);
+
+    for (juce::uint32 i = 0; i < numParameters; ++i) {
+        juce::String parameterID;
+        if (! readString(stream, parameterID)) {
+            return false;
+        }
+        newParameterIDs.add(parameterID);
+    }
+
+    std::vector<Preset> newPresets(numPresets);
+
+    for (auto& preset : newPresets) {
+        if (! readString(stream, preset.name) || (juce::uint64) stream.getNumBytesRemaining() < valueBytes) {
+            return false;
+        }
+
+        preset.values.resize(numParameters);
+        std::memcpy(preset.values.data(), static_cast<const char*>(stream.getData()) + stream.getPosition(), (size_t) valueBytes);
+        stream.skipNextBytes((juce::int64) valueBytes);
+
+       #if JUCE_BIG_ENDIAN
+        for (auto& value : preset.values) {
+            juce::uint32 bits;
+            std::memcpy(&bits, &value, sizeof(bits));
+            bits = juce::ByteOrder::swap(bits);
+            std::memcpy(&value, &bits, sizeof(bits));
+        }
+       #endif
+    }
+
+    parameterIDs = std::move(newParameterIDs);
+    presets = std::move(newPresets);
+    return true;
+}
+
+bool PresetBank::write(juce::OutputStream& stream) const {
+    auto ok = stream.write(bankMagic, 4)
+           && stream.writeInt((int) currentVersion)
+           && stream.writeInt(parameterIDs.size())
+           && stream.writeInt((int) presets.size());
+
+    for (auto& parameterID : parameterIDs) {
+        ok = ok && writeString(stream, parameterID);
+    }
+
+    for (auto& preset : presets) {
+        ok = ok && writeString(stream, preset.name);
+
+        for (auto value : preset.values) {
+            ok = ok && stream.writeFloat(value);
+        }
+    }
+
+    return ok;
+}
+
+bool PresetBank::load(const juce::File& file) {
+    juce::MemoryMappedFile mappedFile(file, juce::MemoryMappedFile::readOnly);
+
+    if (mappedFile.getData() == nullptr) {
+        return false;
+    }
+
+    return read(mappedFile.getData(), mappedFile.getSize());
+}
+
+bool PresetBank::save(const juce::File& file) const {
+    //Written next to the target and moved over it, so a failed save leaves the old bank intact
+    juce::TemporaryFile temporaryFile(file);
+
+    {
+        juce::FileOutputStream stream(temporaryFile.getFile());
+        if (! stream.openedOk() || ! write(stream)) {
+            return false;
+        }
+
+        stream.flush();
+        if (stream.getStatus().failed()) {
+            return false;
+        }
+    }
+
+    return temporaryFile.overwriteTargetFileWithTemporary();
+}
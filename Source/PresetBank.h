@@ -0,0 +1,64 @@
+/*
+  ==============================================================================
+
+    PresetBank.h
+
+    Named presets as plain parameter values, and the compact binary file a
+    bank of them is stored in. The parameter IDs are listed once in the
+    header and every preset after it is a name and one float per parameter,
+    so a bank of a few hundred presets is memory mapped and read in a single
+    pass, the values of each preset in one copy.
+
+    Layout, all little endian
+        char[4]     "SEQB"
+        uint32      version, currently 1
+        uint32      numParameters
+        uint32      numPresets
+        numParameters x { uint16 length, UTF-8 parameter ID }
+        numPresets x    { uint16 length, UTF-8 name, numParameters x float32 }
+
+    Values are plain rather than normalised, so a bank survives a parameter's
+    range changing. Whoever applies a preset maps the bank's IDs onto its own
+    parameters, which lets banks survive parameters being added or removed.
+
+  ==============================================================================
+*/
+
+#pragma once
+
+#include <JuceHeader.h>
+
+class PresetBank {
+public:
+    static constexpr juce::uint32 currentVersion = 1;
+
+    struct Preset {
+        juce::String name;
+        std::vector<float> values;  //One per parameter ID, in the bank's order
+    };
+
+    PresetBank() = default;
+    explicit PresetBank(juce::StringArray parameterIDsToUse) : parameterIDs(std::move(parameterIDsToUse)) {}
+
+    const juce::StringArray& getParameterIDs() const { return parameterIDs; }
+
+    int getNumPresets() const { return (int) presets.size(); }
+    const Preset& getPreset(int index) const { return presets[(size_t) index]; }
+
+    //values needs one entry per parameter ID
+    void addPreset(const juce::String& name, std::vector<float> values);
+    void renamePreset(int index, const juce::String& newName);
+    void removePreset(int index);
+
+    //Not realtime safe. Leaves the bank as it was on anything truncated, malformed or from a newer version.
+    bool read(const void* data, size_t numBytes);
+    bool write(juce::OutputStream& stream) const;
+
+    //The file is memory mapped rather than read into a copy first
+    bool load(const juce::File& file);
+    bool save(const juce::File& file) const;
+
+private:
+    juce::StringArray parameterIDs;
+    std::vector<Preset> presets;
+};
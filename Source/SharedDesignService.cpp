@@ -0,0 +1,300 @@
+/*
+  ==============================================================================
+
+    SharedDesignService.cpp
+
+  ==============================================================================
+*/
+
+#include "SharedDesignService.h"
+#include "LinearPhaseEQ.h"
+
+static juce::uint64 hashKey(juce::uint64 key) {
+    //splitmix64 finaliser, spreads neighbouring frequencies across the table
+    key ^= key >> 30;
+    key *= 0xbf58476d1ce4e5b9ULL;
+    key ^= key >> 27;
+    key *= 0x94d049bb133111ebULL;
+    key ^= key >> 31;
+    return key;
+}
+
+static bool sameBiquad(const BiquadCoefficients& a, const BiquadCoefficients& b) {
+    return a.b0 == b.b0 && a.b1 == b.b1 && a.b2 == b.b2 && a.a1 == b.a1 && a.a2 == b.a2;
+}
+
+static bool sameCut(const CutCoefficients& a, const CutCoefficients& b) {
+    if (a.numStages != b.numStages) {
+        return false;
+    }
+
+    for (int stage = 0; stage < a.numStages; ++stage) {
+        if (! sameBiquad(a.stages[(size_t) stage], b.stages[(size_t) stage])) {
+            return false;
+        }
+    }
+
+    return true;
+}
+
+//Compared field by field, the structs have padding that a memcmp would trip over
+static bool sameChain(const ChainCoefficients& a, const ChainCoefficients& b) {
+    if (a.lcBypassed != b.lcBypassed || a.pdBypassed != b.pdBypassed || a.hcBypassed != b.hcBypassed
+        || ! sameCut(a.lowCut, b.lowCut) || ! sameCut(a.highCut, b.highCut) || ! sameBiquad(a.peak, b.peak)) {
+        return false;
+    }
+
+    for (size_t band = 0; band < (size_t) maxBankBands; ++band) {
+        if (a.bank.active[band] != b.bank.active[band]
+            || (a.bank.active[band] && ! sameBiquad(a.bank.bands[band], b.bank.bands[band]))) {
+            return false;
+        }
+    }
+
+    return true;
+}
+
+//==============================================================================
+size_t SharedCoefficientTable::getNumEntriesForBudget(size_t budgetBytes) {
+    size_t numEntries = 0;
+    auto maxEntries = budgetBytes / sizeof(Entry);
+
+    if (maxEntries > 0) {
+        numEntries = 1;
+        while (numEntries * 2 <= maxEntries) {
+            numEntries *= 2;
+        }
+    }
+
+    return numEntries;
+}
+
+SharedCoefficientTable::SharedCoefficientTable(double rate, size_t budgetBytes, Designer designerToUse)
+    : sampleRate(rate), designer(designerToUse), numEntries(juce::jmax((size_t) 1, getNumEntriesForBudget(budgetBytes))),
+      mask((juce::uint64) numEntries - 1), entries(new Entry[numEntries]) {
+}
+
+SharedCoefficientTable::Entry& SharedCoefficientTable::getEntry(juce::uint64 key) const {
+    return entries[(size_t) (hashKey(key) & mask)];
+}
+
+bool SharedCoefficientTable::read(juce::uint64 key, CutCoefficients& coefficients) const {
+    auto& entry = getEntry(key);
+
+    auto before = entry.sequence.load(std::memory_order_acquire);
+    if ((before & 1) != 0 || entry.key.load(std::memory_order_relaxed) != key) {
+        return false;
+    }
+
+    std::array<juce::uint64, numWords> words;
+    for (size_t i = 0; i < numWords; ++i) {
+        words[i] = entry.words[i].load(std::memory_order_relaxed);
+    }
+
+    //Nothing read above may move past the second look at the sequence
+    std::atomic_thread_fence(std::memory_order_acquire);
+    if (entry.sequence.load(std::memory_order_relaxed) != before) {
+        return false;
+    }
+
+    std::memcpy(&coefficients, words.data(), sizeof(CutCoefficients));
+    return true;
+}
+
+bool SharedCoefficientTable::contains(juce::uint64 key) const {
+    return getEntry(key).key.load(std::memory_order_acquire) == key;
+}
+
+bool SharedCoefficientTable::publish(juce::uint64 key, const CutCoefficients& coefficients, bool onlyIntoEmpty) {
+    auto& entry = getEntry(key);
+
+    auto before = entry.sequence.load(std::memory_order_relaxed);
+    if ((before & 1) != 0 || ! entry.sequence.compare_exchange_strong(before, before + 1, std::memory_order_acquire)) {
+        return false;
+    }
+
+    //Nothing was written, so readers that saw the odd sequence can keep what they read
+    if (onlyIntoEmpty && entry.key.load(std::memory_order_relaxed) != emptyKey) {
+        entry.sequence.store(before, std::memory_order_release);
+        return false;
+    }
+
+    //Keeps the writes below from moving ahead of the sequence going odd
+    std::atomic_thread_fence(std::memory_order_release);
+
+    std::array<juce::uint64, numWords> words {};
+    std::memcpy(words.data(), &coefficients, sizeof(CutCoefficients));
+
+    entry.key.store(key, std::memory_order_relaxed);
+    for (size_t i = 0; i < numWords; ++i) {
+        entry.words[i].store(words[i], std::memory_order_relaxed);
+    }
+
+    entry.sequence.store(before + 2, std::memory_order_release);
+    return true;
+}
+
+bool SharedCoefficientTable::fulfil(juce::uint64 key) {
+    if (contains(key)) {
+        return false;
+    }
+
+    publish(key, designer(sampleRate, key));
+    return true;
+}
+
+//==============================================================================
+SharedDesignService::SharedDesignService()
+    : juce::Thread("SimpleEQ shared design"),
+      pool(juce::jlimit(1, 2, juce::SystemStats::getNumCpus() / 4)) {
+    startThread();
+}
+
+SharedDesignService::~SharedDesignService() {
+    //Every client has removed itself by now, each instance holds the service for as long as it has any
+    jassert(clients.isEmpty());
+    stopThread(2000);
+}
+
+void SharedDesignService::addClient(Client& client) {
+    {
+        const juce::ScopedLock lock(clientsLock);
+        clients.addIfNotAlreadyThere(&client);
+    }
+    notify();
+}
+
+void SharedDesignService::removeClient(Client& client) {
+    //The service thread holds the lock for the whole of a tick, so once this returns client isn't visited again
+    const juce::ScopedLock lock(clientsLock);
+    clients.removeFirstMatchingValue(&client);
+}
+
+std::shared_ptr<SharedCoefficientTable> SharedDesignService::getCoefficientTable(double sampleRate, size_t budgetBytes,
+                                                                                 SharedCoefficientTable::Designer designer) {
+    auto numEntries = SharedCoefficientTable::getNumEntriesForBudget(budgetBytes);
+    if (numEntries == 0) {
+        return {};
+    }
+
+    const juce::ScopedLock lock(tablesLock);
+
+    tables.erase(std::remove_if(tables.begin(), tables.end(), [](auto& table) { return table.expired(); }), tables.end());
+
+    for (auto& weakTable : tables) {
+        auto table = weakTable.lock();
+        if (table != nullptr && table->getSampleRate() == sampleRate) {
+            if (table->getNumEntries() >= numEntries) {
+                return table;
+            }
+
+            //Instances still on the smaller table keep it until their next prepare
+            auto larger = std::make_shared<SharedCoefficientTable>(sampleRate, budgetBytes, designer);
+            weakTable = larger;
+            return larger;
+        }
+    }
+
+    auto table = std::make_shared<SharedCoefficientTable>(sampleRate, budgetBytes, designer);
+    tables.push_back(table);
+    return table;
+}
+
+void SharedDesignService::fulfil(SharedCoefficientTable& table, juce::uint64 key) {
+    coefficientRequests.fetch_add(1, std::memory_order_relaxed);
+
+    if (table.fulfil(key)) {
+        coefficientDesigns.fetch_add(1, std::memory_order_relaxed);
+    }
+}
+
+std::shared_ptr<const juce::AudioBuffer<float>> SharedDesignService::getFIR(const ChainCoefficients& chainCoefficients, double sampleRate, int firLength) {
+    firRequests.fetch_add(1, std::memory_order_relaxed);
+
+    std::shared_ptr<FirEntry> entry;
+    bool designHere = false;
+
+    {
+        const juce::ScopedLock lock(firLock);
+
+        for (auto& recent : recentFIRs) {
+            if (recent->sampleRate == sampleRate && recent->firLength == firLength && sameChain(recent->chainCoefficients, chainCoefficients)) {
+                entry = recent;
+                break;
+            }
+        }
+
+        if (entry == nullptr) {
+            entry = std::make_shared<FirEntry>();
+            entry->chainCoefficients = chainCoefficients;
+            entry->sampleRate = sampleRate;
+            entry->firLength = firLength;
+            designHere = true;
+
+            //Anyone still waiting on an evicted entry holds on to it
+            if (recentFIRs.size() >= maxRecentFIRs) {
+                recentFIRs.erase(recentFIRs.begin());
+            }
+            recentFIRs.push_back(entry);
+        }
+    }
+
+    if (designHere) {
+        auto fir = std::make_shared<juce::AudioBuffer<float>>(1, firLength);
+        LinearPhaseEQ::designFIR(chainCoefficients, *fir);
+        firDesigns.fetch_add(1, std::memory_order_relaxed);
+
+        entry->fir = std::move(fir);
+        entry->ready.signal();
+    } else {
+        entry->ready.wait();
+    }
+
+    return entry->fir;
+}
+
+SharedDesignService::Stats SharedDesignService::getStats() const {
+    Stats stats;
+
+    {
+        const juce::ScopedLock lock(clientsLock);
+        stats.numClients = clients.size();
+    }
+
+    {
+        const juce::ScopedLock lock(tablesLock);
+        for (auto& weakTable : tables) {
+            if (auto table = weakTable.lock()) {
+                ++stats.numTables;
+                stats.tableBytes += table->getBytesUsed();
+            }
+        }
+    }
+
+    stats.coefficientRequests = coefficientRequests.load(std::memory_order_relaxed);
+    stats.coefficientDesigns = coefficientDesigns.load(std::memory_order_relaxed);
+    stats.firRequests = firRequests.load(std::memory_order_relaxed);
+    stats.firDesigns = firDesigns.load(std::memory_order_relaxed);
+    return stats;
+}
+
+void SharedDesignService::run() {
+    //Polling keeps every audio thread to atomic stores and its own FIFO, notify() would take a lock
+    while (! threadShouldExit()) {
+        bool idle;
+
+        {
+            const juce::ScopedLock lock(clientsLock);
+            auto now = juce::Time::getMillisecondCounterHiRes();
+
+            for (auto* client : clients) {
+                client->serviceTick(now);
+            }
+
+            idle = clients.isEmpty();
+        }
+
+        //Sleeps until addClient() while nobody needs it
+        wait(idle ? -1 : tickMs);
+    }
+}
@@ -0,0 +1,148 @@
+/*
+  ==============================================================================
+
+    SharedDesignService.h
+
+    One per process, shared by every SimpleEQ instance through
+    juce::SharedResourcePointer and gone once the last instance lets go.
+    It owns what used to be per instance:
+
+    - A lock-free coefficient table per sample rate. Instances read it
+      directly from their audio threads and send the designs they missed
+      through their own single-producer FIFO, the service designs each key
+      once no matter how many instances asked for it.
+    - One service thread that visits its clients (coefficient caches,
+      linear phase engines, spectrum analyzers) every few ms, and a pool of
+      one or two threads for the long jobs: FIR designs and table prefills.
+      Identical FIRs requested by several instances are designed once.
+    - The ConvolutionMessageQueue every linear phase convolution loads through.
+
+    So the number of threads stays at the service thread, the pool and the
+    convolution queue however many instances are loaded, and the audio
+    thread of one instance never waits on anything another instance holds.
+
+  ==============================================================================
+*/
+
+#pragma once
+
+#include <JuceHeader.h>
+#include "CoefficientDesign.h"
+
+//Direct-mapped table of cut and peak designs at one sample rate, keyed by CoefficientCache's packed keys.
+//Every entry is a seqlock over atomic words, so readers on any number of audio threads never wait and
+//never see a half written design, they just miss while a writer is on the entry.
+class SharedCoefficientTable {
+public:
+    using Designer = CutCoefficients (*)(double sampleRate, juce::uint64 key);
+
+    static constexpr juce::uint64 emptyKey = ~juce::uint64(0);
+
+    SharedCoefficientTable(double sampleRate, size_t budgetBytes, Designer designer);
+
+    static size_t getNumEntriesForBudget(size_t budgetBytes);
+
+    double getSampleRate() const { return sampleRate; }
+    size_t getNumEntries() const { return numEntries; }
+    size_t getBytesUsed() const { return numEntries * sizeof(Entry); }
+
+    //Any thread, wait-free. False on a miss or while the entry is being rewritten.
+    bool read(juce::uint64 key, CutCoefficients& coefficients) const;
+    bool contains(juce::uint64 key) const;
+
+    //Never the audio thread. Skips the entry rather than waiting when another writer holds it, and with onlyIntoEmpty
+    //when something else is already there. True if the design landed.
+    bool publish(juce::uint64 key, const CutCoefficients& coefficients, bool onlyIntoEmpty = false);
+
+    //Designs key and publishes it unless it's already there, true if it had to design
+    bool fulfil(juce::uint64 key);
+
+    //True for exactly one caller, who is expected to fill the table
+    bool claimPrefill() { return ! prefillClaimed.exchange(true); }
+
+private:
+    static constexpr size_t numWords = (sizeof(CutCoefficients) + sizeof(juce::uint64) - 1) / sizeof(juce::uint64);
+    static_assert(std::is_trivially_copyable<CutCoefficients>::value, "designs are copied through plain words");
+
+    struct Entry {
+        std::atomic<juce::uint32> sequence {0};     //Odd while a writer is on the entry
+        std::atomic<juce::uint64> key {emptyKey};
+        std::array<std::atomic<juce::uint64>, numWords> words;
+    };
+
+    double sampleRate;
+    Designer designer;
+    size_t numEntries;
+    juce::uint64 mask;
+    std::unique_ptr<Entry[]> entries;
+    std::atomic<bool> prefillClaimed {false};
+
+    Entry& getEntry(juce::uint64 key) const;
+};
+
+class SharedDesignService : private juce::Thread {
+public:
+    //Visited on the service thread every few ms from addClient() until removeClient() returns
+    struct Client {
+        virtual ~Client() = default;
+        virtual void serviceTick(double nowMs) = 0;
+    };
+
+    struct Stats {
+        int numClients {0}, numTables {0};
+        size_t tableBytes {0};
+        juce::uint64 coefficientRequests {0}, coefficientDesigns {0};
+        juce::uint64 firRequests {0}, firDesigns {0};
+    };
+
+    SharedDesignService();
+    ~SharedDesignService() override;
+
+    //Message thread, never the audio thread
+    void addClient(Client& client);
+    void removeClient(Client& client);
+
+    //Not realtime safe. The table everyone at this rate shares, at least budgetBytes large, or nullptr for a budget of 0.
+    std::shared_ptr<SharedCoefficientTable> getCoefficientTable(double sampleRate, size_t budgetBytes, SharedCoefficientTable::Designer designer);
+
+    //Service thread. Counts the request and designs it if no other instance got there first.
+    void fulfil(SharedCoefficientTable& table, juce::uint64 key);
+
+    //Pool threads. The FIR for these coefficients, designed by whichever caller asked first while the rest wait for it.
+    std::shared_ptr<const juce::AudioBuffer<float>> getFIR(const ChainCoefficients& chainCoefficients, double sampleRate, int firLength);
+
+    juce::ThreadPool& getPool() { return pool; }
+    juce::dsp::ConvolutionMessageQueue& getConvolutionQueue() { return convolutionQueue; }
+
+    Stats getStats() const;
+
+private:
+    static constexpr int tickMs = 5;
+    static constexpr size_t maxRecentFIRs = 4;
+
+    struct FirEntry {
+        ChainCoefficients chainCoefficients;
+        double sampleRate;
+        int firLength;
+        juce::WaitableEvent ready {true};
+        std::shared_ptr<const juce::AudioBuffer<float>> fir;
+    };
+
+    juce::CriticalSection clientsLock;
+    juce::Array<Client*> clients;
+
+    mutable juce::CriticalSection tablesLock;
+    std::vector<std::weak_ptr<SharedCoefficientTable>> tables;
+
+    juce::CriticalSection firLock;
+    std::vector<std::shared_ptr<FirEntry>> recentFIRs;
+
+    std::atomic<juce::uint64> coefficientRequests {0}, coefficientDesigns {0};
+    std::atomic<juce::uint64> firRequests {0}, firDesigns {0};
+
+    //Declared last, so the pool's jobs and the convolution queue's loads are finished before the rest goes
+    juce::dsp::ConvolutionMessageQueue convolutionQueue;
+    juce::ThreadPool pool;
+
+    void run() override;
+};
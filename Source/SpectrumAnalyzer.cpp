@@ -0,0 +1,201 @@
+/*
+  ==============================================================================
+
+    SpectrumAnalyzer.cpp
+
+  ==============================================================================
+*/
+
+#include "SpectrumAnalyzer.h"
+
+SpectrumAnalyzer::SpectrumAnalyzer() {
+}
+
+SpectrumAnalyzer::~SpectrumAnalyzer() {
+    setActive(false);
+}
+
+void SpectrumAnalyzer::setActive(bool shouldBeActive) {
+    if (shouldBeActive == isActive()) {
+        return;
+    }
+
+    if (shouldBeActive) {
+        //Whatever sat in the FIFOs while nobody was looking is stale
+        drainRequested = true;
+        active = true;
+        nextFrameMs = 0.0;
+        service->addClient(*this);
+    } else {
+        active = false;
+        service->removeClient(*this);
+    }
+}
+
+void SpectrumAnalyzer::setSettings(const Settings& newSettings) {
+    {
+        const juce::SpinLock::ScopedLockType lock(settingsLock);
+        settings = newSettings;
+        settings.fftOrder = juce::jlimit(9, 15, settings.fftOrder);
+        settings.overlap = juce::jlimit(1, 16, settings.overlap);
+        settings.framesPerSecond = juce::jlimit(1.0, 120.0, settings.framesPerSecond);
+        settings.smoothing = juce::jlimit(0.0f, 0.99f, settings.smoothing);
+    }
+    settingsGeneration.fetch_add(1);
+}
+
+SpectrumAnalyzer::Settings SpectrumAnalyzer::getSettings() const {
+    const juce::SpinLock::ScopedLockType lock(settingsLock);
+    return settings;
+}
+
+void SpectrumAnalyzer::prepare(double newSampleRate) {
+    sampleRate = newSampleRate;
+    drainRequested = true;
+}
+
+juce::Path SpectrumAnalyzer::getPath(Tap tap) const {
+    const juce::SpinLock::ScopedLockType lock(pathLock);
+    return taps[(size_t) tap].path;
+}
+
+void SpectrumAnalyzer::applySettings() {
+    {
+        const juce::SpinLock::ScopedLockType lock(settingsLock);
+        current = settings;
+    }
+
+    appliedSampleRate = sampleRate.load();
+
+    auto fftSize = 1 << current.fftOrder;
+    fft = std::make_unique<juce::dsp::FFT>(current.fftOrder);
+    window = std::make_unique<juce::dsp::WindowingFunction<float>>((size_t) fftSize, juce::dsp::WindowingFunction<float>::hann, false);
+    fftData.assign((size_t) fftSize * 2, 0.0f);
+
+    for (auto& tap : taps) {
+        tap.history.assign((size_t) fftSize, 0.0f);
+        tap.historyWrite = 0;
+        tap.samplesSinceFrame = 0;
+        tap.smoothedDB.assign((size_t) numColumns, current.floorDB);
+    }
+
+    //FFT bin range that lands in each log spaced column
+    auto lastBin = fftSize / 2;
+    for (int column = 0; column <= numColumns; ++column) {
+        auto freq = juce::mapToLog10((double) column / (double) numColumns, 20.0, 20000.0);
+        columnBins[(size_t) column] = juce::jlimit(1, lastBin, juce::roundToInt(freq * fftSize / appliedSampleRate));
+    }
+}
+
+void SpectrumAnalyzer::serviceTick(double nowMs) {
+    //The service visits every few ms, frames go out no faster than the settings ask for
+    if (nowMs < nextFrameMs) {
+        return;
+    }
+
+    if (settingsGeneration.load() != appliedSettingsGeneration || sampleRate.load() != appliedSampleRate) {
+        appliedSettingsGeneration = settingsGeneration.load();
+        applySettings();
+    }
+
+    nextFrameMs = nowMs + 1000.0 / current.framesPerSecond;
+
+    auto drainOnly = drainRequested.exchange(false);
+    bool anyNewFrame = false;
+
+    for (auto& tap : taps) {
+        if (drainOnly) {
+            tap.fifo.finishedRead(tap.fifo.getNumReady());
+            continue;
+        }
+
+        if (drain(tap)) {
+            analyse(tap);
+            anyNewFrame = true;
+        }
+    }
+
+    if (anyNewFrame) {
+        frameCount.fetch_add(1, std::memory_order_release);
+    }
+}
+
+//Moves everything the audio thread pushed into the history, true once a hop's worth has arrived
+bool SpectrumAnalyzer::drain(TapState& tap) {
+    auto numReady = tap.fifo.getNumReady();
+    if (numReady <= 0) {
+        return false;
+    }
+
+    int start1, size1, start2, size2;
+    tap.fifo.prepareToRead(numReady, start1, size1, start2, size2);
+
+    auto historySize = (int) tap.history.size();
+    auto append = [&tap, historySize](const float* source, int count) {
+        for (int n = 0; n < count; ++n) {
+            tap.history[(size_t) tap.historyWrite] = source[n];
+            tap.historyWrite = (tap.historyWrite + 1) % historySize;
+        }
+    };
+
+    append(tap.buffer.data() + start1, size1);
+    append(tap.buffer.data() + start2, size2);
+    tap.fifo.finishedRead(size1 + size2);
+
+    //A backlog is analysed once at its newest position rather than frame by frame, so a busy machine
+    //drops frames instead of falling further behind
+    tap.samplesSinceFrame += size1 + size2;
+    auto hop = historySize / current.overlap;
+
+    if (tap.samplesSinceFrame < hop) {
+        return false;
+    }
+
+    tap.samplesSinceFrame %= hop;
+    return true;
+}
+
+void SpectrumAnalyzer::analyse(TapState& tap) {
+    auto fftSize = (int) tap.history.size();
+
+    //Oldest sample first
+    for (int n = 0; n < fftSize; ++n) {
+        fftData[(size_t) n] = tap.history[(size_t) ((tap.historyWrite + n) % fftSize)];
+    }
+    std::fill(fftData.begin() + fftSize, fftData.end(), 0.0f);
+
+    window->multiplyWithWindowingTable(fftData.data(), (size_t) fftSize);
+    fft->performFrequencyOnlyForwardTransform(fftData.data());
+
+    //A full scale sine through a Hann window peaks at fftSize / 4
+    auto scale = 4.0f / (float) fftSize;
+
+    juce::Path path;
+    path.preallocateSpace(numColumns * 3);
+
+    for (int column = 0; column < numColumns; ++column) {
+        auto firstBin = columnBins[(size_t) column];
+        auto lastBin = juce::jmax(firstBin, columnBins[(size_t) column + 1] - 1);
+
+        float magnitude = 0.0f;
+        for (int bin = firstBin; bin <= lastBin; ++bin) {
+            magnitude = juce::jmax(magnitude, fftData[(size_t) bin]);
+        }
+
+        auto levelDB = juce::Decibels::gainToDecibels(magnitude * scale, current.floorDB);
+        auto& smoothed = tap.smoothedDB[(size_t) column];
+        smoothed = levelDB + current.smoothing * (smoothed - levelDB);
+
+        auto x = (float) column / (float) (numColumns - 1);
+        auto y = juce::jlimit(0.0f, 1.0f, juce::jmap(smoothed, 0.0f, current.floorDB, 0.0f, 1.0f));
+
+        if (column == 0) {
+            path.startNewSubPath(x, y);
+        } else {
+            path.lineTo(x, y);
+        }
+    }
+
+    const juce::SpinLock::ScopedLockType lock(pathLock);
+    tap.path.swapWithPath(path);
+}
@@ -0,0 +1,138 @@
+/*
+  ==============================================================================
+
+    SpectrumAnalyzer.h
+
+    Pre/post spectrum for the editor. processBlock pushes a mono downmix into
+    a single-producer/single-consumer FIFO per tap; the SharedDesignService
+    thread does the windowed FFT, smoothing and log-frequency binning for
+    every open analyzer in the process and publishes a Path in normalised
+    coordinates (x 20 Hz..20 kHz, y 0 dBFS..floor) that the editor scales to
+    its bounds.
+
+    Nothing runs and nothing is pushed while no editor is showing it, the
+    audio thread only tests isActive().
+
+  ==============================================================================
+*/
+
+#pragma once
+
+#include <JuceHeader.h>
+#include "SharedDesignService.h"
+
+class SpectrumAnalyzer : private SharedDesignService::Client {
+public:
+    enum Tap {
+        pre,
+        post,
+        numTaps
+    };
+
+    struct Settings {
+        int fftOrder {11};              //2048 point FFT
+        int overlap {4};                //Hop of fftSize / overlap samples between frames
+        double framesPerSecond {30.0};  //Upper bound on how often paths are published
+        float smoothing {0.7f};         //0 shows every frame as is, closer to 1 holds levels longer
+        float floorDB {-96.0f};
+    };
+
+    SpectrumAnalyzer();
+    ~SpectrumAnalyzer() override;
+
+    //Message thread. Adds or removes it from the service's rounds, the editor switches it on while it's open.
+    void setActive(bool shouldBeActive);
+    bool isActive() const { return active.load(std::memory_order_relaxed); }
+
+    //Any thread but the audio thread, picked up by the service thread before its next frame
+    void setSettings(const Settings& newSettings);
+    Settings getSettings() const;
+
+    //Called from prepareToPlay
+    void prepare(double sampleRate);
+
+    //Audio thread only. Never blocks or allocates, samples that don't fit are dropped.
+    template <typename SampleType>
+    void push(Tap tap, const juce::dsp::AudioBlock<SampleType>& block) {
+        auto& fifo = taps[(size_t) tap].fifo;
+        auto numSamples = juce::jmin((int) block.getNumSamples(), fifo.getFreeSpace());
+        auto numChannels = block.getNumChannels();
+
+        if (numSamples <= 0 || numChannels == 0) {
+            return;
+        }
+
+        int start1, size1, start2, size2;
+        fifo.prepareToWrite(numSamples, start1, size1, start2, size2);
+
+        auto* buffer = taps[(size_t) tap].buffer.data();
+        auto gain = 1.0f / (float) numChannels;
+
+        auto downmix = [&](int destStart, int sourceStart, int count) {
+            auto* dest = buffer + destStart;
+            for (size_t ch = 0; ch < numChannels; ++ch) {
+                auto* source = block.getChannelPointer(ch) + sourceStart;
+                for (int n = 0; n < count; ++n) {
+                    auto sample = (float) source[n] * gain;
+                    dest[n] = ch == 0 ? sample : dest[n] + sample;
+                }
+            }
+        };
+
+        downmix(start1, 0, size1);
+        downmix(start2, size1, size2);
+        fifo.finishedWrite(size1 + size2);
+    }
+
+    //Message thread. Returns the latest path and the frame counter it was published with.
+    juce::Path getPath(Tap tap) const;
+    juce::uint32 getFrameCount() const { return frameCount.load(std::memory_order_acquire); }
+
+private:
+    static constexpr int fifoSize = 1 << 16;
+    static constexpr int numColumns = 256;
+
+    struct TapState {
+        juce::AbstractFifo fifo {fifoSize};
+        std::vector<float> buffer = std::vector<float>((size_t) fifoSize);
+
+        //Service thread only
+        std::vector<float> history;
+        int historyWrite {0};
+        int samplesSinceFrame {0};
+        std::vector<float> smoothedDB;
+
+        //Guarded by pathLock
+        juce::Path path;
+    };
+
+    std::array<TapState, numTaps> taps;
+
+    std::atomic<bool> active {false};
+    std::atomic<double> sampleRate {44100.0};
+    std::atomic<bool> drainRequested {false};
+    std::atomic<juce::uint32> frameCount {0};
+
+    mutable juce::SpinLock settingsLock;
+    Settings settings;
+    std::atomic<juce::uint32> settingsGeneration {1};
+
+    mutable juce::SpinLock pathLock;
+
+    juce::SharedResourcePointer<SharedDesignService> service;
+
+    //Service thread only
+    double nextFrameMs {0.0};
+    juce::uint32 appliedSettingsGeneration {0};
+    double appliedSampleRate {0.0};
+    Settings current;
+    std::unique_ptr<juce::dsp::FFT> fft;
+    std::unique_ptr<juce::dsp::WindowingFunction<float>> window;
+    std::vector<float> fftData;
+    std::array<int, numColumns + 1> columnBins {};
+
+    void serviceTick(double nowMs) override;
+    void applySettings();
+    bool drain(TapState& tap);
+    void analyse(TapState& tap);
+};
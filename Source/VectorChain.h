@@ -0,0 +1,284 @@
+/*
+  ==============================================================================
+
+    VectorChain.h
+
+    The low cut / peak / high cut cascade and the band bank with every
+    channel's filter state side by side in one juce::dsp::SIMDRegister, so a
+    single pass through the up to 33 biquads processes all of them. The stages come from the same
+    Engine policy as MonoChain, so the output matches the scalar chain to
+    within rounding.
+
+    Linked channels share every coefficient. Channels with settings of
+    their own are set lane by lane, and once one lane of a chain is set
+    that way every lane in use has to be. Mid/side is encoded while the
+    first two channels are interleaved into the lanes and decoded on the
+    way back out, so it costs no pass of its own.
+
+  ==============================================================================
+*/
+
+#pragma once
+
+#include <JuceHeader.h>
+#include "CoefficientDesign.h"
+#include "FilterEngines.h"
+#include "BandBank.h"
+
+#if JUCE_USE_SIMD
+
+template <typename SampleType, typename Engine = SelectedFilterEngine>
+class VectorChain {
+public:
+    using Vec = juce::dsp::SIMDRegister<SampleType>;
+    static constexpr size_t numLanes = Vec::SIMDNumElements;
+
+    //One bit per lane
+    using LaneMask = juce::uint32;
+    static constexpr LaneMask allLanes = (LaneMask) ((1u << numLanes) - 1);
+
+    //Not realtime safe
+    void prepare(int maximumBlockSize) {
+        interleaved.assign((size_t) maximumBlockSize, Vec::expand(0));
+        reset();
+    }
+
+    void reset() {
+        lowCut.reset();
+        peak.reset();
+        highCut.reset();
+        bank.reset();
+    }
+
+    void setLowCut(const CutCoefficients& cut, bool bypassed) {
+        lowCut.setCoefficients(cut);
+        lcBypassed = bypassed ? allLanes : 0;
+    }
+
+    void setPeak(const BiquadCoefficients& coefficients, bool bypassed) {
+        peak.setCoefficients(coefficients);
+        pdBypassed = bypassed ? allLanes : 0;
+    }
+
+    void setHighCut(const CutCoefficients& cut, bool bypassed) {
+        highCut.setCoefficients(cut);
+        hcBypassed = bypassed ? allLanes : 0;
+    }
+
+    void setBank(const BankCoefficients& coefficients) {
+        bank.setCoefficients(coefficients);
+    }
+
+    //A bypassed lane runs as unity, the stage is only skipped once every lane in use is bypassed
+    void setLowCut(const CutCoefficients& cut, bool bypassed, size_t lane) {
+        lowCut.setLaneCoefficients(lane, cut, bypassed);
+        lcBypassed = withLane(lcBypassed, lane, bypassed);
+    }
+
+    void setPeak(const BiquadCoefficients& coefficients, bool bypassed, size_t lane) {
+        peak.setLaneCoefficients(lane, bypassed ? BiquadCoefficients {} : coefficients);
+        pdBypassed = withLane(pdBypassed, lane, bypassed);
+    }
+
+    void setHighCut(const CutCoefficients& cut, bool bypassed, size_t lane) {
+        highCut.setLaneCoefficients(lane, cut, bypassed);
+        hcBypassed = withLane(hcBypassed, lane, bypassed);
+    }
+
+    void setBank(const BankCoefficients& coefficients, size_t lane) {
+        bank.setLaneCoefficients(lane, coefficients);
+    }
+
+    //Lane 0 carries mid and lane 1 side between the encode and the decode
+    void setMidSide(bool shouldUseMidSide) { midSide = shouldUseMidSide; }
+
+    void setCascadeKernel(CascadeKernel kernel) {
+        lowCut.setKernel(kernel);
+        highCut.setKernel(kernel);
+    }
+
+    void setCoefficients(const ChainCoefficients& chain) {
+        setLowCut(chain.lowCut, chain.lcBypassed);
+        setPeak(chain.peak, chain.pdBypassed);
+        setHighCut(chain.highCut, chain.hcBypassed);
+        setBank(chain.bank);
+    }
+
+    //Processes up to numLanes channels of the block in place, in chunks of the block size given to prepare()
+    void process(juce::dsp::AudioBlock<SampleType>& block) {
+        auto chunkSize = interleaved.size();
+        if (chunkSize == 0) {
+            jassertfalse;
+            return;
+        }
+
+        for (size_t start = 0; start < block.getNumSamples(); start += chunkSize) {
+            auto chunk = block.getSubBlock(start, juce::jmin(chunkSize, block.getNumSamples() - start));
+            processChunk(chunk);
+        }
+    }
+
+private:
+    StageCascade<Engine, Vec> lowCut, highCut;
+    typename Engine::template Stage<Vec> peak;
+    BandBank<Vec> bank;
+    LaneMask lcBypassed {0}, pdBypassed {0}, hcBypassed {0};
+    bool midSide {false};
+
+    static LaneMask withLane(LaneMask mask, size_t lane, bool set) {
+        auto bit = (LaneMask) (1u << lane);
+        return set ? (mask | bit) : (mask & ~bit);
+    }
+
+    void processChunk(juce::dsp::AudioBlock<SampleType>& block) {
+        auto numChannels = juce::jmin(block.getNumChannels(), numLanes);
+        auto numSamples = block.getNumSamples();
+
+        auto* raw = reinterpret_cast<SampleType*>(interleaved.data());
+        auto encodeMidSide = midSide && numChannels >= 2;
+        auto half = (SampleType) 0.5;
+
+        if (encodeMidSide) {
+            auto* left = block.getChannelPointer(0);
+            auto* right = block.getChannelPointer(1);
+            for (size_t n = 0; n < numSamples; ++n) {
+                raw[n * numLanes] = (left[n] + right[n]) * half;
+                raw[n * numLanes + 1] = (left[n] - right[n]) * half;
+            }
+        }
+
+        for (size_t ch = encodeMidSide ? 2 : 0; ch < numChannels; ++ch) {
+            auto* src = block.getChannelPointer(ch);
+            for (size_t n = 0; n < numSamples; ++n) {
+                raw[n * numLanes + ch] = src[n];
+            }
+        }
+
+        auto* data = interleaved.data();
+        auto usedLanes = (LaneMask) ((1u << numChannels) - 1);
+
+        if ((lcBypassed & usedLanes) != usedLanes) {
+            lowCut.process(data, data, numSamples);
+        }
+        if ((pdBypassed & usedLanes) != usedLanes) {
+            peak.process(data, data, numSamples);
+        }
+        if ((hcBypassed & usedLanes) != usedLanes) {
+            highCut.process(data, data, numSamples);
+        }
+        bank.process(data, data, numSamples);
+
+        if (encodeMidSide) {
+            auto* left = block.getChannelPointer(0);
+            auto* right = block.getChannelPointer(1);
+            for (size_t n = 0; n < numSamples; ++n) {
+                auto mid = raw[n * numLanes];
+                auto side = raw[n * numLanes + 1];
+                left[n] = mid + side;
+                right[n] = mid - side;
+            }
+        }
+
+        for (size_t ch = encodeMidSide ? 2 : 0; ch < numChannels; ++ch) {
+            auto* dst = block.getChannelPointer(ch);
+            for (size_t n = 0; n < numSamples; ++n) {
+                dst[n] = raw[n * numLanes + ch];
+            }
+        }
+    }
+
+    std::vector<Vec> interleaved;
+};
+
+//One VectorChain per numLanes channels, sized to the bus layout in prepare()
+template <typename SampleType, typename Engine = SelectedFilterEngine>
+class VectorFilterBank {
+public:
+    using Chain = VectorChain<SampleType, Engine>;
+
+    //Not realtime safe
+    void prepare(int numChannels, int maximumBlockSize) {
+        auto numGroups = ((size_t) numChannels + Chain::numLanes - 1) / Chain::numLanes;
+        groups = std::vector<Chain>(numGroups);
+
+        for (auto& group : groups) {
+            group.prepare(maximumBlockSize);
+        }
+    }
+
+    void reset() {
+        for (auto& group : groups) {
+            group.reset();
+        }
+    }
+
+    size_t getNumChannels() const { return groups.size() * Chain::numLanes; }
+
+    //channel < 0 sets every channel, anything else just the lane that channel runs in
+    void setLowCut(const CutCoefficients& cut, bool bypassed, int channel = -1) {
+        forChannel(channel, [&](Chain& group) { group.setLowCut(cut, bypassed); },
+                            [&](Chain& group, size_t lane) { group.setLowCut(cut, bypassed, lane); });
+    }
+
+    void setPeak(const BiquadCoefficients& peak, bool bypassed, int channel = -1) {
+        forChannel(channel, [&](Chain& group) { group.setPeak(peak, bypassed); },
+                            [&](Chain& group, size_t lane) { group.setPeak(peak, bypassed, lane); });
+    }
+
+    void setHighCut(const CutCoefficients& cut, bool bypassed, int channel = -1) {
+        forChannel(channel, [&](Chain& group) { group.setHighCut(cut, bypassed); },
+                            [&](Chain& group, size_t lane) { group.setHighCut(cut, bypassed, lane); });
+    }
+
+    void setBank(const BankCoefficients& bank, int channel = -1) {
+        forChannel(channel, [&](Chain& group) { group.setBank(bank); },
+                            [&](Chain& group, size_t lane) { group.setBank(bank, lane); });
+    }
+
+    //The first two channels are always lanes 0 and 1 of the first group
+    void setMidSide(bool shouldUseMidSide) {
+        if (! groups.empty()) {
+            groups.front().setMidSide(shouldUseMidSide);
+        }
+    }
+
+    void setCascadeKernel(CascadeKernel kernel) {
+        for (auto& group : groups) {
+            group.setCascadeKernel(kernel);
+        }
+    }
+
+    void process(juce::dsp::AudioBlock<SampleType>& block) {
+        auto numChannels = block.getNumChannels();
+
+        for (size_t g = 0; g < groups.size(); ++g) {
+            auto firstChannel = g * Chain::numLanes;
+            if (firstChannel >= numChannels) {
+                break;
+            }
+
+            auto groupBlock = block.getSubsetChannelBlock(firstChannel, juce::jmin(Chain::numLanes, numChannels - firstChannel));
+            groups[g].process(groupBlock);
+        }
+    }
+
+private:
+    std::vector<Chain> groups;
+
+    template <typename AllLanes, typename OneLane>
+    void forChannel(int channel, AllLanes&& allLanes, OneLane&& oneLane) {
+        if (channel < 0) {
+            for (auto& group : groups) {
+                allLanes(group);
+            }
+            return;
+        }
+
+        auto g = (size_t) channel / Chain::numLanes;
+        if (g < groups.size()) {
+            oneLane(groups[g], (size_t) channel % Chain::numLanes);
+        }
+    }
+};
+
+#endif
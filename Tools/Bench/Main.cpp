@@ -0,0 +1,1415 @@
+/*
+  ==============================================================================
+
+    Main.cpp
+
+    SimpleEQ_bench: runs SimpleEQAudioProcessor headlessly and times
+    processBlock across block sizes, sample rates, slopes and bypass states.
+
+    Usage: SimpleEQ_bench [--suite=grid|smoothing|precision|instrumentation|linearphase|oversampling|fastpaths|bands|dynamics|stereo|presets|instances|automation|cascade|verify]
+                          [--quick] [--seconds=<s>]
+                          [--engine=scalar|vectorised] [--csv=<file>]
+
+    grid       the full block size / sample rate / slope / bypass sweep
+    smoothing  per-block updates against in-block smoothing while LC_freq
+               and PD_gain are automated on every block
+    precision  float, double and mixed precision chains against a double
+               reference at low cutoffs and high sample rates, then the
+               whole processor in single and double precision
+    instrumentation
+               cost of the CallbackMonitor timing around processBlock, and
+               the stats it exports
+    linearphase
+               CPU and latency of each linear phase quality against the
+               minimum phase chains
+    oversampling
+               CPU and latency of 1x/2x/4x/8x oversampling around the chains
+    fastpaths  noise through active bands against silence and all bands
+               bypassed, with the path processBlock took for each block
+    bands      cost of 0 to 16 enabled band bank bands on top of the cuts
+               and the peak
+    dynamics   cost of the dynamic peak and 0 to 16 dynamic bank bands
+               keyed by the input, with how often they were redesigned
+    stereo     cost of each stereo mode on both engines, and how far the
+               vectorised engine's per-lane settings and fused mid/side
+               land from the scalar engine's
+    presets    preset bank size and load time, then the cost of switching
+               programs every few blocks and the largest output step it
+               leaves on a low sine, with and without the crossfade.
+               Fails unless the last of two switches made back to back
+               lands
+    instances  1 to 64 instances automating the same sweep: process thread
+               count, per-instance cost, and how many of their coefficient
+               and FIR requests the shared design service had to design
+    automation an automated render with a snapshot recalled part way, at
+               buffer sizes from 32 to 1024, whole block against sample
+               accurate: cost, and whether each render matches the 32
+               sample one bit for bit
+    cascade    the per-sample and block state-space cut kernels from
+               12 to 96 dB/oct and for a 20 Hz cut at 8x oversampling,
+               what automatic picks, and the largest difference between
+               the kernels' renders. Fails past --kernel-tolerance=<abs>,
+               default 1e-2, or on a render that isn't finite
+    verify     magnitude, golden render, engine agreement and stability
+               checks, see Verify.h for its options
+
+    Exits non-zero if any processBlock call allocated, so CI can gate on it.
+
+  ==============================================================================
+*/
+
+#include <JuceHeader.h>
+#include "PluginProcessor.h"
+#include "Verify.h"
+
+#if JUCE_INTEL
+ #if JUCE_MSVC
+  #include <intrin.h>
+ #else
+  #include <x86intrin.h>
+ #endif
+#endif
+
+//Counts every global allocation made while counting is switched on
+static std::atomic<bool> countAllocations {false};
+static std::atomic<juce::int64> numAllocations {0};
+
+void* operator new(std::size_t size) {
+    if (countAllocations.load(std::memory_order_relaxed)) {
+        numAllocations.fetch_add(1, std::memory_order_relaxed);
+    }
+
+    if (auto* ptr = std::malloc(size == 0 ? 1 : size)) {
+        return ptr;
+    }
+
+    throw std::bad_alloc();
+}
+
+void* operator new[](std::size_t size) { return operator new(size); }
+void operator delete(void* ptr) noexcept { std::free(ptr); }
+void operator delete[](void* ptr) noexcept { std::free(ptr); }
+void operator delete(void* ptr, std::size_t) noexcept { std::free(ptr); }
+void operator delete[](void* ptr, std::size_t) noexcept { std::free(ptr); }
+
+static juce::uint64 readCycleCounter() {
+   #if JUCE_INTEL
+    return (juce::uint64) __rdtsc();
+   #else
+    return 0;
+   #endif
+}
+
+struct BenchCase {
+    double sampleRate;
+    int blockSize;
+    int slope;
+    int bypassMask; //bit 0 low cut, bit 1 peak, bit 2 high cut
+    bool automate {false};
+    bool silent {false};
+    float lcFreq {80.0f};
+};
+
+struct BenchResult {
+    double nsPerSample {0.0};
+    double cyclesPerSample {0.0};
+    double allocationsPerCall {0.0};
+};
+
+static void setParameter(SimpleEQAudioProcessor& processor, const juce::String& parameterID, float value) {
+    auto* param = processor.apvts.getParameter(parameterID);
+    jassert(param != nullptr);
+    param->setValueNotifyingHost(param->convertTo0to1(value));
+}
+
+static void applyCase(SimpleEQAudioProcessor& processor, const BenchCase& benchCase) {
+    setParameter(processor, "LC_freq", benchCase.lcFreq);
+    setParameter(processor, "HC_freq", (float) juce::jmin(12000.0, benchCase.sampleRate * 0.45));
+    setParameter(processor, "PD_freq", 1000.0f);
+    setParameter(processor, "PD_gain", 6.0f);
+    setParameter(processor, "PD_q", 1.0f);
+    setParameter(processor, "LC_slope8", (float) benchCase.slope);
+    setParameter(processor, "HC_slope8", (float) benchCase.slope);
+    setParameter(processor, "LC_bp", (benchCase.bypassMask & 1) != 0 ? 1.0f : 0.0f);
+    setParameter(processor, "PD_bp", (benchCase.bypassMask & 2) != 0 ? 1.0f : 0.0f);
+    setParameter(processor, "HC_bp", (benchCase.bypassMask & 4) != 0 ? 1.0f : 0.0f);
+}
+
+//Times processBlock on its own, the noise refill between calls is not counted
+template <typename SampleType = float>
+static BenchResult runCase(SimpleEQAudioProcessor& processor, const BenchCase& benchCase, double seconds) {
+    constexpr int numChannels = 2;
+
+    processor.setProcessingPrecision(std::is_same<SampleType, double>::value ? juce::AudioProcessor::doublePrecision
+                                                                              : juce::AudioProcessor::singlePrecision);
+    processor.setPlayConfigDetails(numChannels, numChannels, benchCase.sampleRate, benchCase.blockSize);
+    processor.prepareToPlay(benchCase.sampleRate, benchCase.blockSize);
+    applyCase(processor, benchCase);
+
+    juce::AudioBuffer<SampleType> noise(numChannels, benchCase.blockSize);
+    juce::AudioBuffer<SampleType> buffer(numChannels, benchCase.blockSize);
+    juce::MidiBuffer midi;
+    juce::Random random(0x5eed);
+
+    for (int ch = 0; ch < numChannels && ! benchCase.silent; ++ch) {
+        for (int n = 0; n < benchCase.blockSize; ++n) {
+            noise.setSample(ch, n, (SampleType) (random.nextFloat() * 2.0f - 1.0f));
+        }
+    }
+
+    //Warm up, this also applies the parameter changes above
+    for (int i = 0; i < 8; ++i) {
+        buffer.makeCopyOf(noise, true);
+        processor.processBlock(buffer, midi);
+    }
+
+    auto numCalls = juce::jmax(16, (int) (seconds * benchCase.sampleRate / benchCase.blockSize));
+    juce::int64 ticks = 0;
+    juce::uint64 cycles = 0;
+
+    numAllocations = 0;
+
+    for (int i = 0; i < numCalls; ++i) {
+        buffer.makeCopyOf(noise, true);
+
+        if (benchCase.automate) {
+            //A slow sweep, so every block moves the low cut and peak gain a little
+            auto phase = (float) i / (float) numCalls;
+            setParameter(processor, "LC_freq", 20.0f + 480.0f * phase);
+            setParameter(processor, "PD_gain", -12.0f + 24.0f * phase);
+        }
+
+        countAllocations = true;
+        auto startTicks = juce::Time::getHighResolutionTicks();
+        auto startCycles = readCycleCounter();
+
+        processor.processBlock(buffer, midi);
+
+        cycles += readCycleCounter() - startCycles;
+        ticks += juce::Time::getHighResolutionTicks() - startTicks;
+        countAllocations = false;
+    }
+
+    processor.releaseResources();
+
+    auto numSamples = (double) numCalls * benchCase.blockSize;
+
+    BenchResult result;
+    result.nsPerSample = juce::Time::highResolutionTicksToSeconds(ticks) * 1.0e9 / numSamples;
+    result.cyclesPerSample = (double) cycles / numSamples;
+    result.allocationsPerCall = (double) numAllocations.load() / numCalls;
+    return result;
+}
+
+static SimpleEQAudioProcessor::ProcessingEngine getEngine(const juce::ArgumentList& args) {
+    return args.getValueForOption("--engine") == "scalar" ? SimpleEQAudioProcessor::ProcessingEngine::scalar
+                                                          : SimpleEQAudioProcessor::ProcessingEngine::vectorised;
+}
+
+static double getSeconds(const juce::ArgumentList& args) {
+    return args.containsOption("--seconds") ? args.getValueForOption("--seconds").getDoubleValue() : 0.25;
+}
+
+static void writeCsv(const juce::ArgumentList& args, const juce::String& csv) {
+    if (args.containsOption("--csv")) {
+        juce::File::getCurrentWorkingDirectory().getChildFile(args.getValueForOption("--csv")).replaceWithText(csv);
+    }
+}
+
+//Cost of ramping inside the block against today's one update per block, both under automation
+static int runSmoothingSuite(const juce::ArgumentList& args) {
+    auto seconds = getSeconds(args);
+    juce::String csv = "block_size,sub_block,per_block_ns_per_sample,smoothed_ns_per_sample,overhead_percent,allocations_per_call\n";
+    bool anyAllocations = false;
+
+    std::printf("%6s %10s %18s %18s %10s %12s\n", "block", "sub-block", "per-block ns/smp", "smoothed ns/smp", "overhead", "allocs/call");
+
+    for (auto blockSize : { 32, 128, 512, 2048 }) {
+        for (auto subBlockSize : { 16, 32, 64 }) {
+            BenchCase benchCase { 48000.0, blockSize, Slope_48, 0, true };
+
+            SimpleEQAudioProcessor perBlock;
+            perBlock.setProcessingEngine(getEngine(args));
+            auto baseline = runCase(perBlock, benchCase, seconds);
+
+            SimpleEQAudioProcessor smoothed;
+            smoothed.setProcessingEngine(getEngine(args));
+            smoothed.setParameterSmoothing(true, subBlockSize);
+            auto result = runCase(smoothed, benchCase, seconds);
+
+            auto overhead = 100.0 * (result.nsPerSample / baseline.nsPerSample - 1.0);
+
+            std::printf("%6d %10d %18.3f %18.3f %9.1f%% %12.3f\n", blockSize, subBlockSize, baseline.nsPerSample, result.nsPerSample, overhead,
+                        result.allocationsPerCall);
+            csv << blockSize << "," << subBlockSize << "," << baseline.nsPerSample << "," << result.nsPerSample << "," << overhead << ","
+                << result.allocationsPerCall << "\n";
+
+            anyAllocations = anyAllocations || baseline.allocationsPerCall > 0.0 || result.allocationsPerCall > 0.0;
+        }
+    }
+
+    writeCsv(args, csv);
+    return anyAllocations ? 1 : 0;
+}
+
+//Runs a single channel chain over the whole buffer in 512 sample blocks and returns ns per sample
+template <typename ChainType, typename SampleType>
+static double processChain(ChainType& chain, juce::AudioBuffer<SampleType>& buffer) {
+    constexpr size_t blockSize = 512;
+    juce::dsp::AudioBlock<SampleType> block(buffer);
+
+    auto startTicks = juce::Time::getHighResolutionTicks();
+
+    for (size_t start = 0; start < block.getNumSamples(); start += blockSize) {
+        auto subBlock = block.getSubBlock(start, juce::jmin(blockSize, block.getNumSamples() - start));
+        chain.process(juce::dsp::ProcessContextReplacing<SampleType>(subBlock));
+    }
+
+    auto ticks = juce::Time::getHighResolutionTicks() - startTicks;
+    return juce::Time::highResolutionTicksToSeconds(ticks) * 1.0e9 / (double) buffer.getNumSamples();
+}
+
+template <typename ChainType>
+static void prepareChain(ChainType& chain, const ChainCoefficients& chainCoefficients, double sampleRate) {
+    allocateChainStorage(chain);
+    chain.prepare({ sampleRate, 512, 1 });
+    applyChainCoefficients(chain, chainCoefficients);
+}
+
+struct PrecisionResult {
+    double nsPerSample {0.0};
+    double maxErrorDB {-300.0}; //Largest deviation from the double reference, relative to full scale
+};
+
+template <typename Engine, typename SampleType>
+static PrecisionResult measureChain(const ChainCoefficients& chainCoefficients, double sampleRate, const juce::AudioBuffer<double>& input,
+                                    const juce::AudioBuffer<double>& reference) {
+    MonoChainT<Engine, SampleType> chain;
+    prepareChain(chain, chainCoefficients, sampleRate);
+
+    juce::AudioBuffer<SampleType> buffer(1, input.getNumSamples());
+    for (int n = 0; n < input.getNumSamples(); ++n) {
+        buffer.setSample(0, n, (SampleType) input.getSample(0, n));
+    }
+
+    PrecisionResult result;
+    result.nsPerSample = processChain(chain, buffer);
+
+    double maxError = 0.0;
+    for (int n = 0; n < input.getNumSamples(); ++n) {
+        maxError = juce::jmax(maxError, std::abs((double) buffer.getSample(0, n) - reference.getSample(0, n)));
+    }
+
+    result.maxErrorDB = juce::Decibels::gainToDecibels(maxError, -300.0);
+    return result;
+}
+
+//What double precision buys at the low cutoffs and high sample rates where float biquads lose accuracy
+static int runPrecisionSuite(const juce::ArgumentList& args) {
+    auto seconds = getSeconds(args);
+    juce::String csv = "sample_rate,lc_freq,chain,ns_per_sample,max_error_db\n";
+
+    std::printf("%10s %8s %12s %12s %16s\n", "rate", "lc freq", "chain", "ns/sample", "max error dBFS");
+
+    for (auto sampleRate : { 48000.0, 192000.0, 384000.0 }) {
+        for (auto lcFreq : { 20.0f, 80.0f }) {
+            ChainSettings chainSettings;
+            chainSettings.lcFreq = lcFreq;
+            chainSettings.hcFreq = (float) juce::jmin(12000.0, sampleRate * 0.45);
+            chainSettings.peakFreq = 1000.0f;
+            chainSettings.peakDB_gain = 6.0f;
+            chainSettings.peakQ = 1.0f;
+            chainSettings.lcSlope = Slope_48;
+            chainSettings.hcSlope = Slope_48;
+
+            auto chainCoefficients = makeChainCoefficients(chainSettings, sampleRate);
+            auto numSamples = juce::jmax(4096, (int) (seconds * sampleRate));
+
+            juce::AudioBuffer<double> input(1, numSamples);
+            juce::Random random(0x5eed);
+            for (int n = 0; n < numSamples; ++n) {
+                input.setSample(0, n, random.nextDouble() * 2.0 - 1.0);
+            }
+
+            juce::AudioBuffer<double> reference(input);
+            MonoChainT<DirectFormEngine, double> referenceChain;
+            prepareChain(referenceChain, chainCoefficients, sampleRate);
+
+            PrecisionResult referenceResult;
+            referenceResult.nsPerSample = processChain(referenceChain, reference);
+
+            std::vector<std::pair<const char*, PrecisionResult>> results {
+                { "double", referenceResult },
+                { "float", measureChain<DirectFormEngine, float>(chainCoefficients, sampleRate, input, reference) },
+                { "float mixed", measureChain<MixedPrecisionEngine, float>(chainCoefficients, sampleRate, input, reference) },
+                { "float svf", measureChain<SVFEngine, float>(chainCoefficients, sampleRate, input, reference) }
+            };
+
+            for (auto& result : results) {
+                std::printf("%10.0f %8.0f %12s %12.3f %16.1f\n", sampleRate, lcFreq, result.first, result.second.nsPerSample,
+                            result.second.maxErrorDB);
+                csv << sampleRate << "," << lcFreq << "," << result.first << "," << result.second.nsPerSample << ","
+                    << result.second.maxErrorDB << "\n";
+            }
+        }
+    }
+
+    //The whole processor, so the double path also pays for the wider host buffers
+    std::printf("\n%10s %6s %18s %18s\n", "rate", "block", "float ns/smp", "double ns/smp");
+    bool anyAllocations = false;
+
+    for (auto sampleRate : { 48000.0, 384000.0 }) {
+        for (auto blockSize : { 64, 512 }) {
+            BenchCase benchCase { sampleRate, blockSize, Slope_48, 0 };
+
+            SimpleEQAudioProcessor processor;
+            processor.setProcessingEngine(getEngine(args));
+            auto singleResult = runCase<float>(processor, benchCase, seconds);
+            auto doubleResult = runCase<double>(processor, benchCase, seconds);
+
+            std::printf("%10.0f %6d %18.3f %18.3f\n", sampleRate, blockSize, singleResult.nsPerSample, doubleResult.nsPerSample);
+            anyAllocations = anyAllocations || singleResult.allocationsPerCall > 0.0 || doubleResult.allocationsPerCall > 0.0;
+        }
+    }
+
+    writeCsv(args, csv);
+    return anyAllocations ? 1 : 0;
+}
+
+//What the callback timing costs, the target is under 1% at every block size
+static int runInstrumentationSuite(const juce::ArgumentList& args) {
+    auto seconds = getSeconds(args);
+    juce::String csv = "block_size,off_ns_per_sample,on_ns_per_sample,overhead_percent\n";
+
+    std::printf("%6s %14s %14s %10s\n", "block", "off ns/smp", "on ns/smp", "overhead");
+
+    for (auto blockSize : { 32, 128, 512, 2048 }) {
+        BenchCase benchCase { 48000.0, blockSize, Slope_48, 0 };
+
+        SimpleEQAudioProcessor processor;
+        processor.setProcessingEngine(getEngine(args));
+
+        //Interleave the runs so clock drift and turbo don't favour either side
+        double offTotal = 0.0, onTotal = 0.0;
+        for (int round = 0; round < 3; ++round) {
+            processor.setInstrumentationEnabled(false);
+            offTotal += runCase(processor, benchCase, seconds).nsPerSample;
+            processor.setInstrumentationEnabled(true);
+            onTotal += runCase(processor, benchCase, seconds).nsPerSample;
+        }
+
+        auto overhead = 100.0 * (onTotal / offTotal - 1.0);
+
+        std::printf("%6d %14.3f %14.3f %9.2f%%\n", blockSize, offTotal / 3.0, onTotal / 3.0, overhead);
+        csv << blockSize << "," << offTotal / 3.0 << "," << onTotal / 3.0 << "," << overhead << "\n";
+
+        if (blockSize == 512) {
+            std::printf("%s\n", processor.getCallbackStats().toJSON().toRawUTF8());
+        }
+    }
+
+    writeCsv(args, csv);
+    return 0;
+}
+
+//Linear phase quality presets, each trades latency and CPU for FIR length
+static int runLinearPhaseSuite(const juce::ArgumentList& args) {
+    auto seconds = getSeconds(args);
+    juce::String csv = "sample_rate,block_size,mode,latency_samples,ns_per_sample\n";
+
+    struct Mode {
+        const char* name;
+        SimpleEQAudioProcessor::PhaseMode phaseMode;
+        LinearPhaseEQ::Quality quality;
+    };
+
+    std::vector<Mode> modes {
+        { "minimum", SimpleEQAudioProcessor::PhaseMode::minimum, LinearPhaseEQ::Quality::standard },
+        { "linear low", SimpleEQAudioProcessor::PhaseMode::linear, LinearPhaseEQ::Quality::low },
+        { "linear standard", SimpleEQAudioProcessor::PhaseMode::linear, LinearPhaseEQ::Quality::standard },
+        { "linear high", SimpleEQAudioProcessor::PhaseMode::linear, LinearPhaseEQ::Quality::high }
+    };
+
+    std::printf("%10s %6s %16s %10s %12s\n", "rate", "block", "mode", "latency", "ns/sample");
+
+    for (auto sampleRate : { 48000.0, 96000.0 }) {
+        for (auto blockSize : { 128, 512 }) {
+            for (auto& mode : modes) {
+                SimpleEQAudioProcessor processor;
+                processor.setPhaseMode(mode.phaseMode, mode.quality);
+
+                //Allocations are not gated here, the FIR loader thread allocates while the timed blocks run
+                BenchCase benchCase { sampleRate, blockSize, Slope_48, 0 };
+                auto result = runCase(processor, benchCase, seconds);
+
+                std::printf("%10.0f %6d %16s %10d %12.3f\n", sampleRate, blockSize, mode.name, processor.getLatencySamples(),
+                            result.nsPerSample);
+                csv << sampleRate << "," << blockSize << "," << mode.name << "," << processor.getLatencySamples() << ","
+                    << result.nsPerSample << "\n";
+            }
+        }
+    }
+
+    writeCsv(args, csv);
+    return 0;
+}
+
+//What each oversampling factor costs, so it can be enabled only where peak cramping matters
+static int runOversamplingSuite(const juce::ArgumentList& args) {
+    auto seconds = getSeconds(args);
+    juce::String csv = "sample_rate,block_size,factor,latency_samples,ns_per_sample,relative_cost\n";
+
+    std::printf("%10s %6s %6s %10s %12s %10s\n", "rate", "block", "factor", "latency", "ns/sample", "vs 1x");
+
+    for (auto sampleRate : { 44100.0, 48000.0 }) {
+        for (auto blockSize : { 64, 512 }) {
+            double baseline = 0.0;
+
+            for (auto factor : { 1, 2, 4, 8 }) {
+                SimpleEQAudioProcessor processor;
+                processor.setProcessingEngine(getEngine(args));
+                processor.setOversamplingFactor(factor);
+
+                BenchCase benchCase { sampleRate, blockSize, Slope_48, 0 };
+                auto result = runCase(processor, benchCase, seconds);
+
+                if (factor == 1) {
+                    baseline = result.nsPerSample;
+                }
+
+                auto relative = result.nsPerSample / baseline;
+
+                std::printf("%10.0f %6d %6d %10d %12.3f %9.2fx\n", sampleRate, blockSize, factor, processor.getLatencySamples(),
+                            result.nsPerSample, relative);
+                csv << sampleRate << "," << blockSize << "," << factor << "," << processor.getLatencySamples() << ","
+                    << result.nsPerSample << "," << relative << "\n";
+            }
+        }
+    }
+
+    writeCsv(args, csv);
+    return 0;
+}
+
+//Silence and all-bypassed blocks should cost next to nothing once the tail has been flushed
+static int runFastPathSuite(const juce::ArgumentList& args) {
+    auto seconds = getSeconds(args);
+    juce::String csv = "block_size,input,ns_per_sample,processed,silent_tail,sleeping,passthrough\n";
+
+    struct Input {
+        const char* name;
+        int bypassMask;
+        bool silent;
+    };
+
+    std::vector<Input> inputs {
+        { "noise", 0, false },
+        { "silence", 0, true },
+        { "bypassed", 7, false }
+    };
+
+    std::printf("%6s %10s %12s %10s %12s %10s %12s\n", "block", "input", "ns/sample", "processed", "silent tail", "sleeping", "passthrough");
+
+    for (auto blockSize : { 64, 512 }) {
+        for (auto& input : inputs) {
+            SimpleEQAudioProcessor processor;
+            processor.setProcessingEngine(getEngine(args));
+
+            BenchCase benchCase { 48000.0, blockSize, Slope_48, input.bypassMask };
+            benchCase.silent = input.silent;
+            auto result = runCase(processor, benchCase, seconds);
+
+            using Path = CallbackMonitor::BlockPath;
+            auto paths = processor.getCallbackStats().blocksByPath;
+            auto count = [&paths](Path path) { return (unsigned long long) paths[(size_t) path]; };
+
+            std::printf("%6d %10s %12.3f %10llu %12llu %10llu %12llu\n", blockSize, input.name, result.nsPerSample,
+                        count(Path::processed), count(Path::silentTail), count(Path::sleeping), count(Path::passthrough));
+            csv << blockSize << "," << input.name << "," << result.nsPerSample << "," << (juce::int64) count(Path::processed) << ","
+                << (juce::int64) count(Path::silentTail) << "," << (juce::int64) count(Path::sleeping) << ","
+                << (juce::int64) count(Path::passthrough) << "\n";
+        }
+    }
+
+    writeCsv(args, csv);
+    return 0;
+}
+
+//Disabled bank bands should cost nothing, enabled ones roughly one biquad each
+static int runBandsSuite(const juce::ArgumentList& args) {
+    auto seconds = getSeconds(args);
+    juce::String csv = "block_size,enabled_bands,ns_per_sample,allocations_per_call\n";
+    bool anyAllocations = false;
+
+    std::printf("%6s %8s %12s %12s\n", "block", "bands", "ns/sample", "allocs/call");
+
+    for (auto blockSize : { 64, 512 }) {
+        for (auto numEnabled : { 0, 4, 8, 16 }) {
+            SimpleEQAudioProcessor processor;
+            processor.setProcessingEngine(getEngine(args));
+
+            for (int band = 0; band < numBankBands; ++band) {
+                setParameter(processor, getBandParameterID(band, BandParameter::gain), band % 2 == 0 ? 3.0f : -3.0f);
+                setParameter(processor, getBandParameterID(band, BandParameter::enabled), band < numEnabled ? 1.0f : 0.0f);
+            }
+
+            BenchCase benchCase { 48000.0, blockSize, Slope_48, 0 };
+            auto result = runCase(processor, benchCase, seconds);
+
+            std::printf("%6d %8d %12.3f %12.3f\n", blockSize, numEnabled, result.nsPerSample, result.allocationsPerCall);
+            csv << blockSize << "," << numEnabled << "," << result.nsPerSample << "," << result.allocationsPerCall << "\n";
+
+            anyAllocations = anyAllocations || result.allocationsPerCall > 0.0;
+        }
+    }
+
+    writeCsv(args, csv);
+    return anyAllocations ? 1 : 0;
+}
+
+//Detection runs once per sub-block for every dynamic band, redesigns only when a gain moved
+static int runDynamicsSuite(const juce::ArgumentList& args) {
+    auto seconds = getSeconds(args);
+    juce::String csv = "block_size,dynamic_bands,ns_per_sample,design_calls_per_block,allocations_per_call\n";
+    bool anyAllocations = false;
+
+    std::printf("%6s %8s %12s %14s %12s\n", "block", "dynamic", "ns/sample", "designs/block", "allocs/call");
+
+    for (auto blockSize : { 64, 512 }) {
+        for (auto numDynamic : { 0, 1, 5, 17 }) {
+            SimpleEQAudioProcessor processor;
+            processor.setProcessingEngine(getEngine(args));
+
+            //The peak first, then bank bands at the peak's default settings
+            setParameter(processor, "PD_dyn", numDynamic > 0 ? 1.0f : 0.0f);
+            setParameter(processor, "PD_thresh", -30.0f);
+
+            for (int band = 0; band < numBankBands; ++band) {
+                auto dynamic = band + 1 < numDynamic;
+                setParameter(processor, getBandParameterID(band, BandParameter::freq), 100.0f * (float) (band + 1));
+                setParameter(processor, getBandParameterID(band, BandParameter::enabled), dynamic ? 1.0f : 0.0f);
+                setParameter(processor, getBandParameterID(band, BandParameter::dynamic), dynamic ? 1.0f : 0.0f);
+            }
+
+            BenchCase benchCase { 48000.0, blockSize, Slope_48, 0 };
+            auto result = runCase(processor, benchCase, seconds);
+            auto stats = processor.getCallbackStats();
+            auto designsPerBlock = stats.numBlocks > 0 ? (double) stats.numRedesigns / (double) stats.numBlocks : 0.0;
+
+            std::printf("%6d %8d %12.3f %14.3f %12.3f\n", blockSize, numDynamic, result.nsPerSample, designsPerBlock, result.allocationsPerCall);
+            csv << blockSize << "," << numDynamic << "," << result.nsPerSample << "," << designsPerBlock << "," << result.allocationsPerCall << "\n";
+
+            anyAllocations = anyAllocations || result.allocationsPerCall > 0.0;
+        }
+    }
+
+    writeCsv(args, csv);
+    return anyAllocations ? 1 : 0;
+}
+
+//Left and right, or mid and side, get clearly different settings so a lane mix-up shows in the difference
+static void applyStereoCase(SimpleEQAudioProcessor& processor, StereoMode mode) {
+    setParameter(processor, "ST_mode", (float) mode);
+    setParameter(processor, "LC_freq_2", 250.0f);
+    setParameter(processor, "LC_slope8_2", (float) Slope_96);
+    setParameter(processor, "PD_freq_2", 3000.0f);
+    setParameter(processor, "PD_gain_2", -9.0f);
+    setParameter(processor, "HC_slope8_2", (float) Slope_12);
+    setParameter(processor, "HC_bp_2", 1.0f);
+
+    setParameter(processor, getBandParameterID(0, BandParameter::gain), 4.0f);
+    setParameter(processor, getBandParameterID(0, BandParameter::enabled), 1.0f);
+}
+
+//Largest difference between the two engines on the same stereo noise, one 512 sample block at a time
+static float measureStereoEngineDifference(StereoMode mode) {
+    constexpr int blockSize = 512;
+    constexpr int numBlocks = 32;
+
+    std::array<SimpleEQAudioProcessor, 2> processors;
+    std::array<juce::AudioBuffer<float>, 2> buffers;
+    juce::MidiBuffer midi;
+
+    processors[0].setProcessingEngine(SimpleEQAudioProcessor::ProcessingEngine::scalar);
+    processors[1].setProcessingEngine(SimpleEQAudioProcessor::ProcessingEngine::vectorised);
+
+    for (auto& processor : processors) {
+        processor.setPlayConfigDetails(2, 2, 48000.0, blockSize);
+        processor.prepareToPlay(48000.0, blockSize);
+        applyCase(processor, { 48000.0, blockSize, Slope_48, 0 });
+        applyStereoCase(processor, mode);
+    }
+
+    juce::Random random(0x5eed);
+    float maxDifference = 0.0f;
+
+    for (int block = 0; block < numBlocks; ++block) {
+        buffers[0].setSize(2, blockSize, false, false, true);
+        for (int ch = 0; ch < 2; ++ch) {
+            for (int n = 0; n < blockSize; ++n) {
+                buffers[0].setSample(ch, n, random.nextFloat() * 2.0f - 1.0f);
+            }
+        }
+        buffers[1].makeCopyOf(buffers[0]);
+
+        for (size_t i = 0; i < processors.size(); ++i) {
+            processors[i].processBlock(buffers[i], midi);
+        }
+
+        for (int ch = 0; ch < 2; ++ch) {
+            for (int n = 0; n < blockSize; ++n) {
+                maxDifference = juce::jmax(maxDifference, std::abs(buffers[0].getSample(ch, n) - buffers[1].getSample(ch, n)));
+            }
+        }
+    }
+
+    return maxDifference;
+}
+
+//Split modes run in the same vectorised pass as linked, with mid/side folded into the interleave
+static int runStereoSuite(const juce::ArgumentList& args) {
+    auto seconds = getSeconds(args);
+    juce::String csv = "block_size,mode,scalar_ns_per_sample,vectorised_ns_per_sample,max_engine_difference,allocations_per_call\n";
+    bool anyAllocations = false;
+    bool anyMismatch = false;
+
+    const char* modeNames[] { "linked", "left/right", "mid/side", "mid only", "side only" };
+
+    std::printf("%6s %10s %12s %12s %14s %12s\n", "block", "mode", "scalar ns", "vector ns", "max diff", "allocs/call");
+
+    for (auto blockSize : { 64, 512 }) {
+        for (int mode = 0; mode < numStereoModes; ++mode) {
+            std::array<BenchResult, 2> results;
+
+            for (auto engine : { SimpleEQAudioProcessor::ProcessingEngine::scalar, SimpleEQAudioProcessor::ProcessingEngine::vectorised }) {
+                SimpleEQAudioProcessor processor;
+                processor.setProcessingEngine(engine);
+                applyStereoCase(processor, (StereoMode) mode);
+
+                BenchCase benchCase { 48000.0, blockSize, Slope_48, 0 };
+                results[(size_t) engine] = runCase(processor, benchCase, seconds);
+            }
+
+            auto difference = measureStereoEngineDifference((StereoMode) mode);
+            auto allocations = juce::jmax(results[0].allocationsPerCall, results[1].allocationsPerCall);
+
+            std::printf("%6d %10s %12.3f %12.3f %14.3g %12.3f\n", blockSize, modeNames[mode], results[0].nsPerSample, results[1].nsPerSample,
+                        (double) difference, allocations);
+            csv << blockSize << "," << modeNames[mode] << "," << results[0].nsPerSample << "," << results[1].nsPerSample << ","
+                << difference << "," << allocations << "\n";
+
+            anyAllocations = anyAllocations || allocations > 0.0;
+            anyMismatch = anyMismatch || difference > SimpleEQAudioProcessor::defaultEngineTolerance;
+        }
+    }
+
+    writeCsv(args, csv);
+    return anyAllocations || anyMismatch ? 1 : 0;
+}
+
+//Random presets over the three bands and one bank band, saved through addPreset like a user would
+static void fillPresetBank(SimpleEQAudioProcessor& processor, int numPresets) {
+    juce::Random random(0x5eed);
+
+    for (int i = 0; i < numPresets; ++i) {
+        setParameter(processor, "LC_freq", 20.0f + 180.0f * random.nextFloat());
+        setParameter(processor, "HC_freq", 4000.0f + 16000.0f * random.nextFloat());
+        setParameter(processor, "PD_freq", 60.0f + 500.0f * random.nextFloat());
+        setParameter(processor, "PD_gain", -18.0f + 36.0f * random.nextFloat());
+        setParameter(processor, "PD_q", 0.5f + 4.0f * random.nextFloat());
+        setParameter(processor, "LC_slope8", (float) random.nextInt(maxCutStages));
+        setParameter(processor, "HC_slope8", (float) random.nextInt(maxCutStages));
+        setParameter(processor, getBandParameterID(0, BandParameter::enabled), 1.0f);
+        setParameter(processor, getBandParameterID(0, BandParameter::gain), -12.0f + 24.0f * random.nextFloat());
+
+        processor.addPreset("Preset " + juce::String(i + 1));
+    }
+}
+
+struct SwitchResult {
+    double switchMicros {0.0};  //setCurrentProgram on this thread, the designs included
+    double nsPerSample {0.0};
+    double maxStep {0.0};       //Largest difference between neighbouring output samples
+    double allocationsPerCall {0.0};
+};
+
+//An 80 Hz sine, whose own steps stay under 0.003, through a program change every blocksPerSwitch blocks
+static SwitchResult measurePresetSwitching(const juce::File& bankFile, double crossfadeSeconds, int blocksPerSwitch, double seconds,
+                                           SimpleEQAudioProcessor::ProcessingEngine engine) {
+    constexpr double sampleRate = 48000.0;
+    constexpr int blockSize = 512;
+
+    SimpleEQAudioProcessor processor;
+    processor.setProcessingEngine(engine);
+    processor.setPresetCrossfade(crossfadeSeconds);
+    processor.loadPresetBank(bankFile);
+    processor.setPlayConfigDetails(2, 2, sampleRate, blockSize);
+    processor.prepareToPlay(sampleRate, blockSize);
+
+    juce::AudioBuffer<float> buffer(2, blockSize);
+    juce::MidiBuffer midi;
+
+    auto numCalls = juce::jmax(64, (int) (seconds * sampleRate / blockSize));
+    auto phaseIncrement = juce::MathConstants<double>::twoPi * 80.0 / sampleRate;
+    auto phase = 0.0;
+
+    std::array<float, 2> previous {};
+    juce::int64 switchTicks = 0, processTicks = 0;
+    int numSwitches = 0;
+
+    SwitchResult result;
+    numAllocations = 0;
+
+    for (int i = 0; i < numCalls; ++i) {
+        if (blocksPerSwitch > 0 && i % blocksPerSwitch == 0) {
+            auto startTicks = juce::Time::getHighResolutionTicks();
+            processor.setCurrentProgram((i / blocksPerSwitch) % processor.getNumPrograms());
+            switchTicks += juce::Time::getHighResolutionTicks() - startTicks;
+            ++numSwitches;
+        }
+
+        for (int n = 0; n < blockSize; ++n) {
+            auto sample = (float) (0.25 * std::sin(phase));
+            buffer.setSample(0, n, sample);
+            buffer.setSample(1, n, sample);
+            phase += phaseIncrement;
+        }
+
+        countAllocations = true;
+        auto startTicks = juce::Time::getHighResolutionTicks();
+
+        processor.processBlock(buffer, midi);
+
+        processTicks += juce::Time::getHighResolutionTicks() - startTicks;
+        countAllocations = false;
+
+        for (int ch = 0; ch < 2; ++ch) {
+            for (int n = 0; n < blockSize; ++n) {
+                auto sample = buffer.getSample(ch, n);
+
+                //The first few blocks are the filters starting up on the sine
+                if (i >= 8) {
+                    result.maxStep = juce::jmax(result.maxStep, (double) std::abs(sample - previous[(size_t) ch]));
+                }
+                previous[(size_t) ch] = sample;
+            }
+        }
+    }
+
+    result.switchMicros = numSwitches > 0 ? juce::Time::highResolutionTicksToSeconds(switchTicks) * 1.0e6 / numSwitches : 0.0;
+    result.nsPerSample = juce::Time::highResolutionTicksToSeconds(processTicks) * 1.0e9 / ((double) numCalls * blockSize);
+    result.allocationsPerCall = (double) numAllocations.load() / numCalls;
+    return result;
+}
+
+//Three programs a few blocks apart, each after the last one's fade has finished. The last second of the render is
+//held against one that started on the final program, so a switch that never landed shows up however smooth it is.
+static double measureBackToBackSwitches(const juce::File& bankFile, SimpleEQAudioProcessor::ProcessingEngine engine) {
+    constexpr double sampleRate = 48000.0;
+    constexpr int blockSize = 512;
+    constexpr int numCalls = 375;
+    constexpr int comparedCalls = 94;
+
+    SimpleEQAudioProcessor switched, reference;
+    for (auto* processor : { &switched, &reference }) {
+        processor->setProcessingEngine(engine);
+        processor->setPresetCrossfade(0.005);
+        processor->loadPresetBank(bankFile);
+        processor->setPlayConfigDetails(2, 2, sampleRate, blockSize);
+    }
+
+    switched.setCurrentProgram(0);
+    reference.setCurrentProgram(2);
+    switched.prepareToPlay(sampleRate, blockSize);
+    reference.prepareToPlay(sampleRate, blockSize);
+
+    juce::AudioBuffer<float> switchedBuffer(2, blockSize), referenceBuffer(2, blockSize);
+    juce::MidiBuffer midi;
+
+    auto phaseIncrement = juce::MathConstants<double>::twoPi * 80.0 / sampleRate;
+    auto phase = 0.0;
+    auto maxDifference = 0.0;
+
+    for (int i = 0; i < numCalls; ++i) {
+        if (i == 8 || i == 16) {
+            switched.setCurrentProgram(i / 8);
+        }
+
+        for (int n = 0; n < blockSize; ++n) {
+            auto sample = (float) (0.25 * std::sin(phase));
+            for (int ch = 0; ch < 2; ++ch) {
+                switchedBuffer.setSample(ch, n, sample);
+                referenceBuffer.setSample(ch, n, sample);
+            }
+            phase += phaseIncrement;
+        }
+
+        switched.processBlock(switchedBuffer, midi);
+        reference.processBlock(referenceBuffer, midi);
+
+        if (i >= numCalls - comparedCalls) {
+            for (int ch = 0; ch < 2; ++ch) {
+                for (int n = 0; n < blockSize; ++n) {
+                    maxDifference = juce::jmax(maxDifference, (double) std::abs(switchedBuffer.getSample(ch, n) - referenceBuffer.getSample(ch, n)));
+                }
+            }
+        }
+    }
+
+    return maxDifference;
+}
+
+static int runPresetSuite(const juce::ArgumentList& args) {
+    auto seconds = getSeconds(args);
+    auto bankFile = juce::File::createTempFile(".seqbank");
+    constexpr int numPresets = 256;
+
+    {
+        SimpleEQAudioProcessor author;
+        fillPresetBank(author, numPresets);
+
+        if (! author.savePresetBank(bankFile)) {
+            std::fprintf(stderr, "Can't write %s\n", bankFile.getFullPathName().toRawUTF8());
+            return 1;
+        }
+    }
+
+    SimpleEQAudioProcessor loader;
+    auto loadStart = juce::Time::getHighResolutionTicks();
+    auto loaded = loader.loadPresetBank(bankFile);
+    auto loadMicros = juce::Time::highResolutionTicksToSeconds(juce::Time::getHighResolutionTicks() - loadStart) * 1.0e6;
+
+    std::printf("%d presets, %lld bytes, loaded in %.1f us\n\n", loaded ? loader.getNumPrograms() : 0, (long long) bankFile.getSize(), loadMicros);
+
+    juce::String csv = "crossfade_ms,blocks_per_switch,switch_us,ns_per_sample,max_step,allocations_per_call\n";
+    bool anyAllocations = ! loaded;
+
+    std::printf("%10s %8s %12s %12s %10s %12s\n", "fade ms", "every", "switch us", "ns/sample", "max step", "allocs/call");
+
+    for (auto crossfadeMs : { 0.0, 5.0, 20.0 }) {
+        for (auto blocksPerSwitch : { 0, 1, 8 }) {
+            auto result = measurePresetSwitching(bankFile, crossfadeMs / 1000.0, blocksPerSwitch, seconds, getEngine(args));
+            auto every = blocksPerSwitch > 0 ? juce::String(blocksPerSwitch) : juce::String("never");
+
+            std::printf("%10.1f %8s %12.2f %12.3f %10.4f %12.3f\n", crossfadeMs, every.toRawUTF8(), result.switchMicros, result.nsPerSample,
+                        result.maxStep, result.allocationsPerCall);
+            csv << crossfadeMs << "," << blocksPerSwitch << "," << result.switchMicros << "," << result.nsPerSample << ","
+                << result.maxStep << "," << result.allocationsPerCall << "\n";
+
+            anyAllocations = anyAllocations || result.allocationsPerCall > 0.0;
+        }
+    }
+
+    //A frozen filter passes the max step check, so the last of several switches has to be heard
+    auto backToBackDifference = measureBackToBackSwitches(bankFile, getEngine(args));
+    auto backToBackLanded = backToBackDifference < 1.0e-3;
+    std::printf("\nback to back switches: %.2e from a render started on the last program%s\n", backToBackDifference,
+                backToBackLanded ? "" : ", the last switch didn't land");
+
+    bankFile.deleteFile();
+    writeCsv(args, csv);
+    return anyAllocations || ! backToBackLanded ? 1 : 0;
+}
+
+//Live threads in the process where that's cheap to ask, -1 elsewhere
+static int countProcessThreads() {
+   #if JUCE_LINUX
+    juce::StringArray lines;
+    juce::File("/proc/self/status").readLines(lines);
+
+    for (auto& line : lines) {
+        if (line.startsWith("Threads:")) {
+            return line.fromFirstOccurrenceOf(":", false, false).trim().getIntValue();
+        }
+    }
+   #endif
+
+    return -1;
+}
+
+//Many instances automating the same sweep, to show the threads and designs they share through the service
+static int runInstancesSuite(const juce::ArgumentList& args) {
+    auto seconds = getSeconds(args);
+    constexpr int numChannels = 2;
+    constexpr double sampleRate = 48000.0;
+    constexpr int blockSize = 256;
+
+    //Held across rounds so the counters carry on, each round reports its own share of them
+    juce::SharedResourcePointer<SharedDesignService> service;
+
+    juce::String csv = "mode,instances,threads,ns_per_sample_per_instance,hit_rate,coefficient_requests,coefficient_designs,"
+                       "fir_requests,fir_designs,table_bytes,allocations_per_call\n";
+    bool anyAllocations = false;
+
+    std::printf("%8s %9s %7s %14s %8s %10s %10s %8s %8s %10s %12s\n", "mode", "instances", "threads", "ns/sample/inst", "hit rate",
+                "requests", "designs", "firs", "fir runs", "table", "allocs/call");
+
+    for (auto linear : { false, true }) {
+        for (auto numInstances : { 1, 4, 16, 64 }) {
+            //Every linear phase instance holds its own FIR partitions, 16 of them is plenty to see the sharing
+            if (linear && numInstances > 16) {
+                continue;
+            }
+
+            auto before = service->getStats();
+            BenchCase benchCase { sampleRate, blockSize, Slope_48, 0 };
+            std::vector<std::unique_ptr<SimpleEQAudioProcessor>> processors;
+
+            for (int i = 0; i < numInstances; ++i) {
+                auto processor = std::make_unique<SimpleEQAudioProcessor>();
+                processor->setProcessingEngine(getEngine(args));
+                processor->setPhaseMode(linear ? SimpleEQAudioProcessor::PhaseMode::linear : SimpleEQAudioProcessor::PhaseMode::minimum,
+                                        LinearPhaseEQ::Quality::low);
+                processor->setPlayConfigDetails(numChannels, numChannels, sampleRate, blockSize);
+                processor->prepareToPlay(sampleRate, blockSize);
+                applyCase(*processor, benchCase);
+                processors.push_back(std::move(processor));
+            }
+
+            auto numThreads = countProcessThreads();
+            auto tableBytes = service->getStats().tableBytes;
+
+            juce::AudioBuffer<float> noise(numChannels, blockSize);
+            juce::AudioBuffer<float> buffer(numChannels, blockSize);
+            juce::MidiBuffer midi;
+            juce::Random random(0x5eed);
+
+            for (int ch = 0; ch < numChannels; ++ch) {
+                for (int n = 0; n < blockSize; ++n) {
+                    noise.setSample(ch, n, random.nextFloat() * 2.0f - 1.0f);
+                }
+            }
+
+            auto numCalls = juce::jmax(16, (int) (seconds * sampleRate / blockSize));
+            juce::int64 ticks = 0;
+            numAllocations = 0;
+
+            for (int i = 0; i < numCalls; ++i) {
+                auto phase = (float) i / (float) numCalls;
+
+                for (auto& processor : processors) {
+                    setParameter(*processor, "LC_freq", 20.0f + 480.0f * phase);
+                    setParameter(*processor, "PD_gain", -12.0f + 24.0f * phase);
+                    buffer.makeCopyOf(noise, true);
+
+                    //The FIR loads allocate on the service's threads while linear phase blocks run, so only minimum phase is counted
+                    countAllocations = ! linear;
+                    auto startTicks = juce::Time::getHighResolutionTicks();
+
+                    processor->processBlock(buffer, midi);
+
+                    ticks += juce::Time::getHighResolutionTicks() - startTicks;
+                    countAllocations = false;
+                }
+            }
+
+            juce::uint64 hits = 0, misses = 0;
+            for (auto& processor : processors) {
+                auto cacheStats = processor->getCoefficientCacheStats();
+                hits += cacheStats.hits;
+                misses += cacheStats.misses;
+                processor->releaseResources();
+            }
+
+            processors.clear();
+            auto after = service->getStats();
+
+            auto nsPerSample = juce::Time::highResolutionTicksToSeconds(ticks) * 1.0e9 / ((double) numCalls * blockSize * numInstances);
+            auto hitRate = hits + misses > 0 ? (double) hits / (double) (hits + misses) : 0.0;
+            auto allocationsPerCall = (double) numAllocations.load() / ((double) numCalls * numInstances);
+            auto requests = after.coefficientRequests - before.coefficientRequests;
+            auto designs = after.coefficientDesigns - before.coefficientDesigns;
+            auto firRequests = after.firRequests - before.firRequests;
+            auto firDesigns = after.firDesigns - before.firDesigns;
+            auto* mode = linear ? "linear" : "minimum";
+
+            std::printf("%8s %9d %7d %14.3f %7.1f%% %10llu %10llu %8llu %8llu %9.0fk %12.3f\n", mode, numInstances, numThreads, nsPerSample,
+                        100.0 * hitRate, (unsigned long long) requests, (unsigned long long) designs, (unsigned long long) firRequests,
+                        (unsigned long long) firDesigns, (double) tableBytes / 1024.0, allocationsPerCall);
+            csv << mode << "," << numInstances << "," << numThreads << "," << nsPerSample << "," << hitRate << "," << (juce::int64) requests << ","
+                << (juce::int64) designs << "," << (juce::int64) firRequests << "," << (juce::int64) firDesigns << "," << (juce::int64) tableBytes
+                << "," << allocationsPerCall << "\n";
+
+            anyAllocations = anyAllocations || allocationsPerCall > 0.0;
+        }
+    }
+
+    writeCsv(args, csv);
+    return anyAllocations ? 1 : 0;
+}
+
+//An automation lane in samples from the start of the render, off any power of two so it falls between grid lines
+struct AutomationPoint {
+    juce::int64 position;
+    const char* parameterID;
+    float value;
+};
+
+static std::vector<AutomationPoint> makeAutomationLane(juce::int64 numSamples) {
+    std::vector<AutomationPoint> lane;
+    juce::Random random(0x1a7e);
+
+    for (juce::int64 position = 0; position < numSamples; position += 300) {
+        lane.push_back({ position, "LC_freq", 20.0f + 480.0f * random.nextFloat() });
+        lane.push_back({ position, "PD_gain", -12.0f + 24.0f * random.nextFloat() });
+
+        if (position % 4800 == 0) {
+            lane.push_back({ position, "HC_slope8", (float) random.nextInt(maxCutStages) });
+            lane.push_back({ position, "PD_bp", random.nextBool() ? 1.0f : 0.0f });
+        }
+    }
+
+    return lane;
+}
+
+struct AutomationRender {
+    juce::AudioBuffer<float> output;
+    double nsPerSample {0.0};
+    double allocationsPerCall {0.0};
+    bool scheduled {true};
+};
+
+//A block boundary at every buffer size the automation suite runs, 3.2 s in
+static constexpr int snapshotRecallPosition = 153600;
+
+//Hands every change inside a block over before it, the way a host that knows its automation would. Recalls the
+//settings from the start as a snapshot at snapshotRecallPosition, between two blocks.
+static AutomationRender renderAutomation(const juce::AudioBuffer<float>& input, const std::vector<AutomationPoint>& lane, int blockSize,
+                                         bool sampleAccurate, SimpleEQAudioProcessor::ProcessingEngine engine) {
+    constexpr double sampleRate = 48000.0;
+    auto numChannels = input.getNumChannels();
+    auto numSamples = input.getNumSamples();
+
+    SimpleEQAudioProcessor processor;
+    processor.setProcessingEngine(engine);
+    processor.setSampleAccurateAutomation(sampleAccurate, 32);
+    processor.setPlayConfigDetails(numChannels, numChannels, sampleRate, blockSize);
+    processor.prepareToPlay(sampleRate, blockSize);
+    processor.storeSnapshot(0);
+
+    AutomationRender render;
+    render.output.setSize(numChannels, numSamples);
+
+    juce::AudioBuffer<float> buffer(numChannels, blockSize);
+    juce::MidiBuffer midi;
+    size_t next = 0;
+    juce::int64 ticks = 0;
+    int numCalls = 0;
+    numAllocations = 0;
+
+    for (int start = 0; start < numSamples; start += blockSize) {
+        auto length = juce::jmin(blockSize, numSamples - start);
+
+        if (start == snapshotRecallPosition) {
+            processor.recallSnapshot(0);
+        }
+
+        for (; next < lane.size() && lane[next].position < start + length; ++next) {
+            render.scheduled = processor.scheduleParameterChange(lane[next].parameterID, lane[next].value, lane[next].position) && render.scheduled;
+        }
+
+        buffer.setSize(numChannels, length, false, false, true);
+        for (int ch = 0; ch < numChannels; ++ch) {
+            buffer.copyFrom(ch, 0, input, ch, start, length);
+        }
+
+        countAllocations = true;
+        auto startTicks = juce::Time::getHighResolutionTicks();
+
+        processor.processBlock(buffer, midi);
+
+        ticks += juce::Time::getHighResolutionTicks() - startTicks;
+        countAllocations = false;
+        ++numCalls;
+
+        for (int ch = 0; ch < numChannels; ++ch) {
+            render.output.copyFrom(ch, start, buffer, ch, 0, length);
+        }
+    }
+
+    processor.releaseResources();
+
+    render.nsPerSample = juce::Time::highResolutionTicksToSeconds(ticks) * 1.0e9 / numSamples;
+    render.allocationsPerCall = (double) numAllocations.load() / numCalls;
+    return render;
+}
+
+static float getMaxDifference(const juce::AudioBuffer<float>& a, const juce::AudioBuffer<float>& b) {
+    float maxDifference = 0.0f;
+
+    for (int ch = 0; ch < a.getNumChannels(); ++ch) {
+        for (int n = 0; n < a.getNumSamples(); ++n) {
+            maxDifference = juce::jmax(maxDifference, std::abs(a.getSample(ch, n) - b.getSample(ch, n)));
+        }
+    }
+
+    return maxDifference;
+}
+
+//The same automated render at several buffer sizes, whole-block against sample accurate, with a snapshot recalled
+//part way through
+static int runAutomationSuite(const juce::ArgumentList& args) {
+    constexpr int numChannels = 2;
+    auto numSamples = (int) (juce::jmax(1.0, getSeconds(args) * 8.0) * 48000.0);
+
+    juce::AudioBuffer<float> input(numChannels, numSamples);
+    juce::Random random(0x5eed);
+    for (int ch = 0; ch < numChannels; ++ch) {
+        for (int n = 0; n < numSamples; ++n) {
+            input.setSample(ch, n, random.nextFloat() * 2.0f - 1.0f);
+        }
+    }
+
+    juce::String csv = "lane,mode,block_size,ns_per_sample,max_difference,identical,allocations_per_call\n";
+    bool failed = false;
+
+    std::printf("%10s %14s %6s %12s %14s %10s %12s\n", "lane", "mode", "block", "ns/sample", "vs block 32", "identical", "allocs/call");
+
+    for (auto automated : { true, false }) {
+        auto lane = automated ? makeAutomationLane(numSamples) : std::vector<AutomationPoint>();
+
+        for (auto sampleAccurate : { false, true }) {
+            juce::AudioBuffer<float> reference;
+
+            for (auto blockSize : { 32, 64, 100, 256, 480, 512, 1024 }) {
+                auto render = renderAutomation(input, lane, blockSize, sampleAccurate, getEngine(args));
+
+                if (blockSize == 32) {
+                    reference.makeCopyOf(render.output);
+                }
+
+                auto maxDifference = getMaxDifference(reference, render.output);
+                auto identical = maxDifference == 0.0f;
+                auto* laneName = automated ? "automated" : "static";
+                auto* mode = sampleAccurate ? "sample exact" : "whole block";
+
+                std::printf("%10s %14s %6d %12.3f %14.3g %10s %12.3f\n", laneName, mode, blockSize, render.nsPerSample, maxDifference,
+                            identical ? "yes" : "no", render.allocationsPerCall);
+                csv << laneName << "," << mode << "," << blockSize << "," << render.nsPerSample << "," << maxDifference << ","
+                    << (identical ? 1 : 0) << "," << render.allocationsPerCall << "\n";
+
+                //Whole-block renders are expected to move with the buffer size, sample accurate ones never
+                failed = failed || ! render.scheduled || render.allocationsPerCall > 0.0 || (sampleAccurate && ! identical);
+            }
+        }
+    }
+
+    writeCsv(args, csv);
+    return failed ? 1 : 0;
+}
+
+//Two seconds of stereo noise through the cuts alone, the peak bypassed, on one cut kernel
+static juce::AudioBuffer<float> renderCuts(CascadeKernel kernel, SimpleEQAudioProcessor::ProcessingEngine engine, const BenchCase& benchCase,
+                                          int oversamplingFactor) {
+    constexpr int numChannels = 2;
+    auto numSamples = (int) (benchCase.sampleRate * 2.0);
+
+    SimpleEQAudioProcessor processor;
+    processor.setProcessingEngine(engine);
+    processor.setCutKernel(kernel);
+    processor.setOversamplingFactor(oversamplingFactor);
+    processor.setPlayConfigDetails(numChannels, numChannels, benchCase.sampleRate, benchCase.blockSize);
+    processor.prepareToPlay(benchCase.sampleRate, benchCase.blockSize);
+    applyCase(processor, benchCase);
+
+    juce::AudioBuffer<float> buffer(numChannels, numSamples);
+    juce::Random random(0x5eed);
+    for (int ch = 0; ch < numChannels; ++ch) {
+        for (int n = 0; n < numSamples; ++n) {
+            buffer.setSample(ch, n, random.nextFloat() * 2.0f - 1.0f);
+        }
+    }
+
+    juce::MidiBuffer midi;
+    for (int start = 0; start < numSamples; start += benchCase.blockSize) {
+        juce::AudioBuffer<float> block(buffer.getArrayOfWritePointers(), numChannels, start, juce::jmin(benchCase.blockSize, numSamples - start));
+        processor.processBlock(block, midi);
+    }
+
+    processor.releaseResources();
+    return buffer;
+}
+
+static bool isFinite(const juce::AudioBuffer<float>& buffer) {
+    for (int ch = 0; ch < buffer.getNumChannels(); ++ch) {
+        for (int n = 0; n < buffer.getNumSamples(); ++n) {
+            if (! std::isfinite(buffer.getSample(ch, n))) {
+                return false;
+            }
+        }
+    }
+
+    return true;
+}
+
+//The per-sample and block state-space cut kernels on the same settled cuts, what automatic makes of them, and how
+//far apart the two kernels' renders land. The last cases put a 20 Hz low cut at 8x oversampling of 96 kHz, too close
+//to DC for the block form in float, where both block settings have to fall back to the per-sample loop.
+//Fails on allocations, on a render that isn't finite, or on kernels further apart than --kernel-tolerance, default 1e-2.
+static int runCascadeSuite(const juce::ArgumentList& args) {
+    auto seconds = getSeconds(args);
+    auto engine = getEngine(args);
+    auto tolerance = args.containsOption("--kernel-tolerance") ? args.getValueForOption("--kernel-tolerance").getFloatValue() : 1.0e-2f;
+
+    struct CascadeCase {
+        BenchCase benchCase;
+        int oversamplingFactor;
+    };
+
+    std::vector<CascadeCase> cases;
+    for (auto blockSize : { 64, 512 }) {
+        for (auto slope : { Slope_12, Slope_24, Slope_36, Slope_48, Slope_72, Slope_96 }) {
+            cases.push_back({ { 48000.0, blockSize, slope, 2 }, 1 });
+        }
+    }
+    for (auto slope : { Slope_48, Slope_72, Slope_96 }) {
+        BenchCase benchCase { 96000.0, 512, slope, 2 };
+        benchCase.lcFreq = 20.0f;
+        cases.push_back({ benchCase, 8 });
+    }
+
+    juce::String csv = "sample_rate,oversampling,lc_freq,block_size,slope,per_sample_ns_per_sample,block_ns_per_sample,automatic_ns_per_sample,"
+                       "speedup,max_difference,finite,allocations_per_call\n";
+    bool failed = false;
+
+    std::printf("%8s %4s %6s %6s %6s %16s %12s %12s %8s %14s %7s %12s\n", "rate", "os", "lc Hz", "block", "slope", "per-sample ns",
+                "block ns", "auto ns", "speedup", "max diff", "finite", "allocs/call");
+
+    for (auto& cascadeCase : cases) {
+        auto& benchCase = cascadeCase.benchCase;
+        BenchResult results[3];
+        CascadeKernel kernels[] { CascadeKernel::perSample, CascadeKernel::block, CascadeKernel::automatic };
+
+        for (size_t i = 0; i < 3; ++i) {
+            SimpleEQAudioProcessor processor;
+            processor.setProcessingEngine(engine);
+            processor.setCutKernel(kernels[i]);
+            processor.setOversamplingFactor(cascadeCase.oversamplingFactor);
+            results[i] = runCase(processor, benchCase, seconds);
+        }
+
+        auto perSample = renderCuts(CascadeKernel::perSample, engine, benchCase, cascadeCase.oversamplingFactor);
+        auto block = renderCuts(CascadeKernel::block, engine, benchCase, cascadeCase.oversamplingFactor);
+        auto automatic = renderCuts(CascadeKernel::automatic, engine, benchCase, cascadeCase.oversamplingFactor);
+
+        auto finite = isFinite(perSample) && isFinite(block) && isFinite(automatic);
+        auto maxDifference = juce::jmax(getMaxDifference(perSample, block), getMaxDifference(perSample, automatic));
+        auto speedup = results[0].nsPerSample / results[1].nsPerSample;
+        auto allocations = juce::jmax(results[0].allocationsPerCall, results[1].allocationsPerCall, results[2].allocationsPerCall);
+        auto slopeDB = 12 * (benchCase.slope + 1);
+
+        std::printf("%8.0f %4d %6.0f %6d %6d %16.3f %12.3f %12.3f %7.2fx %14.3g %7s %12.3f\n", benchCase.sampleRate,
+                    cascadeCase.oversamplingFactor, benchCase.lcFreq, benchCase.blockSize, slopeDB, results[0].nsPerSample,
+                    results[1].nsPerSample, results[2].nsPerSample, speedup, maxDifference, finite ? "yes" : "no", allocations);
+        csv << benchCase.sampleRate << "," << cascadeCase.oversamplingFactor << "," << benchCase.lcFreq << "," << benchCase.blockSize << ","
+            << slopeDB << "," << results[0].nsPerSample << "," << results[1].nsPerSample << "," << results[2].nsPerSample << ","
+            << speedup << "," << maxDifference << "," << (finite ? 1 : 0) << "," << allocations << "\n";
+
+        failed = failed || allocations > 0.0 || ! finite || ! (maxDifference <= tolerance);
+    }
+
+    writeCsv(args, csv);
+    return failed ? 1 : 0;
+}
+
+static int runGridSuite(const juce::ArgumentList& args) {
+    auto quick = args.containsOption("--quick");
+    auto seconds = getSeconds(args);
+    auto engine = getEngine(args);
+
+    std::vector<double> sampleRates { 44100.0, 48000.0, 96000.0, 192000.0, 384000.0 };
+    std::vector<int> blockSizes { 16, 32, 64, 128, 256, 512, 1024, 2048, 4096 };
+    std::vector<int> slopes { Slope_12, Slope_24, Slope_36, Slope_48, Slope_60, Slope_72, Slope_84, Slope_96 };
+    std::vector<int> bypassMasks { 0, 1, 2, 3, 4, 5, 6, 7 };
+
+    if (quick) {
+        sampleRates = { 48000.0 };
+        blockSizes = { 32, 512 };
+        slopes = { Slope_12, Slope_48, Slope_96 };
+        bypassMasks = { 0, 7 };
+    }
+
+    juce::String csv = "sample_rate,block_size,slope,bypass_mask,ns_per_sample,cycles_per_sample,allocations_per_call\n";
+    bool anyAllocations = false;
+
+    SimpleEQAudioProcessor processor;
+    processor.setProcessingEngine(engine);
+
+    std::printf("%10s %6s %6s %6s %14s %18s %12s\n", "rate", "block", "slope", "bypass", "ns/sample", "cycles/sample", "allocs/call");
+
+    for (auto sampleRate : sampleRates) {
+        for (auto blockSize : blockSizes) {
+            for (auto slope : slopes) {
+                for (auto bypassMask : bypassMasks) {
+                    BenchCase benchCase { sampleRate, blockSize, slope, bypassMask };
+                    auto result = runCase(processor, benchCase, seconds);
+
+                    std::printf("%10.0f %6d %6d %6d %14.3f %18.3f %12.3f\n", sampleRate, blockSize, 12 * (slope + 1), bypassMask,
+                                result.nsPerSample, result.cyclesPerSample, result.allocationsPerCall);
+
+                    csv << sampleRate << "," << blockSize << "," << 12 * (slope + 1) << "," << bypassMask << ","
+                        << result.nsPerSample << "," << result.cyclesPerSample << "," << result.allocationsPerCall << "\n";
+
+                    anyAllocations = anyAllocations || result.allocationsPerCall > 0.0;
+                }
+            }
+        }
+    }
+
+    writeCsv(args, csv);
+
+    //Non-zero exit so CI can gate on allocations in the audio path
+    return anyAllocations ? 1 : 0;
+}
+
+int main(int argc, char* argv[]) {
+    juce::ScopedJuceInitialiser_GUI juceInitialiser;
+    juce::ArgumentList args(argc, argv);
+
+    auto suite = args.getValueForOption("--suite");
+
+    if (suite == "smoothing") {
+        return runSmoothingSuite(args);
+    }
+    if (suite == "precision") {
+        return runPrecisionSuite(args);
+    }
+    if (suite == "instrumentation") {
+        return runInstrumentationSuite(args);
+    }
+    if (suite == "linearphase") {
+        return runLinearPhaseSuite(args);
+    }
+    if (suite == "oversampling") {
+        return runOversamplingSuite(args);
+    }
+    if (suite == "fastpaths") {
+        return runFastPathSuite(args);
+    }
+    if (suite == "bands") {
+        return runBandsSuite(args);
+    }
+    if (suite == "dynamics") {
+        return runDynamicsSuite(args);
+    }
+    if (suite == "stereo") {
+        return runStereoSuite(args);
+    }
+    if (suite == "presets") {
+        return runPresetSuite(args);
+    }
+    if (suite == "instances") {
+        return runInstancesSuite(args);
+    }
+    if (suite == "automation") {
+        return runAutomationSuite(args);
+    }
+    if (suite == "cascade") {
+        return runCascadeSuite(args);
+    }
+    if (suite == "verify") {
+        return runVerifySuite(args);
+    }
+
+    return runGridSuite(args);
+}
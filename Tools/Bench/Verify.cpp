@@ -0,0 +1,556 @@
+/*
+  ==============================================================================
+
+    Verify.cpp
+
+  ==============================================================================
+*/
+
+#include "Verify.h"
+#include "PluginProcessor.h"
+
+struct VerifyOptions {
+    bool quick {false};
+    juce::File goldenDirectory;
+    bool updateGolden {false};
+    double magnitudeToleranceDB {0.1};
+    double magnitudeFloorDB {-40.0};
+    double goldenTolerance {1.0e-5};
+    double engineTolerance {SimpleEQAudioProcessor::defaultEngineTolerance};
+    double stabilitySeconds {5.0};
+    double stallFactor {3.0};
+};
+
+static double getDoubleOption(const juce::ArgumentList& args, const juce::String& option, double defaultValue) {
+    return args.containsOption(option) ? args.getValueForOption(option).getDoubleValue() : defaultValue;
+}
+
+static VerifyOptions getVerifyOptions(const juce::ArgumentList& args) {
+    VerifyOptions options;
+    options.quick = args.containsOption("--quick");
+    options.updateGolden = args.containsOption("--update-golden");
+    options.magnitudeToleranceDB = getDoubleOption(args, "--magnitude-tolerance", options.magnitudeToleranceDB);
+    options.magnitudeFloorDB = getDoubleOption(args, "--magnitude-floor", options.magnitudeFloorDB);
+    options.goldenTolerance = getDoubleOption(args, "--golden-tolerance", options.goldenTolerance);
+    options.engineTolerance = getDoubleOption(args, "--engine-tolerance", options.engineTolerance);
+    options.stabilitySeconds = getDoubleOption(args, "--stability-seconds", options.quick ? 1.0 : options.stabilitySeconds);
+    options.stallFactor = getDoubleOption(args, "--stall-factor", options.stallFactor);
+
+    if (args.containsOption("--golden")) {
+        options.goldenDirectory = juce::File::getCurrentWorkingDirectory().getChildFile(args.getValueForOption("--golden"));
+    }
+
+    return options;
+}
+
+//Cases run, cases failed and the worst value seen for one kind of check
+struct CheckTally {
+    const char* name;
+    const char* unit;
+    int numCases {0}, numFailed {0};
+    double worst {0.0};
+
+    void add(const juce::String& caseName, double value, bool passed) {
+        ++numCases;
+        worst = juce::jmax(worst, value);
+
+        if (! passed) {
+            ++numFailed;
+            std::printf("FAIL %-10s %-40s %12.4g %s\n", name, caseName.toRawUTF8(), value, unit);
+        }
+    }
+};
+
+//Settings on the parameters' own steps, so the coefficient cache designs exactly what the analytic response assumes
+struct SettingsPreset {
+    const char* name;
+    float lcFreq, hcFreq, peakFreq, peakGainDB, peakQ;
+};
+
+static const SettingsPreset settingsPresets[] {
+    { "default", 120.0f, 20000.0f,  300.0f,   0.0f,  1.0f },
+    { "boost",    80.0f, 12000.0f, 1000.0f,  12.0f,  1.0f },
+    { "cut",     200.0f,  8000.0f, 3000.0f, -12.0f,  2.0f },
+    { "narrow",   50.0f, 16000.0f,  700.0f,  18.0f, 24.0f },
+    { "wide",     20.0f, 20000.0f, 5000.0f,  -6.0f,  0.1f }
+};
+
+//bypassMask bit 0 low cut, bit 1 peak, bit 2 high cut
+static ChainSettings makeSettings(const SettingsPreset& preset, int slope, int bypassMask, double sampleRate) {
+    ChainSettings settings;
+    settings.lcFreq = preset.lcFreq;
+    settings.hcFreq = (float) juce::jmin((double) preset.hcFreq, std::floor(sampleRate * 0.45));
+    settings.peakFreq = preset.peakFreq;
+    settings.peakDB_gain = preset.peakGainDB;
+    settings.peakQ = preset.peakQ;
+    settings.lcSlope = static_cast<Slope>(slope);
+    settings.hcSlope = static_cast<Slope>(slope);
+    settings.lcBypassed = (bypassMask & 1) != 0;
+    settings.pdBypassed = (bypassMask & 2) != 0;
+    settings.hcBypassed = (bypassMask & 4) != 0;
+    return settings;
+}
+
+static void setParameter(SimpleEQAudioProcessor& processor, const juce::String& parameterID, float value) {
+    auto* param = processor.apvts.getParameter(parameterID);
+    jassert(param != nullptr);
+    param->setValueNotifyingHost(param->convertTo0to1(value));
+}
+
+static void applyChainSettings(SimpleEQAudioProcessor& processor, const ChainSettings& settings) {
+    setParameter(processor, "LC_freq", settings.lcFreq);
+    setParameter(processor, "HC_freq", settings.hcFreq);
+    setParameter(processor, "PD_freq", settings.peakFreq);
+    setParameter(processor, "PD_gain", settings.peakDB_gain);
+    setParameter(processor, "PD_q", settings.peakQ);
+    setParameter(processor, "LC_slope8", (float) settings.lcSlope);
+    setParameter(processor, "HC_slope8", (float) settings.hcSlope);
+    setParameter(processor, "LC_bp", settings.lcBypassed ? 1.0f : 0.0f);
+    setParameter(processor, "PD_bp", settings.pdBypassed ? 1.0f : 0.0f);
+    setParameter(processor, "HC_bp", settings.hcBypassed ? 1.0f : 0.0f);
+}
+
+using Engine = SimpleEQAudioProcessor::ProcessingEngine;
+
+static std::unique_ptr<SimpleEQAudioProcessor> makeProcessor(const ChainSettings& settings, double sampleRate, int blockSize, Engine engine,
+                                                             bool doublePrecision = false) {
+    auto processor = std::make_unique<SimpleEQAudioProcessor>();
+    processor->setProcessingEngine(engine);
+    processor->setProcessingPrecision(doublePrecision ? juce::AudioProcessor::doublePrecision : juce::AudioProcessor::singlePrecision);
+    processor->setPlayConfigDetails(2, 2, sampleRate, blockSize);
+    applyChainSettings(*processor, settings);
+    processor->prepareToPlay(sampleRate, blockSize);
+    return processor;
+}
+
+//In place, blockSize samples at a time the way a host calls it
+template <typename SampleType>
+static void render(SimpleEQAudioProcessor& processor, juce::AudioBuffer<SampleType>& buffer, int blockSize) {
+    juce::MidiBuffer midi;
+
+    for (int start = 0; start < buffer.getNumSamples(); start += blockSize) {
+        auto numSamples = juce::jmin(blockSize, buffer.getNumSamples() - start);
+        juce::AudioBuffer<SampleType> block(buffer.getArrayOfWritePointers(), buffer.getNumChannels(), start, numSamples);
+        processor.processBlock(block, midi);
+    }
+}
+
+//The same, appending the time each block took in ns per sample to blockTimes
+template <typename SampleType>
+static void render(SimpleEQAudioProcessor& processor, juce::AudioBuffer<SampleType>& buffer, int blockSize, std::vector<double>& blockTimes) {
+    juce::MidiBuffer midi;
+
+    for (int start = 0; start < buffer.getNumSamples(); start += blockSize) {
+        auto numSamples = juce::jmin(blockSize, buffer.getNumSamples() - start);
+        juce::AudioBuffer<SampleType> block(buffer.getArrayOfWritePointers(), buffer.getNumChannels(), start, numSamples);
+
+        auto startTicks = juce::Time::getHighResolutionTicks();
+        processor.processBlock(block, midi);
+        auto ticks = juce::Time::getHighResolutionTicks() - startTicks;
+
+        blockTimes.push_back(juce::Time::highResolutionTicksToSeconds(ticks) * 1.0e9 / numSamples);
+    }
+}
+
+//The value fraction of the way up the sorted values, 0 when there are none
+static double getPercentile(std::vector<double> values, double fraction) {
+    if (values.empty()) {
+        return 0.0;
+    }
+
+    auto nth = values.begin() + (std::ptrdiff_t) ((double) (values.size() - 1) * fraction);
+    std::nth_element(values.begin(), nth, values.end());
+    return *nth;
+}
+
+enum class Signal {
+    impulse,
+    sweep,
+    noise
+};
+
+//Stereo, the same impulse or sweep on both channels and independent noise
+static juce::AudioBuffer<float> makeSignal(Signal signal, double sampleRate, int numSamples) {
+    juce::AudioBuffer<float> buffer(2, numSamples);
+    buffer.clear();
+
+    switch (signal) {
+        case Signal::impulse:
+            buffer.setSample(0, 0, 1.0f);
+            buffer.setSample(1, 0, 1.0f);
+            break;
+
+        case Signal::sweep: {
+            //Exponential, 20 Hz up to 20 kHz or 0.45 fs
+            auto f1 = 20.0;
+            auto f2 = juce::jmin(20000.0, sampleRate * 0.45);
+            auto duration = numSamples / sampleRate;
+            auto rate = std::log(f2 / f1);
+
+            for (int n = 0; n < numSamples; ++n) {
+                auto t = n / sampleRate;
+                auto phase = juce::MathConstants<double>::twoPi * f1 * duration / rate * (std::exp(t / duration * rate) - 1.0);
+                buffer.setSample(0, n, (float) (0.5 * std::sin(phase)));
+                buffer.setSample(1, n, (float) (0.5 * std::sin(phase)));
+            }
+            break;
+        }
+
+        case Signal::noise: {
+            juce::Random random(0x5eed);
+            for (int ch = 0; ch < 2; ++ch) {
+                for (int n = 0; n < numSamples; ++n) {
+                    buffer.setSample(ch, n, random.nextFloat() - 0.5f);
+                }
+            }
+            break;
+        }
+    }
+
+    return buffer;
+}
+
+static float maxDifference(const juce::AudioBuffer<float>& a, const juce::AudioBuffer<float>& b) {
+    if (a.getNumChannels() != b.getNumChannels() || a.getNumSamples() != b.getNumSamples()) {
+        return std::numeric_limits<float>::infinity();
+    }
+
+    float difference = 0.0f;
+    for (int ch = 0; ch < a.getNumChannels(); ++ch) {
+        for (int n = 0; n < a.getNumSamples(); ++n) {
+            difference = juce::jmax(difference, std::abs(a.getSample(ch, n) - b.getSample(ch, n)));
+        }
+    }
+    return difference;
+}
+
+//Largest deviation in dB of the rendered impulse response from the analytic one, over the bins between 20 Hz and
+//20 kHz (or 0.45 fs) where the analytic response is above floorDB
+static double measureMagnitudeError(const juce::AudioBuffer<float>& impulseResponse, const ChainCoefficients& chainCoefficients,
+                                    double sampleRate, double floorDB) {
+    auto length = impulseResponse.getNumSamples();
+    jassert(juce::isPowerOfTwo(length));
+
+    juce::dsp::FFT fft(juce::roundToInt(std::log2((double) length)));
+    std::vector<float> spectrum((size_t) length * 2, 0.0f);
+    std::copy(impulseResponse.getReadPointer(0), impulseResponse.getReadPointer(0) + length, spectrum.begin());
+    fft.performFrequencyOnlyForwardTransform(spectrum.data());
+
+    auto firstBin = (size_t) std::ceil(20.0 * length / sampleRate);
+    auto lastBin = (size_t) std::floor(juce::jmin(20000.0, sampleRate * 0.45) * length / sampleRate);
+    auto numBins = lastBin + 1 - firstBin;
+
+    std::vector<double> phi(numBins), magnitudeSquared(numBins, 1.0);
+    for (size_t i = 0; i < numBins; ++i) {
+        auto s = std::sin(juce::MathConstants<double>::pi * (double) (firstBin + i) / (double) length);
+        phi[i] = s * s;
+    }
+
+    accumulateChainMagnitudeSquared(chainCoefficients, phi.data(), magnitudeSquared.data(), numBins);
+
+    double worst = 0.0;
+    for (size_t i = 0; i < numBins; ++i) {
+        auto analyticDB = 10.0 * std::log10(juce::jmax(magnitudeSquared[i], 1.0e-30));
+        if (analyticDB < floorDB) {
+            continue;
+        }
+
+        auto measuredDB = 20.0 * std::log10(juce::jmax((double) spectrum[firstBin + i], 1.0e-15));
+        worst = juce::jmax(worst, std::abs(measuredDB - analyticDB));
+    }
+
+    return worst;
+}
+
+//Impulse against the analytic response, and the vectorised engine against the scalar reference on noise
+static void verifyMagnitudeAndEngines(const VerifyOptions& options, CheckTally& magnitude, CheckTally& engines) {
+    std::vector<double> sampleRates { 44100.0, 48000.0, 96000.0, 192000.0 };
+    std::vector<int> slopes { Slope_12, Slope_24, Slope_48, Slope_96 };
+    std::vector<int> bypassMasks { 0, 1, 2, 4, 7 };
+
+    if (options.quick) {
+        sampleRates = { 48000.0 };
+        slopes = { Slope_12, Slope_96 };
+        bypassMasks = { 0, 7 };
+    }
+
+    constexpr int blockSize = 512;
+
+    for (auto sampleRate : sampleRates) {
+        for (auto& preset : settingsPresets) {
+            for (auto slope : slopes) {
+                for (auto bypassMask : bypassMasks) {
+                    auto settings = makeSettings(preset, slope, bypassMask, sampleRate);
+                    auto caseName = juce::String(preset.name) + " " + juce::String((int) sampleRate) + " Hz " + juce::String(12 * (slope + 1))
+                                  + " dB/oct bypass " + juce::String(bypassMask);
+
+                    auto reference = makeProcessor(settings, sampleRate, blockSize, Engine::scalar);
+
+                    //Twice the 60 dB tail takes the response down to 120 dB, far below the floor
+                    auto tailSamples = reference->getTailLengthSeconds() * 2.0 * sampleRate;
+                    auto length = juce::jlimit(4096, 1 << 20, juce::nextPowerOfTwo((int) tailSamples + blockSize));
+
+                    auto impulseResponse = makeSignal(Signal::impulse, sampleRate, length);
+                    render(*reference, impulseResponse, blockSize);
+
+                    auto error = measureMagnitudeError(impulseResponse, makeChainCoefficients(settings, sampleRate), sampleRate, options.magnitudeFloorDB);
+                    magnitude.add(caseName, error, error <= options.magnitudeToleranceDB);
+
+                    auto noiseLength = (int) (sampleRate / 4);
+                    auto scalarOutput = makeSignal(Signal::noise, sampleRate, noiseLength);
+                    auto vectorisedOutput = scalarOutput;
+
+                    render(*makeProcessor(settings, sampleRate, blockSize, Engine::scalar), scalarOutput, blockSize);
+                    render(*makeProcessor(settings, sampleRate, blockSize, Engine::vectorised), vectorisedOutput, blockSize);
+
+                    auto difference = (double) maxDifference(scalarOutput, vectorisedOutput);
+                    engines.add(caseName, difference, difference <= options.engineTolerance);
+                }
+            }
+        }
+    }
+}
+
+//Raw float32 after a channel count and a sample count, channel by channel
+static bool writeGolden(const juce::File& file, const juce::AudioBuffer<float>& buffer) {
+    file.deleteFile();
+    juce::FileOutputStream stream(file);
+
+    if (! stream.openedOk()) {
+        return false;
+    }
+
+    stream.writeInt(buffer.getNumChannels());
+    stream.writeInt(buffer.getNumSamples());
+
+    for (int ch = 0; ch < buffer.getNumChannels(); ++ch) {
+        for (int n = 0; n < buffer.getNumSamples(); ++n) {
+            stream.writeFloat(buffer.getSample(ch, n));
+        }
+    }
+
+    return stream.getStatus().wasOk();
+}
+
+static bool readGolden(const juce::File& file, juce::AudioBuffer<float>& buffer) {
+    juce::FileInputStream stream(file);
+
+    if (! stream.openedOk()) {
+        return false;
+    }
+
+    auto numChannels = stream.readInt();
+    auto numSamples = stream.readInt();
+
+    if (numChannels <= 0 || numSamples <= 0 || stream.getNumBytesRemaining() < (juce::int64) numChannels * numSamples * (juce::int64) sizeof(float)) {
+        return false;
+    }
+
+    buffer.setSize(numChannels, numSamples);
+
+    for (int ch = 0; ch < numChannels; ++ch) {
+        for (int n = 0; n < numSamples; ++n) {
+            buffer.setSample(ch, n, stream.readFloat());
+        }
+    }
+
+    return true;
+}
+
+//Sweeps and noise at 48 kHz through the scalar reference, against (or into) the renders in the golden directory
+static bool verifyGolden(const VerifyOptions& options, CheckTally& golden) {
+    if (options.goldenDirectory == juce::File()) {
+        return true;
+    }
+
+    if (options.updateGolden && ! options.goldenDirectory.createDirectory().wasOk()) {
+        std::fprintf(stderr, "Can't create %s\n", options.goldenDirectory.getFullPathName().toRawUTF8());
+        return false;
+    }
+
+    constexpr double sampleRate = 48000.0;
+    constexpr int blockSize = 512;
+    bool allWritten = true;
+
+    for (auto& preset : settingsPresets) {
+        for (auto slope : { Slope_12, Slope_48, Slope_96 }) {
+            for (auto signal : { Signal::sweep, Signal::noise }) {
+                auto signalName = signal == Signal::sweep ? "sweep" : "noise";
+                auto caseName = juce::String(preset.name) + "_" + juce::String(12 * (slope + 1)) + "dB_" + signalName;
+
+                auto settings = makeSettings(preset, slope, 0, sampleRate);
+                auto output = makeSignal(signal, sampleRate, (int) sampleRate);
+                render(*makeProcessor(settings, sampleRate, blockSize, Engine::scalar), output, blockSize);
+
+                auto file = options.goldenDirectory.getChildFile(caseName + ".f32");
+
+                if (options.updateGolden) {
+                    allWritten = writeGolden(file, output) && allWritten;
+                    continue;
+                }
+
+                juce::AudioBuffer<float> expected;
+                if (! readGolden(file, expected)) {
+                    std::printf("     %-10s no render at %s, write it with --update-golden\n", golden.name, file.getFullPathName().toRawUTF8());
+                    golden.add(caseName, std::numeric_limits<double>::infinity(), false);
+                    continue;
+                }
+
+                auto difference = (double) maxDifference(output, expected);
+                golden.add(caseName, difference, difference <= options.goldenTolerance);
+            }
+        }
+    }
+
+    if (options.updateGolden) {
+        std::printf("Wrote golden renders to %s\n", options.goldenDirectory.getFullPathName().toRawUTF8());
+    }
+
+    return allWritten;
+}
+
+struct StabilityResult {
+    bool finite {true};
+    double peak {0.0};
+    juce::int64 denormals {0};
+    double loudNsPerSample {0.0};   //The loud phase's median block
+    double quietNsPerSample {0.0};  //95th percentile of the quiet phases' blocks, where the tail decays
+};
+
+//Loud noise, noise just above the denormal range, then digital silence. Every phase renders numSamples, the filter
+//state carries over from one phase into the next. ScopedNoDenormals keeps denormals out of the output, so a stall
+//in the state only shows up in how long the decaying blocks take. Percentiles rather than the slowest block keep
+//the odd preempted block on a loaded machine from failing the check.
+template <typename SampleType>
+static StabilityResult runStability(const ChainSettings& settings, double sampleRate, Engine engine, int numSamples) {
+    constexpr int blockSize = 512;
+    constexpr std::array<double, 3> phaseLevels { 0.25, 1.0e-30, 0.0 };
+
+    auto processor = makeProcessor(settings, sampleRate, blockSize, engine, std::is_same<SampleType, double>::value);
+    juce::AudioBuffer<SampleType> buffer(2, numSamples);
+    juce::Random random(0x5eed);
+    StabilityResult result;
+
+    auto numBlocks = (size_t) ((numSamples + blockSize - 1) / blockSize);
+    std::vector<double> loudBlockTimes, quietBlockTimes;
+    loudBlockTimes.reserve(numBlocks);
+    quietBlockTimes.reserve(numBlocks * (phaseLevels.size() - 1));
+
+    for (size_t phase = 0; phase < phaseLevels.size(); ++phase) {
+        for (int ch = 0; ch < 2; ++ch) {
+            for (int n = 0; n < numSamples; ++n) {
+                buffer.setSample(ch, n, (SampleType) (phaseLevels[phase] * (random.nextDouble() * 2.0 - 1.0)));
+            }
+        }
+
+        render(*processor, buffer, blockSize, phase == 0 ? loudBlockTimes : quietBlockTimes);
+
+        for (int ch = 0; ch < 2; ++ch) {
+            for (int n = 0; n < numSamples; ++n) {
+                auto sample = buffer.getSample(ch, n);
+
+                if (! std::isfinite(sample)) {
+                    result.finite = false;
+                    continue;
+                }
+
+                result.peak = juce::jmax(result.peak, (double) std::abs(sample));
+                if (sample != (SampleType) 0 && std::abs(sample) < std::numeric_limits<SampleType>::min()) {
+                    ++result.denormals;
+                }
+            }
+        }
+    }
+
+    result.loudNsPerSample = getPercentile(loudBlockTimes, 0.5);
+    result.quietNsPerSample = getPercentile(quietBlockTimes, 0.95);
+    return result;
+}
+
+//Q 24 peaks and cuts at the ends of their ranges, run long enough to settle and then decay through the denormal range
+static void verifyStability(const VerifyOptions& options, CheckTally& stability) {
+    struct ExtremeCase {
+        const char* name;
+        float lcFreq, hcFreq, peakFreq, peakGainDB;
+    };
+
+    const ExtremeCase extremes[] {
+        { "peak 20 Hz +24",    20.0f, 20000.0f,    20.0f,  24.0f },
+        { "peak 20 Hz -24",    20.0f, 20000.0f,    20.0f, -24.0f },
+        { "peak 20 kHz +24",   20.0f, 20000.0f, 20000.0f,  24.0f },
+        { "peak 20 kHz -24",   20.0f, 20000.0f, 20000.0f, -24.0f },
+        { "cuts crossed",   20000.0f,    20.0f,  1000.0f,  24.0f }
+    };
+
+    std::vector<double> sampleRates { 44100.0, 48000.0, 96000.0, 192000.0 };
+    if (options.quick) {
+        sampleRates = { 48000.0 };
+    }
+
+    for (auto sampleRate : sampleRates) {
+        for (auto& extreme : extremes) {
+            ChainSettings settings;
+            settings.lcFreq = extreme.lcFreq;
+            settings.hcFreq = (float) juce::jmin((double) extreme.hcFreq, std::floor(sampleRate * 0.45));
+            settings.peakFreq = (float) juce::jmin((double) extreme.peakFreq, std::floor(sampleRate * 0.45));
+            settings.peakDB_gain = extreme.peakGainDB;
+            settings.peakQ = 24.0f;
+            settings.lcSlope = Slope_96;
+            settings.hcSlope = Slope_96;
+
+            auto numSamples = (int) (options.stabilitySeconds * sampleRate);
+
+            for (auto engine : { Engine::scalar, Engine::vectorised }) {
+                for (auto doublePrecision : { false, true }) {
+                    auto result = doublePrecision ? runStability<double>(settings, sampleRate, engine, numSamples)
+                                                  : runStability<float>(settings, sampleRate, engine, numSamples);
+
+                    auto caseName = juce::String(extreme.name) + " " + juce::String((int) sampleRate) + " Hz "
+                                  + (engine == Engine::scalar ? "scalar" : "vectorised") + (doublePrecision ? " double" : " float");
+
+                    auto slowdown = result.quietNsPerSample / juce::jmax(result.loudNsPerSample, 1.0e-3);
+                    auto passed = result.finite && result.peak < 1.0e3 && result.denormals == 0 && slowdown <= options.stallFactor;
+
+                    if (! passed) {
+                        std::printf("     %-10s %-40s finite %d, peak %.3g, denormals %lld, quiet/loud block time %.2f\n", stability.name,
+                                    caseName.toRawUTF8(), result.finite ? 1 : 0, result.peak, (long long) result.denormals, slowdown);
+                    }
+
+                    stability.add(caseName, slowdown, passed);
+                }
+            }
+        }
+    }
+}
+
+int runVerifySuite(const juce::ArgumentList& args) {
+    auto options = getVerifyOptions(args);
+
+    CheckTally magnitude { "magnitude", "dB" };
+    CheckTally engines { "engines", "abs" };
+    CheckTally golden { "golden", "abs" };
+    CheckTally stability { "stability", "x slower" };
+
+    auto goldenWritten = verifyGolden(options, golden);
+
+    if (options.updateGolden) {
+        return goldenWritten ? 0 : 1;
+    }
+
+    verifyMagnitudeAndEngines(options, magnitude, engines);
+    verifyStability(options, stability);
+
+    std::printf("\n%-10s %8s %8s %14s\n", "check", "cases", "failed", "worst");
+
+    bool anyFailed = false;
+    for (auto* tally : { &magnitude, &engines, &golden, &stability }) {
+        std::printf("%-10s %8d %8d %14.4g %s\n", tally->name, tally->numCases, tally->numFailed, tally->worst, tally->unit);
+        anyFailed = anyFailed || tally->numFailed > 0;
+    }
+
+    if (golden.numCases == 0) {
+        std::printf("\nNo --golden directory given, golden renders were not compared\n");
+    }
+
+    return anyFailed ? 1 : 0;
+}
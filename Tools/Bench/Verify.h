@@ -0,0 +1,37 @@
+/*
+  ==============================================================================
+
+    Verify.h
+
+    SimpleEQ_bench --suite=verify: renders impulses, sweeps and noise
+    through SimpleEQAudioProcessor across a grid of settings, slopes, bypass
+    states and sample rates, and checks them against the analytic magnitude
+    response, stored golden renders, the scalar reference engine and a set
+    of long-run stability limits: finite, bounded output free of denormals,
+    and decaying-tail blocks that take no longer than --stall-factor times
+    the loud ones.
+
+    Golden renders are written to and read from Tools/Bench/Golden. The
+    CTest run compares them once that directory holds them.
+
+    Options   --golden=<dir>            compare sweeps and noise with the renders in dir
+              --update-golden           write the renders into --golden instead
+              --magnitude-tolerance=<dB>    default 0.1
+              --magnitude-floor=<dB>        bins below this are skipped, default -40
+              --golden-tolerance=<abs>      default 1e-5
+              --engine-tolerance=<abs>      default SimpleEQAudioProcessor::defaultEngineTolerance
+              --stability-seconds=<s>       per phase, default 5
+              --stall-factor=<x>            95th percentile quiet block against the median loud one, default 3
+              --quick                       48 kHz and the outer slopes and bypass states only
+
+    Prints every failing case and a summary per check, exits non-zero if
+    anything failed.
+
+  ==============================================================================
+*/
+
+#pragma once
+
+#include <JuceHeader.h>
+
+int runVerifySuite(const juce::ArgumentList& args);
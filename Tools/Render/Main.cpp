@@ -0,0 +1,269 @@
+/*
+  ==============================================================================
+
+    Main.cpp
+
+    SimpleEQ_render: applies a SimpleEQ preset to a batch of audio files
+    offline, one SimpleEQAudioProcessor per worker thread.
+
+    Each output keeps its input's path below the directory it was found in,
+    as a .wav. The reported latency is trimmed from the start and the tail
+    rendered after the end. Existing files are never overwritten.
+
+    Usage: SimpleEQ_render --preset=<state blob or xml> --output=<dir>
+                           [--threads=<n>] [--chunk=<samples>] [--recursive]
+                           <files or directories>...
+
+  ==============================================================================
+*/
+
+#include <JuceHeader.h>
+#include "PluginProcessor.h"
+
+//Accepts either the raw getStateInformation() blob or the same state as XML
+static bool loadPreset(const juce::File& presetFile, juce::MemoryBlock& state) {
+    if (! presetFile.loadFileAsData(state)) {
+        return false;
+    }
+
+    if (state.getSize() > 0 && static_cast<const char*>(state.getData())[0] == '<') {
+        auto xml = juce::parseXML(presetFile);
+        if (xml == nullptr) {
+            return false;
+        }
+
+        auto tree = juce::ValueTree::fromXml(*xml);
+        if (! tree.isValid()) {
+            return false;
+        }
+
+        state.reset();
+        juce::MemoryOutputStream mos(state, false);
+        tree.writeToStream(mos);
+    }
+
+    return true;
+}
+
+struct RenderJob {
+    juce::File input, output;
+};
+
+struct RenderTotals {
+    std::atomic<int> filesDone {0}, filesFailed {0};
+    std::atomic<juce::int64> samplesRendered {0};
+    std::atomic<juce::int64> microsecondsOfAudio {0};
+};
+
+class RenderWorker : public juce::Thread {
+public:
+    RenderWorker(const juce::Array<RenderJob>& jobsToRender, std::atomic<int>& nextJobIndex, const juce::MemoryBlock& presetState,
+                 int chunkSize, RenderTotals& renderTotals)
+        : juce::Thread("SimpleEQ render worker"), jobs(jobsToRender), nextJob(nextJobIndex), preset(presetState),
+          chunk(chunkSize), totals(renderTotals) {
+        formatManager.registerBasicFormats();
+    }
+
+    ~RenderWorker() override {
+        stopThread(10000);
+    }
+
+    void run() override {
+        SimpleEQAudioProcessor processor;
+        processor.setStateInformation(preset.getData(), (int) preset.getSize());
+
+        while (! threadShouldExit()) {
+            auto index = nextJob.fetch_add(1);
+            if (index >= jobs.size()) {
+                break;
+            }
+
+            if (renderFile(processor, jobs.getReference(index))) {
+                ++totals.filesDone;
+            } else {
+                ++totals.filesFailed;
+            }
+        }
+    }
+
+private:
+    const juce::Array<RenderJob>& jobs;
+    std::atomic<int>& nextJob;
+    const juce::MemoryBlock& preset;
+    int chunk;
+    RenderTotals& totals;
+
+    juce::AudioFormatManager formatManager;
+    juce::WavAudioFormat wavFormat;
+
+    bool renderFile(SimpleEQAudioProcessor& processor, const RenderJob& job) {
+        auto& input = job.input;
+        auto& output = job.output;
+
+        std::unique_ptr<juce::AudioFormatReader> reader(formatManager.createReaderFor(input));
+        if (reader == nullptr) {
+            std::fprintf(stderr, "Can't read %s\n", input.getFullPathName().toRawUTF8());
+            return false;
+        }
+
+        auto numChannels = (int) reader->numChannels;
+        auto sampleRate = reader->sampleRate;
+
+        juce::AudioProcessor::BusesLayout layout;
+        layout.inputBuses.add(juce::AudioChannelSet::canonicalChannelSet(numChannels));
+        layout.outputBuses.add(juce::AudioChannelSet::canonicalChannelSet(numChannels));
+
+        if (! processor.setBusesLayout(layout)) {
+            std::fprintf(stderr, "Unsupported channel count %d in %s\n", numChannels, input.getFullPathName().toRawUTF8());
+            return false;
+        }
+
+        if (output.exists()) {
+            std::fprintf(stderr, "Not overwriting %s\n", output.getFullPathName().toRawUTF8());
+            return false;
+        }
+        if (! output.getParentDirectory().createDirectory()) {
+            std::fprintf(stderr, "Can't create %s\n", output.getParentDirectory().getFullPathName().toRawUTF8());
+            return false;
+        }
+
+        std::unique_ptr<juce::OutputStream> stream(new juce::FileOutputStream(output, 1 << 20));
+        auto bitsPerSample = juce::jlimit(16, 32, (int) reader->bitsPerSample);
+        std::unique_ptr<juce::AudioFormatWriter> writer(wavFormat.createWriterFor(stream.get(), sampleRate, (unsigned int) numChannels,
+                                                                                   bitsPerSample, {}, 0));
+        if (writer == nullptr) {
+            std::fprintf(stderr, "Can't write %s\n", output.getFullPathName().toRawUTF8());
+            return false;
+        }
+        stream.release(); //Now owned by the writer
+
+        processor.setRateAndBufferSizeDetails(sampleRate, chunk);
+        processor.prepareToPlay(sampleRate, chunk);
+
+        //The output lines up with the input and runs on for the tail. Reads past the end of the file come back silent.
+        auto latency = (juce::int64) processor.getLatencySamples();
+        auto tail = (juce::int64) std::ceil(processor.getTailLengthSeconds() * sampleRate);
+        auto outputLength = reader->lengthInSamples + tail;
+
+        juce::AudioBuffer<float> buffer(numChannels, chunk);
+        juce::MidiBuffer midi;
+
+        for (juce::int64 position = 0; position < outputLength + latency && ! threadShouldExit(); position += chunk) {
+            auto numSamples = (int) juce::jmin((juce::int64) chunk, outputLength + latency - position);
+
+            reader->read(&buffer, 0, numSamples, position, true, true);
+
+            //processBlock sees the whole allocated buffer, so only hand it the samples that were read
+            juce::AudioBuffer<float> block(buffer.getArrayOfWritePointers(), numChannels, numSamples);
+            processor.processBlock(block, midi);
+
+            auto firstOutput = (int) juce::jlimit((juce::int64) 0, (juce::int64) numSamples, latency - position);
+            writer->writeFromAudioSampleBuffer(block, firstOutput, numSamples - firstOutput);
+        }
+
+        processor.releaseResources();
+
+        totals.samplesRendered += outputLength;
+        totals.microsecondsOfAudio += (juce::int64) (1.0e6 * (double) reader->lengthInSamples / sampleRate);
+        return true;
+    }
+};
+
+//Outputs keep the input's path below the directory argument it came from. Inputs that still land on the same name,
+//from two arguments or as a.flac and a.wav, get " (2)", " (3)" and so on.
+static void addJob(const juce::File& input, const juce::String& relativePath, const juce::File& outputDir, juce::Array<RenderJob>& jobs) {
+    auto stem = outputDir.getChildFile(relativePath).withFileExtension("wav");
+    auto output = stem;
+
+    for (int suffix = 2; std::any_of(jobs.begin(), jobs.end(), [&output](const RenderJob& job) { return job.output == output; }); ++suffix) {
+        output = stem.getSiblingFile(stem.getFileNameWithoutExtension() + " (" + juce::String(suffix) + ").wav");
+    }
+
+    jobs.add({ input, output });
+}
+
+static void collectFiles(const juce::File& file, const juce::String& wildcard, bool recursive, const juce::File& outputDir,
+                         juce::Array<RenderJob>& jobs) {
+    if (file.isDirectory()) {
+        for (const auto& entry : juce::RangedDirectoryIterator(file, recursive, wildcard, juce::File::findFiles)) {
+            addJob(entry.getFile(), entry.getFile().getRelativePathFrom(file), outputDir, jobs);
+        }
+    } else if (file.existsAsFile()) {
+        addJob(file, file.getFileName(), outputDir, jobs);
+    } else {
+        std::fprintf(stderr, "Skipping %s, not found\n", file.getFullPathName().toRawUTF8());
+    }
+}
+
+int main(int argc, char* argv[]) {
+    juce::ScopedJuceInitialiser_GUI juceInitialiser;
+    juce::ArgumentList args(argc, argv);
+
+    if (! args.containsOption("--preset") || ! args.containsOption("--output")) {
+        std::fprintf(stderr, "Usage: SimpleEQ_render --preset=<file> --output=<dir> [--threads=<n>] [--chunk=<samples>] [--recursive] <files or directories>...\n");
+        return 1;
+    }
+
+    auto cwd = juce::File::getCurrentWorkingDirectory();
+
+    juce::MemoryBlock preset;
+    if (! loadPreset(cwd.getChildFile(args.getValueForOption("--preset")), preset)) {
+        std::fprintf(stderr, "Can't load preset\n");
+        return 1;
+    }
+
+    auto outputDir = cwd.getChildFile(args.getValueForOption("--output"));
+    if (! outputDir.createDirectory()) {
+        std::fprintf(stderr, "Can't create %s\n", outputDir.getFullPathName().toRawUTF8());
+        return 1;
+    }
+
+    auto numThreads = args.containsOption("--threads") ? args.getValueForOption("--threads").getIntValue()
+                                                       : juce::SystemStats::getNumCpus();
+    numThreads = juce::jmax(1, numThreads);
+
+    //Large chunks keep the reads and writes streaming rather than seeking
+    auto chunk = args.containsOption("--chunk") ? args.getValueForOption("--chunk").getIntValue() : 65536;
+    chunk = juce::jlimit(256, 1 << 20, chunk);
+
+    juce::AudioFormatManager formatManager;
+    formatManager.registerBasicFormats();
+
+    juce::Array<RenderJob> jobs;
+    for (auto& arg : args.arguments) {
+        if (! arg.isOption()) {
+            collectFiles(arg.resolveAsFile(), formatManager.getWildcardForAllFormats(), args.containsOption("--recursive"), outputDir, jobs);
+        }
+    }
+
+    if (jobs.isEmpty()) {
+        std::fprintf(stderr, "No input files\n");
+        return 1;
+    }
+
+    std::atomic<int> nextJob {0};
+    RenderTotals totals;
+
+    auto startTicks = juce::Time::getHighResolutionTicks();
+
+    {
+        juce::OwnedArray<RenderWorker> workers;
+        for (int i = 0; i < juce::jmin(numThreads, jobs.size()); ++i) {
+            workers.add(new RenderWorker(jobs, nextJob, preset, chunk, totals))->startThread();
+        }
+
+        for (auto* worker : workers) {
+            worker->waitForThreadToExit(-1);
+        }
+    }
+
+    auto seconds = juce::Time::highResolutionTicksToSeconds(juce::Time::getHighResolutionTicks() - startTicks);
+    auto audioSeconds = (double) totals.microsecondsOfAudio.load() * 1.0e-6;
+
+    std::printf("Rendered %d files (%d failed) on %d threads in %.3f s\n", totals.filesDone.load(), totals.filesFailed.load(),
+                juce::jmin(numThreads, jobs.size()), seconds);
+    std::printf("%.2f files/s, %.1fx realtime, %.0f samples/s\n", totals.filesDone.load() / seconds, audioSeconds / seconds,
+                (double) totals.samplesRendered.load() / seconds);
+
+    return totals.filesFailed.load() > 0 ? 1 : 0;
+}